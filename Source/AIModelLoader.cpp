@@ -1,10 +1,13 @@
 #include "AIModelLoader.h"
+#include "ModelRegistry.h"
 #include "Utils.h"
 #include <algorithm>
+#include <array>
 #include <cmath>
-#include <future>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -16,68 +19,231 @@
 // PIMPL implementation with REAL AI model support
 struct AIModelLoader::Impl
 {
-    // Real AI model implementations using ONNX Runtime
-    
-    // Real CREPE model with ONNX backend
-    struct MockCrepeModel
+    // CREPE on ONNX Runtime: 1024-sample frames at 16kHz in, 360 pitch bins of salience out
+    // (20 cents apart from 31.7Hz). The session comes from the ModelRegistry, shared with every
+    // instance on the same model file. Frames and salience live in buffers owned here,
+    // maxBatchSize rows each, with a tensor over the first N rows made at load for every batch
+    // size N; a prediction rebinds the pair for its batch size (when it changed) and makes one
+    // Run() over that memory, allocating nothing here.
+    struct CrepeModel
     {
+        static constexpr int frameSize = 1024;
+        static constexpr int numBins = 360;
+        static constexpr double modelSampleRate = 16000.0;
+        static constexpr float firstBinCents = 1997.3794f;  // Cents above 10Hz
+        static constexpr float centsPerBin = 20.0f;
+        static constexpr int decodeRadius = 4;              // Bins averaged either side of the peak
+        static constexpr int maxBatchSize = 64;
+        static constexpr int timedRuns = 4;
+        
         bool loaded = false;
-        float sampleRate = 44100.0f;
+        int batchCapacity = 1;      // maxBatchSize, or 1 for graphs with a fixed batch of one
+        std::vector<float> frames = std::vector<float>(frameSize, 0.0f);
+        std::vector<float> salience = std::vector<float>(numBins, 0.0f);
         
-        AIModelLoader::PitchPrediction predict(const std::vector<float>& audio)
+#if ONNX_RUNTIME_SESSIONS
+        // Declared in dependency order: the registry outlives the model, the model the
+        // tensors and binding made for it here
+        SharedResourcePointer<ModelRegistry> registry;
+        std::shared_ptr<ModelRegistry::Model> model;
+        Ort::MemoryInfo memoryInfo { nullptr };
+        std::vector<Ort::Value> inputTensors;   // [N - 1] covers the first N rows
+        std::vector<Ort::Value> outputTensors;
+        Ort::IoBinding binding { nullptr };
+        Ort::RunOptions runOptions { nullptr };
+        std::string inputName;
+        std::string outputName;
+        int boundBatchSize = 0;
+        
+        // Into a fresh CrepeModel, which the loader swaps in once this returns. Throws
+        // (Ort::Exception or std::runtime_error) when the model is not a CREPE graph.
+        void load(const File& modelFile)
         {
-            AIModelLoader::PitchPrediction result;
+            // Batches are run on the calling thread; throughput comes from batching frames,
+            // not from splitting one small graph across cores
+            model = registry->acquire(modelFile);
+            auto& session = model->session;
+            
+            if (session.GetInputCount() != 1 || session.GetOutputCount() < 1)
+                throw std::runtime_error("expected one input and at least one output");
             
-            if (!loaded || audio.empty()) return result;
+            bool inputBatches = false;
+            bool outputBatches = false;
+            auto inputShape = getRowShape(session.GetInputTypeInfo(0), frameSize, inputBatches);
+            auto outputShape = getRowShape(session.GetOutputTypeInfo(0), numBins, outputBatches);
             
-            // Mock pitch detection using autocorrelation (simplified)
-            const int minPeriod = static_cast<int>(sampleRate / 800.0f); // ~800Hz max
-            const int maxPeriod = static_cast<int>(sampleRate / 50.0f);   // ~50Hz min
+            batchCapacity = inputBatches && outputBatches ? maxBatchSize : 1;
+            frames.assign(static_cast<size_t>(batchCapacity * frameSize), 0.0f);
+            salience.assign(static_cast<size_t>(batchCapacity * numBins), 0.0f);
             
-            float maxCorrelation = 0.0f;
-            int bestPeriod = 0;
+            memoryInfo = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
             
-            for (int period = minPeriod; period < maxPeriod && period < audio.size() / 2; ++period)
+            for (int batchSize = 1; batchSize <= batchCapacity; ++batchSize)
             {
-                float correlation = 0.0f;
-                int count = 0;
+                if (inputBatches)
+                    inputShape[0] = batchSize;
+                if (outputBatches)
+                    outputShape[0] = batchSize;
                 
-                for (int i = 0; i < static_cast<int>(audio.size()) - period; ++i)
-                {
-                    if (static_cast<size_t>(i + period) < audio.size()) {
-                        correlation += audio[static_cast<size_t>(i)] * audio[static_cast<size_t>(i + period)];
-                    }
-                    count++;
-                }
+                inputTensors.push_back(Ort::Value::CreateTensor<float>(memoryInfo, frames.data(),
+                                                                       static_cast<size_t>(batchSize * frameSize),
+                                                                       inputShape.data(), inputShape.size()));
+                outputTensors.push_back(Ort::Value::CreateTensor<float>(memoryInfo, salience.data(),
+                                                                        static_cast<size_t>(batchSize * numBins),
+                                                                        outputShape.data(), outputShape.size()));
+            }
+            
+            Ort::AllocatorWithDefaultOptions allocator;
+            inputName = session.GetInputNameAllocated(0, allocator).get();
+            outputName = session.GetOutputNameAllocated(0, allocator).get();
+            
+            binding = Ort::IoBinding(session);
+            runOptions = Ort::RunOptions();
+            
+            // The first run at each end of the range sizes the session's internal buffers (later
+            // runs reuse them), then single frames are timed for ModelInfo. Once per session:
+            // instances opening a shared model skip all of it.
+            if (model->frameMilliseconds == 0.0)
+            {
+                std::fill(frames.begin(), frames.end(), 0.0f);
+                run(batchCapacity);
+                run(1);
                 
-                if (count > 0)
-                {
-                    correlation /= count;
-                    if (correlation > maxCorrelation)
-                    {
-                        maxCorrelation = correlation;
-                        bestPeriod = period;
-                    }
-                }
+                const double startTime = Time::getMillisecondCounterHiRes();
+                for (int i = 0; i < timedRuns; ++i)
+                    run(1);
+                
+                model->frameMilliseconds = jmax(1.0e-3, (Time::getMillisecondCounterHiRes() - startTime) / timedRuns);
             }
             
-            if (bestPeriod > 0 && maxCorrelation > 0.3f)
+            loaded = true;
+        }
+        
+        void run(int batchSize)
+        {
+            if (batchSize != boundBatchSize)
             {
-                result.frequency = sampleRate / bestPeriod;
-                result.confidence = std::min<float>(maxCorrelation * 2.0f, 1.0f);
-                result.voicing = result.confidence;
+                binding.BindInput(inputName.c_str(), inputTensors[static_cast<size_t>(batchSize - 1)]);
+                binding.BindOutput(outputName.c_str(), outputTensors[static_cast<size_t>(batchSize - 1)]);
+                boundBatchSize = batchSize;
+            }
+            
+            model->session.Run(runOptions, binding);
+        }
+        
+        // The model's tensor shape for one row, checked to be float and to hold exactly the
+        // expected number of values per row. A free leading dimension is the batch; other
+        // free dimensions are bound as 1.
+        static std::vector<int64_t> getRowShape(const Ort::TypeInfo& typeInfo, int expectedSize, bool& batches)
+        {
+            const auto tensorInfo = typeInfo.GetTensorTypeAndShapeInfo();
+            auto shape = tensorInfo.GetShape();
+            
+            batches = shape.size() > 1 && shape[0] <= 0;
+            
+            int64_t size = 1;
+            for (auto& dimension : shape)
+            {
+                dimension = dimension > 0 ? dimension : 1;
+                size *= dimension;
+            }
+            
+            if (tensorInfo.GetElementType() != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT || size != expectedSize)
+                throw std::runtime_error("expected float tensors of " + std::to_string(frameSize)
+                                         + " samples in and " + std::to_string(numBins) + " bins out");
+            
+            return shape;
+        }
+#endif
+        
+        void unload()
+        {
+            loaded = false;
+            
+#if ONNX_RUNTIME_SESSIONS
+            binding = Ort::IoBinding(nullptr);
+            boundBatchSize = 0;
+            inputTensors.clear();
+            outputTensors.clear();
+            model.reset();
+#endif
+        }
+        
+        // The newest frameSize samples at 16kHz, each a tent-weighted average of the input as
+        // wide as the resampling step, so content above 8kHz is attenuated rather than folded.
+        // Then zero mean and unit variance, as CREPE was trained on.
+        void prepareFrame(int row, const float* input, int numSamples, double inputSampleRate)
+        {
+            float* const frame = frames.data() + row * frameSize;
+            
+            const double step = inputSampleRate / modelSampleRate;
+            const double width = jmax(1.0, step);
+            
+            for (int j = 0; j < frameSize; ++j)
+            {
+                const double centre = (numSamples - 1) - (frameSize - 1 - j) * step;
+                const int first = jmax(0, static_cast<int>(std::ceil(centre - width)));
+                const int last = jmin(numSamples - 1, static_cast<int>(std::floor(centre + width)));
                 
-                // Mock harmonic analysis
-                result.harmonics.resize(8);
-                for (int i = 0; i < 8; ++i)
+                double sum = 0.0;
+                double weightSum = 0.0;
+                
+                for (int n = first; n <= last; ++n)
                 {
-                    result.harmonics[i] = result.confidence * std::pow(0.8f, i);
+                    const double weight = 1.0 - std::abs(n - centre) / width;
+                    sum += weight * input[n];
+                    weightSum += weight;
                 }
+                
+                frame[j] = weightSum > 0.0 ? static_cast<float>(sum / weightSum) : 0.0f;
+            }
+            
+            double mean = 0.0;
+            for (int j = 0; j < frameSize; ++j)
+                mean += frame[j];
+            mean /= frameSize;
+            
+            double variance = 0.0;
+            for (int j = 0; j < frameSize; ++j)
+                variance += (frame[j] - mean) * (frame[j] - mean);
+            
+            const double scale = 1.0 / jmax(1.0e-8, std::sqrt(variance / frameSize));
+            for (int j = 0; j < frameSize; ++j)
+                frame[j] = static_cast<float>((frame[j] - mean) * scale);
+        }
+        
+        // Weighted average of the bins around the strongest one, in cents; its salience is the
+        // confidence
+        AIModelLoader::PitchPrediction decode(int row) const
+        {
+            AIModelLoader::PitchPrediction result;
+            
+            const float* const bins = salience.data() + row * numBins;
+            const int peak = static_cast<int>(std::max_element(bins, bins + numBins) - bins);
+            
+            float weightedCents = 0.0f;
+            float weightSum = 0.0f;
+            
+            for (int bin = jmax(0, peak - decodeRadius); bin <= jmin(numBins - 1, peak + decodeRadius); ++bin)
+            {
+                const float weight = bins[bin];
+                weightedCents += weight * (firstBinCents + centsPerBin * bin);
+                weightSum += weight;
+            }
+            
+            if (weightSum > 0.0f)
+            {
+                result.frequency = 10.0f * std::pow(2.0f, weightedCents / weightSum / 1200.0f);
+                result.confidence = jlimit(0.0f, 1.0f, bins[peak]);
+                result.voicing = result.confidence;
             }
             
             return result;
         }
-    } crepeModel;
+    };
+    
+    // Replaced whole by each load, so a model that fails to load never displaces a working one
+    std::unique_ptr<CrepeModel> crepeModel = std::make_unique<CrepeModel>();
     
     // Mock DDSP model
     struct MockDDSPModel
@@ -133,10 +299,12 @@ struct AIModelLoader::Impl
         }
     } ddspModel;
     
-    // Performance monitoring 
+    // Performance monitoring: the last maxHistorySize timings, oldest overwritten first
     int64_t lastProcessTime;
-    std::vector<float> processingTimes;
     static constexpr int maxHistorySize = 100;
+    std::array<float, maxHistorySize> processingTimes {};
+    int processingTimesWritePos = 0;
+    int numProcessingTimes = 0;
 };
 
 AIModelLoader::AIModelLoader()
@@ -144,7 +312,6 @@ AIModelLoader::AIModelLoader()
       currentQuality(ProcessingQuality::Standard),
       useMultiThreading(true),
       maxThreads(static_cast<int>(std::thread::hardware_concurrency())),
-      threadPool(maxThreads),
       lastProcessingTime(0.0f),
       averageProcessingTime(0.0f),
       processedFrames(0)
@@ -153,11 +320,12 @@ AIModelLoader::AIModelLoader()
     
     // Initialize model info
     crepeInfo.name = "CREPE";
-    crepeInfo.version = "1.0.0 (Mock)";
     crepeInfo.description = "Convolutional Representation for Pitch Estimation";
-    crepeInfo.sampleRate = 44100.0f;
-    crepeInfo.inputSize = 1024;
-    crepeInfo.outputSize = 360; // CREPE outputs 360 pitch bins
+    crepeInfo.sampleRate = static_cast<float>(Impl::CrepeModel::modelSampleRate);
+    crepeInfo.inputSize = Impl::CrepeModel::frameSize;
+    crepeInfo.outputSize = Impl::CrepeModel::numBins;
+    crepeHopSeconds = getQualityTier(currentQuality).hopSeconds;
+    crepeInfo.hopSeconds = crepeHopSeconds;
     
     ddspInfo.name = "DDSP";
     ddspInfo.version = "1.0.0 (Mock)";
@@ -174,33 +342,50 @@ AIModelLoader::~AIModelLoader()
 
 bool AIModelLoader::loadCrepeModel(const File& modelFile)
 {
-    const ScopedLock lock(modelLock);
-    
+    // Whatever happens, the current model keeps running until the new one is ready
     if (!validateModelFile(modelFile, "crepe"))
     {
-        lastError = AIError(AIError::ModelNotFound, String("CREPE model file not found or invalid"));
+        setError(AIError::ModelNotFound, String("CREPE model file not found or invalid"));
         return false;
     }
     
+#if ONNX_RUNTIME_SESSIONS
+    auto replacement = std::make_unique<Impl::CrepeModel>();
+    
     try
     {
-        // In a real implementation, this would load the actual CREPE model
-        // For now, we'll simulate loading
-        pImpl->crepeModel.loaded = true;
-        pImpl->crepeModel.sampleRate = 44100.0f;
-        
-        crepeInfo.isLoaded = true;
-        
-        if (onModelLoaded)
-            onModelLoaded(String("CREPE model loaded successfully"));
-            
-        return true;
+        // Built outside the lock: predictions carry on with the current model meanwhile
+        replacement->load(modelFile);
     }
     catch (const std::exception& e)
     {
-        lastError = AIError(AIError::ModelLoadFailed, String("Failed to load CREPE model: ") + String(e.what()));
+        setError(AIError::ModelLoadFailed, String("Failed to load CREPE model: ") + String(e.what()));
         return false;
     }
+    
+    {
+        const ScopedLock lock(modelLock);
+        
+        // The old model goes with replacement, after the lock is released
+        std::swap(pImpl->crepeModel, replacement);
+        
+        crepeInfo.version = String("ONNX Runtime ") + OrtGetApiBase()->GetVersionString();
+        crepeInfo.isLoaded = true;
+        crepeInfo.variant = modelFile.getFileNameWithoutExtension();
+        crepeInfo.inferenceMilliseconds = pImpl->crepeModel->model->frameMilliseconds;
+        updateCrepeTiming();
+        crepeLoaded = true;
+        crepeIdentity = pImpl->crepeModel->model.get();
+    }
+    
+    if (onModelLoaded)
+        onModelLoaded(String("CREPE model loaded successfully"));
+    
+    return true;
+#else
+    setError(AIError::ModelLoadFailed, String("CREPE needs ONNX Runtime, which this build does not include"));
+    return false;
+#endif
 }
 
 bool AIModelLoader::loadDDSPModel(const File& modelFile)
@@ -209,7 +394,7 @@ bool AIModelLoader::loadDDSPModel(const File& modelFile)
     
     if (!validateModelFile(modelFile, "ddsp"))
     {
-        lastError = AIError(AIError::ModelNotFound, String("DDSP model file not found or invalid"));
+        setError(AIError::ModelNotFound, String("DDSP model file not found or invalid"));
         return false;
     }
     
@@ -228,7 +413,7 @@ bool AIModelLoader::loadDDSPModel(const File& modelFile)
     }
     catch (const std::exception& e)
     {
-        lastError = AIError(AIError::ModelLoadFailed, String("Failed to load DDSP model: ") + String(e.what()));
+        setError(AIError::ModelLoadFailed, String("Failed to load DDSP model: ") + String(e.what()));
         return false;
     }
 }
@@ -240,60 +425,71 @@ bool AIModelLoader::areModelsLoaded() const
 
 AIModelLoader::PitchPrediction AIModelLoader::predictPitch(const float* audioBuffer, int numSamples, float sampleRate)
 {
-    if (!pImpl->crepeModel.loaded)
-    {
-        lastError = AIError(AIError::ProcessingError, String("CREPE model not loaded"));
-        return PitchPrediction();
-    }
-    
-    auto startTime = Time::getCurrentTime();
-    
-    // Preprocess audio for CREPE
-    std::vector<float> preprocessed = preprocessAudioForCrepe(audioBuffer, numSamples, sampleRate);
-    
-    // Predict using mock CREPE model
-    PitchPrediction result = pImpl->crepeModel.predict(preprocessed);
-    
-    // Update performance metrics
-    auto endTime = Time::getCurrentTime();
-    lastProcessingTime = static_cast<float>((endTime - startTime).inMilliseconds());
-    updatePerformanceMetrics();
+    const PitchFrame frame { audioBuffer, numSamples, sampleRate };
+    PitchPrediction result;
     
+    predictPitchBatch(&frame, 1, &result);
     return result;
 }
 
-std::vector<AIModelLoader::PitchPrediction> AIModelLoader::predictPitchBatch(
-    const std::vector<std::vector<float>>& audioBuffers, float sampleRate)
+bool AIModelLoader::predictPitchBatch(const PitchFrame* frames, int numFrames, PitchPrediction* results,
+                                      const void* expectedModel)
 {
-    std::vector<PitchPrediction> results;
+    // Never waits for a load on the message thread
+    const ScopedTryLock lock(modelLock);
+    
+    if (!lock.isLocked())
+        return false;
+    
+    auto& crepe = *pImpl->crepeModel;
     
-    if (!useMultiThreading || audioBuffers.size() <= 1)
+    if (!crepe.loaded || (expectedModel != nullptr && crepeIdentity.load() != expectedModel))
+        return false;
+    
+    const double startTime = Time::getMillisecondCounterHiRes();
+    
+    for (int first = 0; first < numFrames; first += crepe.batchCapacity)
     {
-        // Process sequentially
-        for (const auto& buffer : audioBuffers)
+        const int batchSize = jmin(crepe.batchCapacity, numFrames - first);
+        
+        for (int row = 0; row < batchSize; ++row)
         {
-            results.push_back(predictPitch(buffer.data(), static_cast<int>(buffer.size()), sampleRate));
+            const auto& frame = frames[first + row];
+            crepe.prepareFrame(row, frame.samples, frame.numSamples, frame.sampleRate);
         }
-    }
-    else
-    {
-        // Process in parallel
-        std::vector<std::future<PitchPrediction>> futures;
         
-        for (const auto& buffer : audioBuffers)
+#if ONNX_RUNTIME_SESSIONS
+        try
         {
-            futures.push_back(std::async(std::launch::async, [this, &buffer, sampleRate]()
-            {
-                return predictPitch(buffer.data(), static_cast<int>(buffer.size()), sampleRate);
-            }));
+            crepe.run(batchSize);
         }
-        
-        for (auto& future : futures)
+        catch (const std::exception& e)
         {
-            results.push_back(future.get());
+            setError(AIError::ProcessingError, String("CREPE inference failed: ") + String(e.what()));
+            return false;
         }
+#endif
+        
+        for (int row = 0; row < batchSize; ++row)
+            results[first + row] = crepe.decode(row);
     }
     
+    updatePerformanceMetrics(static_cast<float>(Time::getMillisecondCounterHiRes() - startTime));
+    
+    return true;
+}
+
+std::vector<AIModelLoader::PitchPrediction> AIModelLoader::predictPitchBatch(
+    const std::vector<std::vector<float>>& audioBuffers, float sampleRate)
+{
+    std::vector<PitchFrame> frames;
+    frames.reserve(audioBuffers.size());
+    
+    for (const auto& buffer : audioBuffers)
+        frames.push_back({ buffer.data(), static_cast<int>(buffer.size()), sampleRate });
+    
+    std::vector<PitchPrediction> results(audioBuffers.size());
+    predictPitchBatch(frames.data(), static_cast<int>(frames.size()), results.data());
     return results;
 }
 
@@ -301,7 +497,7 @@ std::vector<float> AIModelLoader::synthesizeAudio(const SynthesisParams& params,
 {
     if (!pImpl->ddspModel.loaded)
     {
-        lastError = AIError(AIError::ProcessingError, String("DDSP model not loaded"));
+        setError(AIError::ProcessingError, String("DDSP model not loaded"));
         return std::vector<float>(numSamples, 0.0f);
     }
     
@@ -315,8 +511,7 @@ std::vector<float> AIModelLoader::synthesizeAudio(const SynthesisParams& params,
     
     // Update performance metrics
     auto endTime = Time::getCurrentTime();
-    lastProcessingTime = static_cast<float>((endTime - startTime).inMilliseconds());
-    updatePerformanceMetrics();
+    updatePerformanceMetrics(static_cast<float>((endTime - startTime).inMilliseconds()));
     
     return result;
 }
@@ -326,7 +521,7 @@ bool AIModelLoader::processWithDDSP(const float* inputBuffer, float* outputBuffe
 {
     if (!pImpl->ddspModel.loaded)
     {
-        lastError = AIError(AIError::ProcessingError, String("DDSP model not loaded"));
+        setError(AIError::ProcessingError, String("DDSP model not loaded"));
         return false;
     }
     
@@ -366,10 +561,12 @@ void AIModelLoader::unloadModels()
 {
     ScopedLock lock(modelLock);
     
-    pImpl->crepeModel.loaded = false;
+    crepeIdentity = nullptr;
+    pImpl->crepeModel->unload();
     pImpl->ddspModel.loaded = false;
     
     crepeInfo.isLoaded = false;
+    crepeLoaded = false;
     ddspInfo.isLoaded = false;
     
     clearError();
@@ -379,8 +576,10 @@ bool AIModelLoader::reloadModels()
 {
     unloadModels();
     
-    // Try to reload from the model directory
-    auto crepeFile = modelDirectory.getChildFile("crepe_model.onnx");
+    // Try to reload from the model directory: the quality tier's CREPE variant if it is there
+    auto crepeFile = findCrepeModel(currentQuality);
+    if (crepeFile == File())
+        crepeFile = modelDirectory.getChildFile("crepe_model.onnx");
     auto ddspFile = modelDirectory.getChildFile("ddsp_model.onnx");
     
     bool success = true;
@@ -406,26 +605,62 @@ void AIModelLoader::setModelDirectory(const File& directory)
     }
 }
 
-void AIModelLoader::setProcessingQuality(ProcessingQuality quality)
+AIModelLoader::QualityTier AIModelLoader::getQualityTier(ProcessingQuality quality)
 {
-    currentQuality = quality;
-    
-    // Adjust model parameters based on quality
     switch (quality)
     {
         case ProcessingQuality::Draft:
-            // Fastest processing, lower quality
-            break;
+            return { "tiny", { "_int8", "_fp16", "" }, longestHopSeconds };
         case ProcessingQuality::Standard:
-            // Balanced processing
-            break;
+            return { "small", { "_int8", "_fp16", "" }, 0.02 };
         case ProcessingQuality::High:
-            // Higher quality, slower processing
-            break;
+            return { "medium", { "_int8", "_fp16", "" }, shortestHopSeconds };
         case ProcessingQuality::Ultra:
-            // Best quality, slowest processing
             break;
     }
+    
+    // Full precision: quantization costs CREPE a few cents, which only Ultra cannot spare
+    return { "full", { "", "_fp16", "_int8" }, shortestHopSeconds };
+}
+
+File AIModelLoader::findCrepeModel(ProcessingQuality quality) const
+{
+    const auto tier = getQualityTier(quality);
+    
+    // ORT-format files first: ModelRegistry runs those straight from the mapped file
+    for (const char* precision : tier.precisions)
+    {
+        for (const char* extension : { ".ort", ".onnx" })
+        {
+            auto file = modelDirectory.getChildFile(String("crepe_") + tier.capacity + precision + extension);
+            
+            if (file.existsAsFile())
+                return file;
+        }
+    }
+    
+    return {};
+}
+
+void AIModelLoader::setProcessingQuality(ProcessingQuality quality)
+{
+    currentQuality = quality;
+    crepeHopSeconds = getQualityTier(quality).hopSeconds;
+    
+    // Without a CREPE model loaded there is nothing to swap; reloadModels() picks the tier's
+    const auto variant = findCrepeModel(quality);
+    
+    if (crepeInfo.isLoaded && variant != File() && variant.getFileNameWithoutExtension() != crepeInfo.variant)
+        loadCrepeModel(variant);
+    
+    updateCrepeTiming();
+}
+
+void AIModelLoader::updateCrepeTiming()
+{
+    crepeInfo.hopSeconds = crepeHopSeconds;
+    crepeInfo.realTimeFactor = crepeInfo.isLoaded ? crepeInfo.inferenceMilliseconds / (1000.0 * crepeInfo.hopSeconds)
+                                                  : 0.0;
 }
 
 void AIModelLoader::setUseMultiThreading(bool useThreads)
@@ -436,8 +671,8 @@ void AIModelLoader::setUseMultiThreading(bool useThreads)
 void AIModelLoader::setMaxThreads(int threads)
 {
     maxThreads = jmax(1, threads);
-    // Note: JUCE ThreadPool manages its own threads automatically
-    // We'll use maxThreads to limit our own threading logic
+    // Note: inference runs on the process-wide InferenceScheduler thread, and ONNX Runtime's
+    // shared pool adds none of its own (see ModelRegistry)
 }
 
 void AIModelLoader::setupDefaultModelDirectory()
@@ -458,53 +693,7 @@ bool AIModelLoader::validateModelFile(const File& file, const String& expectedTy
     
     // Basic validation - in a real implementation, this would check file format, headers, etc.
     auto extension = file.getFileExtension().toLowerCase();
-    return extension == ".onnx" || extension == ".pb" || extension == ".tflite";
-}
-
-std::vector<float> AIModelLoader::preprocessAudioForCrepe(const float* input, int numSamples, float targetSampleRate)
-{
-    std::vector<float> output;
-    
-    if (targetSampleRate == crepeInfo.sampleRate)
-    {
-        // No resampling needed
-        output.assign(input, input + numSamples);
-    }
-    else
-    {
-        // Simple resampling (in real implementation, would use high-quality resampler)
-        float ratio = targetSampleRate / crepeInfo.sampleRate;
-        int newSize = static_cast<int>(numSamples / ratio);
-        output.resize(newSize);
-        
-        for (int i = 0; i < newSize; ++i)
-        {
-            float sourceIndex = i * ratio;
-            int index1 = static_cast<int>(sourceIndex);
-            int index2 = jmin(index1 + 1, numSamples - 1);
-            float fraction = sourceIndex - index1;
-            
-            output[i] = input[index1] * (1.0f - fraction) + input[index2] * fraction;
-        }
-    }
-    
-    // Normalize
-    float maxAbs = 0.0f;
-    for (float sample : output)
-    {
-        maxAbs = jmax(maxAbs, std::abs(sample));
-    }
-    
-    if (maxAbs > 0.0f)
-    {
-        float scale = 1.0f / maxAbs;
-        for (float& sample : output)
-        {
-            sample *= scale;
-        }
-    }
-    
-    return output;
+    return extension == ".onnx" || extension == ".ort" || extension == ".pb" || extension == ".tflite";
 }
 
 AIModelLoader::SynthesisParams AIModelLoader::extractSynthesisParams(
@@ -564,22 +753,48 @@ void AIModelLoader::postprocessDDSPOutput(float* output, int numSamples, float g
     }
 }
 
-void AIModelLoader::updatePerformanceMetrics()
+AIModelLoader::AIError AIModelLoader::getLastError() const
+{
+    const ScopedLock lock(statusLock);
+    return lastError;
+}
+
+bool AIModelLoader::hasError() const
+{
+    const ScopedLock lock(statusLock);
+    return lastError.type != AIError::None;
+}
+
+void AIModelLoader::clearError()
+{
+    const ScopedLock lock(statusLock);
+    lastError = AIError();
+}
+
+void AIModelLoader::setError(AIError::Type type, const String& message)
 {
+    const ScopedLock lock(statusLock);
+    lastError = AIError(type, message);
+}
+
+void AIModelLoader::updatePerformanceMetrics(float processingTime)
+{
+    const ScopedLock lock(statusLock);
+    
+    lastProcessingTime = processingTime;
     processedFrames++;
     
     // Add to processing time history
-    pImpl->processingTimes.push_back(lastProcessingTime);
-    if (pImpl->processingTimes.size() > pImpl->maxHistorySize)
-    {
-        pImpl->processingTimes.erase(pImpl->processingTimes.begin());
-    }
+    auto& impl = *pImpl;
+    impl.processingTimes[static_cast<size_t>(impl.processingTimesWritePos)] = lastProcessingTime;
+    impl.processingTimesWritePos = (impl.processingTimesWritePos + 1) % Impl::maxHistorySize;
+    impl.numProcessingTimes = jmin(impl.numProcessingTimes + 1, Impl::maxHistorySize);
     
     // Calculate average processing time
     float sum = 0.0f;
-    for (float time : pImpl->processingTimes)
+    for (int i = 0; i < impl.numProcessingTimes; ++i)
     {
-        sum += time;
+        sum += impl.processingTimes[static_cast<size_t>(i)];
     }
-    averageProcessingTime = sum / pImpl->processingTimes.size();
+    averageProcessingTime = sum / impl.numProcessingTimes;
 }
\ No newline at end of file
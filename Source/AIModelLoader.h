@@ -1,6 +1,8 @@
 #pragma once
 
 #include "JuceHeader.h"
+#include <array>
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <string>
@@ -21,6 +23,14 @@
   #define ONNX_AVAILABLE 0
 #endif
 
+// Sessions need the real ONNX Runtime headers (they define ORT_API_VERSION); the compile-only
+// stand-ins bundled under external/libs do not, and builds with them load no models
+#if ONNX_AVAILABLE && defined(ORT_API_VERSION)
+  #define ONNX_RUNTIME_SESSIONS 1
+#else
+  #define ONNX_RUNTIME_SESSIONS 0
+#endif
+
 #ifdef USE_EIGEN
 #include <Eigen/Dense>
 #include <Eigen/Core>
@@ -42,10 +52,16 @@ public:
     AIModelLoader();
     ~AIModelLoader();
 
-    // Model loading and management
+    // Model loading and management. A CREPE model replaces the current one only once it has
+    // loaded; on failure (false, see getLastError()) the current one keeps running.
     bool loadCrepeModel(const File& modelFile);
     bool loadDDSPModel(const File& modelFile);
     bool areModelsLoaded() const;
+    bool isCrepeModelLoaded() const { return crepeLoaded.load(); }     // Any thread
+    
+    // The shared session behind the loaded CREPE model (see ModelRegistry), or null. Loaders
+    // reporting the same one can run each other's frames in one batch. Any thread.
+    const void* getCrepeModelIdentity() const { return crepeIdentity.load(); }
     
     // Model information
     struct ModelInfo
@@ -58,7 +74,16 @@ public:
         int outputSize;
         bool isLoaded;
         
-        ModelInfo() : sampleRate(44100.0f), inputSize(0), outputSize(0), isLoaded(false) {}
+        // CREPE only: the variant file loaded (e.g. "crepe_small_int8"), the quality tier's hop,
+        // one frame's Run() as timed at load on this machine, and the share of one core a
+        // stream takes at that hop
+        String variant;
+        double hopSeconds;
+        double inferenceMilliseconds;
+        double realTimeFactor;
+        
+        ModelInfo() : sampleRate(44100.0f), inputSize(0), outputSize(0), isLoaded(false),
+                      hopSeconds(0.0), inferenceMilliseconds(0.0), realTimeFactor(0.0) {}
     };
     
     ModelInfo getCrepeModelInfo() const { return crepeInfo; }
@@ -75,8 +100,27 @@ public:
         PitchPrediction() : frequency(0.0f), confidence(0.0f), voicing(0.0f) {}
     };
     
-    // CREPE pitch detection
+    // CREPE pitch detection on the newest 64ms of audioBuffer (shorter buffers are zero-padded
+    // in front), resampled to the model's 16kHz. One session Run() over preallocated, pre-bound
+    // tensors; returns an empty prediction while a model is being (un)loaded.
     PitchPrediction predictPitch(const float* audioBuffer, int numSamples, float sampleRate);
+    
+    // Batched CREPE: frames go through the session up to 64 at a time as one [N, 1024] tensor
+    // per Run(), one prediction written per frame. Returns false, leaving results as they were,
+    // while a model is being (un)loaded, when none is, or when inference fails. Allocates
+    // nothing here short of a failure's error message; ORT's own buffers are sized at load.
+    // Given an expectedModel (a getCrepeModelIdentity() taken earlier), also returns false
+    // once a different model has been swapped in, so frames grouped by one model never run
+    // through another.
+    struct PitchFrame
+    {
+        const float* samples;
+        int numSamples;
+        float sampleRate;
+    };
+    
+    bool predictPitchBatch(const PitchFrame* frames, int numFrames, PitchPrediction* results,
+                           const void* expectedModel = nullptr);
     std::vector<PitchPrediction> predictPitchBatch(const std::vector<std::vector<float>>& audioBuffers, float sampleRate);
     
     // DDSP synthesis
@@ -109,9 +153,34 @@ public:
         Ultra       // Slowest, best quality
     };
     
+    // What each tier runs: a CREPE capacity, the precisions to look for in order (file suffixes
+    // after the capacity, "" for FP32) and how often a frame is analysed. INT8 graphs come
+    // first where they are offered: on the CPU they run 3-4x faster than FP32, while FP16 only
+    // halves the file, so it is a fallback.
+    struct QualityTier
+    {
+        const char* capacity;
+        std::array<const char*, 3> precisions;
+        double hopSeconds;
+    };
+    
+    static constexpr double shortestHopSeconds = 0.01;     // Of all tiers
+    static constexpr double longestHopSeconds = 0.04;
+    static QualityTier getQualityTier(ProcessingQuality quality);
+    
+    // Sets the CREPE hop, and with a CREPE model loaded swaps in the tier's variant from the
+    // model directory (crepe_<capacity><precision>.ort or .onnx) when there is one and it
+    // loads. Message thread; another instance already on the variant makes the swap instant
+    // (ModelRegistry).
     void setProcessingQuality(ProcessingQuality quality);
     ProcessingQuality getProcessingQuality() const { return currentQuality; }
     
+    // The tier's variant in the model directory, or File() when none of its files is there
+    File findCrepeModel(ProcessingQuality quality) const;
+    
+    // Seconds between CREPE frames for the current tier; any thread
+    double getCrepeHopSeconds() const { return crepeHopSeconds.load(); }
+    
     // Threading and performance
     void setUseMultiThreading(bool useThreads);
     bool isUsingMultiThreading() const { return useMultiThreading; }
@@ -138,9 +207,10 @@ public:
         bool operator==(const AIError& other) const { return type == other.type; }
     };
     
-    AIError getLastError() const { return lastError; }
-    bool hasError() const { return lastError.type != AIError::None; }
-    void clearError() { lastError = AIError(); }
+    // Any thread: loads report on the message thread, inference on the scheduler's
+    AIError getLastError() const;
+    bool hasError() const;
+    void clearError();
     
     // Callbacks
     std::function<void(const String&)> onModelLoaded;
@@ -155,6 +225,9 @@ private:
     // Model information
     ModelInfo crepeInfo;
     ModelInfo ddspInfo;
+    std::atomic<bool> crepeLoaded { false };      // crepeInfo.isLoaded, for other threads
+    std::atomic<const void*> crepeIdentity { nullptr };
+    std::atomic<double> crepeHopSeconds { shortestHopSeconds };
     
     // Configuration
     File modelDirectory;
@@ -162,26 +235,27 @@ private:
     bool useMultiThreading;
     int maxThreads;
     
-    // Error tracking
+    // Error tracking, guarded by statusLock with the performance metrics
     AIError lastError;
+    void setError(AIError::Type type, const String& message);
     
     // Internal methods
     bool initializeCrepeModel(const File& modelFile);
     bool initializeDDSPModel(const File& modelFile);
     void setupDefaultModelDirectory();
     bool validateModelFile(const File& file, const String& expectedType);
+    void updateCrepeTiming();
     
     // Processing helpers
-    std::vector<float> preprocessAudioForCrepe(const float* input, int numSamples, float targetSampleRate);
     SynthesisParams extractSynthesisParams(const float* audioBuffer, int numSamples, float sampleRate);
     void postprocessDDSPOutput(float* output, int numSamples, float gainAdjustment);
     
     // Thread management
-    ThreadPool threadPool;
     CriticalSection modelLock;
     
     // Performance monitoring
-    void updatePerformanceMetrics();
+    CriticalSection statusLock;
+    void updatePerformanceMetrics(float processingTime);
     float lastProcessingTime;
     float averageProcessingTime;
     int processedFrames;
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// std::vector whose storage starts on a cache line and is padded to a whole number of
+// lines. Buffers that several plugin instances allocate on the message thread end up
+// next to each other on the heap; with this, one written every sample on one audio
+// thread never shares a line with another instance's buffer on another thread.
+template <typename T>
+struct CacheAlignedAllocator
+{
+    using value_type = T;
+
+    static constexpr std::size_t cacheLineSize = 64;
+
+    CacheAlignedAllocator() noexcept = default;
+
+    template <typename U>
+    CacheAlignedAllocator(const CacheAlignedAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(::operator new(paddedSize(n), std::align_val_t(cacheLineSize)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        ::operator delete(p, paddedSize(n), std::align_val_t(cacheLineSize));
+    }
+
+    template <typename U>
+    bool operator==(const CacheAlignedAllocator<U>&) const noexcept { return true; }
+
+    template <typename U>
+    bool operator!=(const CacheAlignedAllocator<U>&) const noexcept { return false; }
+
+private:
+    static std::size_t paddedSize(std::size_t n)
+    {
+        return (n * sizeof(T) + cacheLineSize - 1) / cacheLineSize * cacheLineSize;
+    }
+};
+
+template <typename T>
+using CacheAlignedVector = std::vector<T, CacheAlignedAllocator<T>>;
@@ -0,0 +1,349 @@
+#include "DSPKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+ #define DSP_KERNELS_X86 1
+ #include <immintrin.h>
+ #if defined(__GNUC__) || defined(__clang__)
+  #define DSP_KERNELS_AVX2_TARGET __attribute__((target("avx2,fma")))
+ #else
+  #define DSP_KERNELS_AVX2_TARGET
+ #endif
+#elif defined(__ARM_NEON) || defined(__aarch64__) || defined(_M_ARM64)
+ #define DSP_KERNELS_NEON 1
+ #include <arm_neon.h>
+#endif
+
+namespace
+{
+    // ========================================================================
+    // Scalar fallback
+    // ========================================================================
+
+    float dotProductScalar(const float* a, const float* b, int numSamples)
+    {
+        float result = 0.0f;
+        for (int i = 0; i < numSamples; ++i)
+            result += a[i] * b[i];
+        return result;
+    }
+
+    float sumOfSquaresScalar(const float* a, int numSamples)
+    {
+        float result = 0.0f;
+        for (int i = 0; i < numSamples; ++i)
+            result += a[i] * a[i];
+        return result;
+    }
+
+    float sumOfSquaredDifferencesScalar(const float* a, const float* b, int numSamples)
+    {
+        float result = 0.0f;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float delta = a[i] - b[i];
+            result += delta * delta;
+        }
+        return result;
+    }
+
+    float sumScalar(const float* a, int numSamples)
+    {
+        float result = 0.0f;
+        for (int i = 0; i < numSamples; ++i)
+            result += a[i];
+        return result;
+    }
+
+    void multiplyScalar(float* dest, const float* src, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] *= src[i];
+    }
+
+#if DSP_KERNELS_X86
+    // ========================================================================
+    // SSE2 (baseline on x86-64)
+    // ========================================================================
+
+    inline float horizontalSum(__m128 v)
+    {
+        __m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 sums = _mm_add_ps(v, shuffled);
+        shuffled = _mm_movehl_ps(shuffled, sums);
+        sums = _mm_add_ss(sums, shuffled);
+        return _mm_cvtss_f32(sums);
+    }
+
+    float dotProductSSE2(const float* a, const float* b, int numSamples)
+    {
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        int i = 0;
+
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+
+        float result = horizontalSum(_mm_add_ps(acc0, acc1));
+        return result + dotProductScalar(a + i, b + i, numSamples - i);
+    }
+
+    float sumOfSquaresSSE2(const float* a, int numSamples)
+    {
+        return dotProductSSE2(a, a, numSamples);
+    }
+
+    float sumOfSquaredDifferencesSSE2(const float* a, const float* b, int numSamples)
+    {
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        int i = 0;
+
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            __m128 d0 = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+            __m128 d1 = _mm_sub_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4));
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(d0, d0));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(d1, d1));
+        }
+
+        float result = horizontalSum(_mm_add_ps(acc0, acc1));
+        return result + sumOfSquaredDifferencesScalar(a + i, b + i, numSamples - i);
+    }
+
+    float sumSSE2(const float* a, int numSamples)
+    {
+        __m128 acc = _mm_setzero_ps();
+        int i = 0;
+
+        for (; i + 4 <= numSamples; i += 4)
+            acc = _mm_add_ps(acc, _mm_loadu_ps(a + i));
+
+        return horizontalSum(acc) + sumScalar(a + i, numSamples - i);
+    }
+
+    void multiplySSE2(float* dest, const float* src, int numSamples)
+    {
+        int i = 0;
+
+        for (; i + 4 <= numSamples; i += 4)
+            _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_loadu_ps(dest + i), _mm_loadu_ps(src + i)));
+
+        multiplyScalar(dest + i, src + i, numSamples - i);
+    }
+
+    // ========================================================================
+    // AVX2 + FMA (selected at runtime)
+    // ========================================================================
+
+    DSP_KERNELS_AVX2_TARGET inline float horizontalSum(__m256 v)
+    {
+        __m128 low = _mm256_castps256_ps128(v);
+        __m128 high = _mm256_extractf128_ps(v, 1);
+        return horizontalSum(_mm_add_ps(low, high));
+    }
+
+    DSP_KERNELS_AVX2_TARGET float dotProductAVX2(const float* a, const float* b, int numSamples)
+    {
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        int i = 0;
+
+        for (; i + 16 <= numSamples; i += 16)
+        {
+            acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+            acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+        }
+
+        float result = horizontalSum(_mm256_add_ps(acc0, acc1));
+        return result + dotProductScalar(a + i, b + i, numSamples - i);
+    }
+
+    DSP_KERNELS_AVX2_TARGET float sumOfSquaresAVX2(const float* a, int numSamples)
+    {
+        return dotProductAVX2(a, a, numSamples);
+    }
+
+    DSP_KERNELS_AVX2_TARGET float sumOfSquaredDifferencesAVX2(const float* a, const float* b, int numSamples)
+    {
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        int i = 0;
+
+        for (; i + 16 <= numSamples; i += 16)
+        {
+            __m256 d0 = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+            __m256 d1 = _mm256_sub_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8));
+            acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+            acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+        }
+
+        float result = horizontalSum(_mm256_add_ps(acc0, acc1));
+        return result + sumOfSquaredDifferencesScalar(a + i, b + i, numSamples - i);
+    }
+
+    DSP_KERNELS_AVX2_TARGET float sumAVX2(const float* a, int numSamples)
+    {
+        __m256 acc = _mm256_setzero_ps();
+        int i = 0;
+
+        for (; i + 8 <= numSamples; i += 8)
+            acc = _mm256_add_ps(acc, _mm256_loadu_ps(a + i));
+
+        return horizontalSum(acc) + sumScalar(a + i, numSamples - i);
+    }
+
+    DSP_KERNELS_AVX2_TARGET void multiplyAVX2(float* dest, const float* src, int numSamples)
+    {
+        int i = 0;
+
+        for (; i + 8 <= numSamples; i += 8)
+            _mm256_storeu_ps(dest + i, _mm256_mul_ps(_mm256_loadu_ps(dest + i), _mm256_loadu_ps(src + i)));
+
+        multiplyScalar(dest + i, src + i, numSamples - i);
+    }
+#endif
+
+#if DSP_KERNELS_NEON
+    // ========================================================================
+    // NEON
+    // ========================================================================
+
+    inline float horizontalSum(float32x4_t v)
+    {
+       #if defined(__aarch64__) || defined(_M_ARM64)
+        return vaddvq_f32(v);
+       #else
+        float32x2_t pair = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+        return vget_lane_f32(vpadd_f32(pair, pair), 0);
+       #endif
+    }
+
+    float dotProductNEON(const float* a, const float* b, int numSamples)
+    {
+        float32x4_t acc0 = vdupq_n_f32(0.0f);
+        float32x4_t acc1 = vdupq_n_f32(0.0f);
+        int i = 0;
+
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+            acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+        }
+
+        float result = horizontalSum(vaddq_f32(acc0, acc1));
+        return result + dotProductScalar(a + i, b + i, numSamples - i);
+    }
+
+    float sumOfSquaresNEON(const float* a, int numSamples)
+    {
+        return dotProductNEON(a, a, numSamples);
+    }
+
+    float sumOfSquaredDifferencesNEON(const float* a, const float* b, int numSamples)
+    {
+        float32x4_t acc0 = vdupq_n_f32(0.0f);
+        float32x4_t acc1 = vdupq_n_f32(0.0f);
+        int i = 0;
+
+        for (; i + 8 <= numSamples; i += 8)
+        {
+            float32x4_t d0 = vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+            float32x4_t d1 = vsubq_f32(vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+            acc0 = vmlaq_f32(acc0, d0, d0);
+            acc1 = vmlaq_f32(acc1, d1, d1);
+        }
+
+        float result = horizontalSum(vaddq_f32(acc0, acc1));
+        return result + sumOfSquaredDifferencesScalar(a + i, b + i, numSamples - i);
+    }
+
+    float sumNEON(const float* a, int numSamples)
+    {
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        int i = 0;
+
+        for (; i + 4 <= numSamples; i += 4)
+            acc = vaddq_f32(acc, vld1q_f32(a + i));
+
+        return horizontalSum(acc) + sumScalar(a + i, numSamples - i);
+    }
+
+    void multiplyNEON(float* dest, const float* src, int numSamples)
+    {
+        int i = 0;
+
+        for (; i + 4 <= numSamples; i += 4)
+            vst1q_f32(dest + i, vmulq_f32(vld1q_f32(dest + i), vld1q_f32(src + i)));
+
+        multiplyScalar(dest + i, src + i, numSamples - i);
+    }
+#endif
+}
+
+const std::vector<DSPKernels::KernelTable>& DSPKernels::getAvailableKernels()
+{
+    // Resolved once; function-local statics are initialised thread-safely
+    static const std::vector<KernelTable> kernels = []
+    {
+        std::vector<KernelTable> available {
+            { dotProductScalar, sumOfSquaresScalar, sumOfSquaredDifferencesScalar,
+              sumScalar, multiplyScalar, "Scalar" }
+        };
+
+       #if DSP_KERNELS_X86
+        available.push_back({ dotProductSSE2, sumOfSquaresSSE2, sumOfSquaredDifferencesSSE2,
+                              sumSSE2, multiplySSE2, "SSE2" });
+
+        if (SystemStats::hasAVX2() && SystemStats::hasFMA3())
+            available.push_back({ dotProductAVX2, sumOfSquaresAVX2, sumOfSquaredDifferencesAVX2,
+                                  sumAVX2, multiplyAVX2, "AVX2" });
+       #elif DSP_KERNELS_NEON
+        available.push_back({ dotProductNEON, sumOfSquaresNEON, sumOfSquaredDifferencesNEON,
+                              sumNEON, multiplyNEON, "NEON" });
+       #endif
+
+        return available;
+    }();
+
+    return kernels;
+}
+
+const DSPKernels::KernelTable& DSPKernels::getKernels()
+{
+    static const KernelTable& selected = getAvailableKernels().back();
+    return selected;
+}
+
+float DSPKernels::dotProduct(const float* a, const float* b, int numSamples)
+{
+    return numSamples > 0 ? getKernels().dotProduct(a, b, numSamples) : 0.0f;
+}
+
+float DSPKernels::sumOfSquares(const float* a, int numSamples)
+{
+    return numSamples > 0 ? getKernels().sumOfSquares(a, numSamples) : 0.0f;
+}
+
+float DSPKernels::sumOfSquaredDifferences(const float* a, const float* b, int numSamples)
+{
+    return numSamples > 0 ? getKernels().sumOfSquaredDifferences(a, b, numSamples) : 0.0f;
+}
+
+float DSPKernels::sum(const float* a, int numSamples)
+{
+    return numSamples > 0 ? getKernels().sum(a, numSamples) : 0.0f;
+}
+
+void DSPKernels::multiply(float* dest, const float* src, int numSamples)
+{
+    if (numSamples > 0)
+        getKernels().multiply(dest, src, numSamples);
+}
+
+const char* DSPKernels::getInstructionSetName()
+{
+    return getKernels().name;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "JuceHeader.h"
+#include <vector>
+
+// Vectorised inner loops shared by the pitch detectors and Utils.
+// The implementation is picked once at runtime: AVX2/FMA or SSE2 on x86-64,
+// NEON on ARM, and a scalar fallback everywhere else.
+class DSPKernels
+{
+public:
+    // sum(a[i] * b[i])
+    static float dotProduct(const float* a, const float* b, int numSamples);
+
+    // sum(a[i] * a[i])
+    static float sumOfSquares(const float* a, int numSamples);
+
+    // sum((a[i] - b[i])^2)
+    static float sumOfSquaredDifferences(const float* a, const float* b, int numSamples);
+
+    // sum(a[i])
+    static float sum(const float* a, int numSamples);
+
+    // dest[i] *= src[i] (window multiply)
+    static void multiply(float* dest, const float* src, int numSamples);
+
+    // Name of the instruction set selected at runtime ("AVX2", "SSE2", "NEON" or "Scalar")
+    static const char* getInstructionSetName();
+
+    // One implementation of every kernel. The functions expect numSamples > 0.
+    struct KernelTable
+    {
+        float (*dotProduct)(const float*, const float*, int);
+        float (*sumOfSquares)(const float*, int);
+        float (*sumOfSquaredDifferences)(const float*, const float*, int);
+        float (*sum)(const float*, int);
+        void (*multiply)(float*, const float*, int);
+        const char* name;
+    };
+
+    // Every implementation this CPU can run, scalar first and the selected one last.
+    // For tests and benchmarks; DSP code calls the static functions above.
+    static const std::vector<KernelTable>& getAvailableKernels();
+
+private:
+    DSPKernels() = delete; // Static class only
+
+    static const KernelTable& getKernels();
+
+    JUCE_DECLARE_NON_COPYABLE(DSPKernels)
+};
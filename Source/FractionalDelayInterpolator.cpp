@@ -0,0 +1,66 @@
+#include "FractionalDelayInterpolator.h"
+#include "DSPKernels.h"
+#include <cmath>
+
+namespace
+{
+    // Zeroth-order modified Bessel function of the first kind (series form)
+    double besselI0(double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+
+        for (int k = 1; k < 32; ++k)
+        {
+            term *= (x * 0.5 / k) * (x * 0.5 / k);
+            sum += term;
+
+            if (term < sum * 1.0e-12)
+                break;
+        }
+
+        return sum;
+    }
+}
+
+void FractionalDelayInterpolator::prepare(int newNumTaps, int newNumPhases)
+{
+    numTaps = jmax(2, (newNumTaps + 1) & ~1);
+    numPhases = jmax(1, newNumPhases);
+    table.assign(static_cast<size_t>((numPhases + 1) * numTaps), 0.0f);
+
+    const double halfSpan = numTaps / 2;
+    const double windowNorm = besselI0(kaiserBeta);
+
+    for (int phase = 0; phase <= numPhases; ++phase)
+    {
+        const double fraction = static_cast<double>(phase) / numPhases;
+        float* row = &table[static_cast<size_t>(phase * numTaps)];
+        double rowSum = 0.0;
+
+        for (int k = 0; k < numTaps; ++k)
+        {
+            // Tap k sits at offset k - getFirstTapOffset() from the integer position
+            const double x = (k - getFirstTapOffset()) - fraction;
+            const double sinc = x == 0.0 ? 1.0
+                              : x == std::floor(x) ? 0.0 // Exact zeros keep whole-sample reads bit-exact
+                              : std::sin(MathConstants<double>::pi * x) / (MathConstants<double>::pi * x);
+            const double r = x / halfSpan;
+            const double window = std::abs(r) < 1.0 ? besselI0(kaiserBeta * std::sqrt(1.0 - r * r)) / windowNorm : 0.0;
+
+            row[k] = static_cast<float>(sinc * window);
+            rowSum += row[k];
+        }
+
+        // Unity DC gain for every offset; rows 0 and numPhases stay exact unit impulses
+        for (int k = 0; k < numTaps; ++k)
+            row[k] = static_cast<float>(row[k] / rowSum);
+    }
+}
+
+float FractionalDelayInterpolator::interpolate(const float* firstTap, float fraction) const
+{
+    // Rounds to the nearest row; row numPhases covers fractions just below 1
+    const int phase = static_cast<int>(fraction * numPhases + 0.5f);
+    return DSPKernels::dotProduct(firstTap, &table[static_cast<size_t>(phase * numTaps)], numTaps);
+}
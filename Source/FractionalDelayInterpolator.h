@@ -0,0 +1,36 @@
+#pragma once
+
+#include "JuceHeader.h"
+#include <vector>
+
+// Band-limited fractional-delay read from a precomputed polyphase Kaiser-windowed sinc table.
+// Each row holds the numTaps coefficients for one fractional offset, stored contiguously so a
+// read is a single dot product against the nearest row. Phase resolution sets the accuracy:
+// 512 phases keep the error near -57dB at 10kHz (44.1kHz), 1024 about 6dB lower.
+class FractionalDelayInterpolator
+{
+public:
+    FractionalDelayInterpolator() = default;
+
+    // Builds the table; call from prepare, not the audio thread. numTaps is rounded up to even.
+    void prepare(int newNumTaps = 16, int newNumPhases = 512);
+
+    // Value at position index + fraction (0 <= fraction < 1) of a contiguous signal.
+    // firstTap points at sample index - getFirstTapOffset(); numTaps samples are read.
+    float interpolate(const float* firstTap, float fraction) const;
+
+    int getNumTaps() const { return numTaps; }
+    int getNumPhases() const { return numPhases; }
+
+    // Samples needed before and after the integer position
+    int getFirstTapOffset() const { return numTaps / 2 - 1; }
+    int getSamplesAhead() const { return numTaps / 2; }
+
+private:
+    std::vector<float> table; // (numPhases + 1) rows of numTaps; row p is offset p / numPhases
+    int numTaps = 0;
+    int numPhases = 0;
+    static constexpr float kaiserBeta = 8.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FractionalDelayInterpolator)
+};
@@ -0,0 +1,111 @@
+#include "InferenceScheduler.h"
+#include "InferenceWorker.h"
+
+InferenceScheduler::InferenceScheduler()
+    : Thread("CREPE inference")
+{
+    startThread(Priority::high);
+}
+
+InferenceScheduler::~InferenceScheduler()
+{
+    // Workers leave before the last reference to the scheduler goes; a batch in flight is
+    // allowed to finish
+    stopThread(5000);
+}
+
+void InferenceScheduler::addWorker(InferenceWorker* worker)
+{
+    const ScopedLock lock(workerLock);
+
+    workers.addIfNotAlreadyThere(worker);
+
+    // Room for every worker's frames in one batch, so gathering never allocates
+    size_t capacity = 0;
+    for (auto* registered : workers)
+        capacity += static_cast<size_t>(registered->maxPendingFrames);
+
+    frames.reserve(capacity);
+    predictions.reserve(capacity);
+    destinations.reserve(capacity);
+}
+
+void InferenceScheduler::removeWorker(InferenceWorker* worker)
+{
+    const ScopedLock lock(workerLock);
+    workers.removeFirstMatchingValue(worker);
+}
+
+void InferenceScheduler::run()
+{
+    while (!threadShouldExit())
+    {
+        bool tookInput = false;
+
+        {
+            const ScopedLock lock(workerLock);
+
+            for (auto* worker : workers)
+                tookInput = worker->collectFrames() || tookInput;
+
+            // One batch per model: instances that opened the same file share its session
+            // (ModelRegistry), so their frames go through the first one's loader together
+            for (int i = 0; i < workers.size(); ++i)
+            {
+                const void* const model = getModel(*workers.getUnchecked(i));
+                bool batched = false;
+
+                for (int j = 0; j < i && !batched; ++j)
+                    batched = getModel(*workers.getUnchecked(j)) == model;
+
+                if (!batched)
+                    runBatch(model, workers.getUnchecked(i)->loader);
+            }
+
+            for (auto* worker : workers)
+                worker->finishTick();
+        }
+
+        if (!tookInput)
+            wait(idleWaitMs);
+    }
+}
+
+const void* InferenceScheduler::getModel(const InferenceWorker& worker)
+{
+    // A loader without a model (or mid-load) batches alone and gets no results this tick
+    const void* const model = worker.loader.getCrepeModelIdentity();
+    return model != nullptr ? model : &worker.loader;
+}
+
+void InferenceScheduler::runBatch(const void* model, AIModelLoader& loader)
+{
+    frames.clear();
+    destinations.clear();
+
+    for (auto* worker : workers)
+    {
+        if (getModel(*worker) != model)
+            continue;
+
+        for (const auto& pending : worker->pendingFrames)
+        {
+            frames.push_back({ worker->pendingSamples.data() + pending.offset, worker->frameSpan,
+                               static_cast<float>(worker->sampleRate) });
+            destinations.push_back({ worker, pending.stream, pending.position });
+        }
+    }
+
+    if (frames.empty())
+        return;
+
+    predictions.resize(frames.size());
+
+    // Busy (re)loading, swapped to another model since the frames were grouped, or failed:
+    // these frames get no result, and the DSP pitch stands
+    if (!loader.predictPitchBatch(frames.data(), static_cast<int>(frames.size()), predictions.data(), model))
+        return;
+
+    for (size_t i = 0; i < destinations.size(); ++i)
+        destinations[i].worker->publish(destinations[i].stream, destinations[i].position, predictions[i]);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "JuceHeader.h"
+#include "AIModelLoader.h"
+#include <vector>
+
+class InferenceWorker;
+
+// One inference thread for the whole process, shared through SharedResourcePointer. Each tick
+// it takes the frames due from every registered InferenceWorker (every channel of every
+// plugin instance), runs them through each shared model as one batch (predictPitchBatch: [N, 1024]
+// per session call) and hands every prediction back to the worker and stream it came from.
+// Frames pile up while a batch runs, so the next batch is larger and the per-call overhead
+// is shared by more frames instead of more threads fighting over the cores.
+class InferenceScheduler : private Thread
+{
+public:
+    InferenceScheduler();
+    ~InferenceScheduler() override;
+
+    // Message thread. removeWorker returns once no batch in flight refers to the worker.
+    void addWorker(InferenceWorker* worker);
+    void removeWorker(InferenceWorker* worker);
+
+private:
+    void run() override;
+    void runBatch(const void* model, AIModelLoader& loader);
+
+    // What a worker's frames are batched by: the shared session, else its own loader
+    static const void* getModel(const InferenceWorker& worker);
+
+    CriticalSection workerLock;     // Held by the thread for a whole tick
+    Array<InferenceWorker*> workers;
+
+    // The batch being gathered: one frame per prediction, and where its result goes
+    struct Destination
+    {
+        InferenceWorker* worker;
+        int stream;
+        int64 position;
+    };
+
+    std::vector<AIModelLoader::PitchFrame> frames;
+    std::vector<AIModelLoader::PitchPrediction> predictions;
+    std::vector<Destination> destinations;
+
+    static constexpr int idleWaitMs = 2;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(InferenceScheduler)
+};
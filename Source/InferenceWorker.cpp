@@ -0,0 +1,349 @@
+#include "InferenceWorker.h"
+#include <algorithm>
+#include <cmath>
+
+InferenceWorker::InferenceWorker(AIModelLoader& modelLoader)
+    : loader(modelLoader)
+{
+}
+
+InferenceWorker::~InferenceWorker()
+{
+    release();
+}
+
+void InferenceWorker::prepare(double newSampleRate, int maxBlockSize)
+{
+    release();
+
+    sampleRate = newSampleRate;
+
+    const auto info = loader.getCrepeModelInfo();
+    frameSpan = static_cast<int>(std::ceil(info.inputSize * sampleRate / info.sampleRate));
+    blockSize = maxBlockSize;
+
+    // A quarter second of input in flight (more for huge blocks); results are read every
+    // block, so a few blocks' worth is plenty
+    const int numChunks = nextPowerOfTwo(jmax(static_cast<int>(0.25 * sampleRate), 4 * maxBlockSize) / chunkSize + 1);
+    const int numResults = nextPowerOfTwo(static_cast<int>(streams[0].recent.size()));
+    const int historySize = nextPowerOfTwo(frameSpan + chunkSize);
+
+    // Frames due per stream in one tick, with those too old to be read skipped; most at the
+    // shortest hop any tier uses
+    setHopSize(roundToInt(AIModelLoader::shortestHopSeconds * sampleRate));
+    maxPendingFrames = maxStreams * ((modelLatency + chunkSize) / hopSize + 2);
+    setHopSize(roundToInt(loader.getCrepeHopSeconds() * sampleRate));
+    maxModelLatency = getLatencyForHop(roundToInt(AIModelLoader::longestHopSeconds * sampleRate));
+
+    for (auto& stream : streams)
+    {
+        stream.chunks.assign(static_cast<size_t>(numChunks), AudioChunk());
+        stream.chunkFifo = std::make_unique<AbstractFifo>(numChunks);
+        stream.results.assign(static_cast<size_t>(numResults), PitchResult());
+        stream.resultFifo = std::make_unique<AbstractFifo>(numResults);
+
+        stream.history.assign(static_cast<size_t>(historySize), 0.0f);
+        stream.historyMask = historySize - 1;
+        stream.historyEnd = -1;
+        stream.historyFilled = 0;
+        stream.consumedEnd = -1;
+        stream.recentCount = 0;
+    }
+
+    pendingSamples.assign(static_cast<size_t>(maxPendingFrames * frameSpan), 0.0f);
+    pendingFrames.clear();
+    pendingFrames.reserve(static_cast<size_t>(maxPendingFrames));
+    fallbackSamples = 0;
+    droppedChunks = 0;
+
+    scheduler->addWorker(this);
+    registered = true;
+}
+
+void InferenceWorker::release()
+{
+    // A batch already running is allowed to finish
+    if (registered)
+        scheduler->removeWorker(this);
+
+    registered = false;
+}
+
+void InferenceWorker::pushAudio(int stream, const float* samples, int numSamples, int64 position)
+{
+    auto& target = streams[static_cast<size_t>(stream)];
+
+    if (target.chunkFifo == nullptr)
+        return;
+
+    for (int done = 0; done < numSamples; done += chunkSize)
+    {
+        int start1, size1, start2, size2;
+        target.chunkFifo->prepareToWrite(1, start1, size1, start2, size2);
+
+        // A full ring means the worker is far behind: the chunk is lost and the gap in
+        // positions restarts the stream's history
+        if (size1 == 0)
+        {
+            ++droppedChunks;
+            continue;
+        }
+
+        auto& chunk = target.chunks[static_cast<size_t>(start1)];
+        chunk.position = position + done;
+        chunk.numSamples = jmin(chunkSize, numSamples - done);
+        std::copy(samples + done, samples + done + chunk.numSamples, chunk.samples.begin());
+
+        target.chunkFifo->finishedWrite(1);
+    }
+}
+
+bool InferenceWorker::collectFrames()
+{
+    modelActive = loader.isCrepeModelLoaded();
+
+    // A new quality tier's hop starts with the next frame due
+    const int tierHopSize = roundToInt(loader.getCrepeHopSeconds() * sampleRate);
+
+    if (tierHopSize != hopSize)
+        setHopSize(tierHopSize);
+
+    pendingFrames.clear();
+    tookInput = false;
+
+    for (int index = 0; index < maxStreams; ++index)
+        tookInput = serviceStream(index) || tookInput;
+
+    return tookInput;
+}
+
+bool InferenceWorker::serviceStream(int index)
+{
+    auto& stream = streams[static_cast<size_t>(index)];
+    const int ready = stream.chunkFifo->getNumReady();
+
+    if (ready == 0)
+        return false;
+
+    int start1, size1, start2, size2;
+    stream.chunkFifo->prepareToRead(ready, start1, size1, start2, size2);
+
+    // Results for frames this far behind the newest input would arrive too late to be read,
+    // so after a stall only the history takes them in
+    const auto& newest = stream.chunks[static_cast<size_t>(size2 > 0 ? start2 + size2 - 1 : start1 + size1 - 1)];
+    const int64 newestEnd = newest.position + newest.numSamples;
+    const int hop = hopSize;
+    const int latency = modelLatency;
+
+    auto consume = [&] (int start, int size)
+    {
+        for (int i = start; i < start + size; ++i)
+        {
+            const auto& chunk = stream.chunks[static_cast<size_t>(i)];
+            const int64 firstFrameEnd = (chunk.position / hop + 1) * hop;
+
+            appendToHistory(stream, chunk);
+
+            if (!modelActive)
+                continue;
+
+            // Frames end on the hop grid of the sample clock, so every stream is analysed alike
+            for (int64 frameEnd = firstFrameEnd; frameEnd <= stream.historyEnd; frameEnd += hop)
+            {
+                if (newestEnd - frameEnd < latency)
+                    queueFrameEndingAt(index, frameEnd);
+            }
+        }
+    };
+
+    consume(start1, size1);
+    consume(start2, size2);
+    stream.chunkFifo->finishedRead(size1 + size2);
+
+    return true;
+}
+
+void InferenceWorker::appendToHistory(Stream& stream, const AudioChunk& chunk)
+{
+    // Input that does not follow on from the history starts it over
+    if (chunk.position != stream.historyEnd)
+        stream.historyFilled = 0;
+
+    for (int i = 0; i < chunk.numSamples; ++i)
+        stream.history[static_cast<size_t>((chunk.position + i) & stream.historyMask)] = chunk.samples[static_cast<size_t>(i)];
+
+    stream.historyEnd = chunk.position + chunk.numSamples;
+    stream.historyFilled = jmin(stream.historyMask + 1, stream.historyFilled + chunk.numSamples);
+}
+
+void InferenceWorker::queueFrameEndingAt(int index, int64 frameEnd)
+{
+    const auto& stream = streams[static_cast<size_t>(index)];
+
+    // Only whole frames: right after a restart the DSP pitch covers for the model
+    if (stream.historyFilled - (stream.historyEnd - frameEnd) < frameSpan
+        || static_cast<int>(pendingFrames.size()) == maxPendingFrames)
+        return;
+
+    const int offset = static_cast<int>(pendingFrames.size()) * frameSpan;
+    float* const frame = pendingSamples.data() + offset;
+
+    for (int i = 0; i < frameSpan; ++i)
+        frame[i] = stream.history[static_cast<size_t>((frameEnd - frameSpan + i) & stream.historyMask)];
+
+    pendingFrames.push_back({ index, frameEnd - frameSpan / 2, offset });
+}
+
+void InferenceWorker::setHopSize(int newHopSize)
+{
+    hopSize = newHopSize;
+    modelLatency = getLatencyForHop(newHopSize);
+}
+
+int InferenceWorker::getLatencyForHop(int hop) const
+{
+    return frameSpan / 2 + hop + blockSize + roundToInt(inferenceBudgetSeconds * sampleRate);
+}
+
+void InferenceWorker::publish(int stream, int64 position, const AIModelLoader::PitchPrediction& prediction)
+{
+    auto& target = streams[static_cast<size_t>(stream)];
+
+    int start1, size1, start2, size2;
+    target.resultFifo->prepareToWrite(1, start1, size1, start2, size2);
+
+    // Full only while the audio thread is in another mode and not reading
+    if (size1 == 0)
+        return;
+
+    auto& result = target.results[static_cast<size_t>(start1)];
+    result.position = position;
+    result.frequency = prediction.frequency;
+    result.confidence = prediction.confidence;
+
+    target.resultFifo->finishedWrite(1);
+}
+
+void InferenceWorker::finishTick()
+{
+    if (!tookInput)
+        return;
+
+    for (auto& stream : streams)
+        stream.consumedEnd = stream.historyEnd;
+
+    streamsServiced.signal();
+}
+
+void InferenceWorker::drainResults(Stream& stream)
+{
+    const int ready = stream.resultFifo->getNumReady();
+
+    if (ready == 0)
+        return;
+
+    int start1, size1, start2, size2;
+    stream.resultFifo->prepareToRead(ready, start1, size1, start2, size2);
+
+    auto keep = [&stream] (const PitchResult& result)
+    {
+        if (stream.recentCount == static_cast<int>(stream.recent.size()))
+        {
+            std::move(stream.recent.begin() + 1, stream.recent.end(), stream.recent.begin());
+            --stream.recentCount;
+        }
+
+        stream.recent[static_cast<size_t>(stream.recentCount++)] = result;
+    };
+
+    for (int i = start1; i < start1 + size1; ++i)
+        keep(stream.results[static_cast<size_t>(i)]);
+
+    for (int i = start2; i < start2 + size2; ++i)
+        keep(stream.results[static_cast<size_t>(i)]);
+
+    stream.resultFifo->finishedRead(size1 + size2);
+}
+
+float InferenceWorker::getPitchAt(const Stream& stream, int& index, int64 when) const
+{
+    // index walks forward to the last result at or before when; callers ask in time order
+    while (index + 1 < stream.recentCount && stream.recent[static_cast<size_t>(index + 1)].position <= when)
+        ++index;
+
+    if (stream.recentCount == 0 || stream.recent[static_cast<size_t>(index)].position > when)
+        return -1.0f;
+
+    const auto& before = stream.recent[static_cast<size_t>(index)];
+
+    if (before.position == when)
+        return before.confidence >= voicingThreshold ? before.frequency : 0.0f;
+
+    // Nothing after it yet: inference is running late for this sample
+    if (index + 1 >= stream.recentCount)
+        return -1.0f;
+
+    const auto& after = stream.recent[static_cast<size_t>(index + 1)];
+    const int64 span = after.position - before.position;
+
+    if (span > maxResultGapHops * hopSize.load())
+        return -1.0f;
+
+    const bool beforeVoiced = before.confidence >= voicingThreshold;
+    const bool afterVoiced = after.confidence >= voicingThreshold;
+
+    if (beforeVoiced && afterVoiced)
+        return before.frequency + (after.frequency - before.frequency) * static_cast<float>(when - before.position) / static_cast<float>(span);
+
+    // Across a voicing change the nearer result decides
+    const auto& nearer = 2 * (when - before.position) < span ? before : after;
+    return nearer.confidence >= voicingThreshold ? nearer.frequency : 0.0f;
+}
+
+int InferenceWorker::readPitchCurve(int stream, float* pitchCurve, int numSamples, int64 position,
+                                    int lagSamples, bool waitForResults)
+{
+    auto& source = streams[static_cast<size_t>(stream)];
+
+    if (source.resultFifo == nullptr)
+        return 0;
+
+    drainResults(source);
+
+    if (!modelActive)
+        return 0;
+
+    // Offline there is no deadline: let the worker take in everything pushed so far, so a
+    // bounce never depends on how fast inference happened to run
+    if (waitForResults)
+    {
+        while (source.consumedEnd < position + numSamples)
+        {
+            if (!streamsServiced.wait(offlineWaitMs))
+                break;
+        }
+
+        drainResults(source);
+    }
+
+    const int64 lag = jmax(lagSamples, modelLatency.load());
+    int covered = 0;
+    int index = 0;
+
+    for (int start = 0; start < numSamples; start += interpolationStep)
+    {
+        const int length = jmin(interpolationStep, numSamples - start);
+        const float pitch = getPitchAt(source, index, position + start - lag);
+
+        if (pitch < 0.0f)
+        {
+            fallbackSamples += length;
+            continue;
+        }
+
+        FloatVectorOperations::fill(pitchCurve + start, pitch, length);
+        covered += length;
+    }
+
+    return covered;
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "JuceHeader.h"
+#include "AIModelLoader.h"
+#include "InferenceScheduler.h"
+#include <array>
+#include <atomic>
+#include <vector>
+
+// Keeps CREPE off the audio thread. The audio thread hands each analysis stream's input over
+// in timestamped chunks through a lock-free single-producer/single-consumer ring; on the
+// process-wide InferenceScheduler thread the worker keeps a frame of history per stream and
+// queues a frame every hop (10 to 40ms, by the loader's quality tier) for the scheduler's
+// next batch, whose timestamped pitch
+// results come back through a second ring. The audio thread reads the model's pitch a fixed
+// lag behind, interpolated between results; wherever no result covers a sample in time it
+// keeps the DSP detector's pitch instead.
+class InferenceWorker
+{
+public:
+    explicit InferenceWorker(AIModelLoader& modelLoader);
+    ~InferenceWorker();
+
+    static constexpr int maxStreams = 2;
+
+    // Sizes the rings and joins the scheduler; call from prepare, not the audio thread
+    void prepare(double sampleRate, int maxBlockSize);
+    void release();
+
+    // Audio thread. position is the sample clock at numSamples' first sample; a jump in it
+    // restarts the stream's history. Chunks that do not fit in the ring are dropped.
+    void pushAudio(int stream, const float* samples, int numSamples, int64 position);
+
+    // Audio thread. Overwrites pitchCurve (Hz, 0 when unvoiced) wherever model results cover
+    // the block read lagSamples behind (never less than getLatencySamples()). Offline renders
+    // wait for the worker to get there first. Returns the number of samples overwritten.
+    int readPitchCurve(int stream, float* pitchCurve, int numSamples, int64 position,
+                       int lagSamples, bool waitForResults);
+
+    // How far behind the input the model's pitch is read at the least: half a model frame,
+    // a hop to interpolate over, one host block and the time inference is given. Follows the
+    // quality tier's hop.
+    int getLatencySamples() const { return modelLatency.load(); }
+
+    // The latency at the longest hop of any tier: reading at least this far behind keeps
+    // every tier's results in time, so a caller can hold one lag across quality changes
+    int getMaxLatencySamples() const { return maxModelLatency; }
+
+    // Samples that kept the DSP pitch because no model result was there in time, and input
+    // chunks lost to a full ring (audio-thread counters)
+    int64 getFallbackSampleCount() const { return fallbackSamples; }
+    int64 getDroppedChunkCount() const { return droppedChunks; }
+
+private:
+    static constexpr int chunkSize = 256;
+
+    struct AudioChunk
+    {
+        int64 position = 0;
+        int numSamples = 0;
+        std::array<float, chunkSize> samples {};
+    };
+
+    struct PitchResult
+    {
+        int64 position = 0;     // Centre of the analysed frame, on the input's sample clock
+        float frequency = 0.0f;
+        float confidence = 0.0f;
+    };
+
+    struct Stream
+    {
+        // Audio thread -> worker
+        std::unique_ptr<AbstractFifo> chunkFifo;
+        std::vector<AudioChunk> chunks;
+
+        // Worker -> audio thread
+        std::unique_ptr<AbstractFifo> resultFifo;
+        std::vector<PitchResult> results;
+
+        // Worker only: input history ring and the position after its newest sample
+        std::vector<float> history;
+        int historyMask = 0;
+        int64 historyEnd = -1;
+        int historyFilled = 0;
+
+        // Input the worker has taken in, whether or not it ran the model on it
+        std::atomic<int64> consumedEnd { -1 };
+
+        // Audio thread only: the newest results, oldest first
+        std::array<PitchResult, 64> recent {};
+        int recentCount = 0;
+    };
+
+    // Frames taken from a stream's history for the scheduler's next batch
+    struct PendingFrame
+    {
+        int stream;
+        int64 position;         // Frame centre
+        int offset;             // Into pendingSamples
+    };
+
+    // Scheduler thread, under its lock: take in queued input and queue the frames due, then
+    // (after the batch) publish each prediction and let offline readers know
+    friend class InferenceScheduler;
+    bool collectFrames();
+    void publish(int stream, int64 position, const AIModelLoader::PitchPrediction& prediction);
+    void finishTick();
+
+    bool serviceStream(int index);
+    void appendToHistory(Stream& stream, const AudioChunk& chunk);
+    void queueFrameEndingAt(int index, int64 frameEnd);
+    void setHopSize(int newHopSize);
+    int getLatencyForHop(int hop) const;
+    void drainResults(Stream& stream);
+    float getPitchAt(const Stream& stream, int& index, int64 when) const;
+
+    AIModelLoader& loader;
+    SharedResourcePointer<InferenceScheduler> scheduler;
+    bool registered = false;
+    std::array<Stream, maxStreams> streams;
+
+    std::vector<float> pendingSamples;
+    std::vector<PendingFrame> pendingFrames;
+    int maxPendingFrames = 0;
+    bool tookInput = false;
+
+    double sampleRate = 44100.0;
+    int frameSpan = 0;          // Input samples in one model frame
+    int blockSize = 0;
+
+    // Set by the scheduler thread when the quality tier changes, read on the audio thread
+    std::atomic<int> hopSize { 0 };
+    std::atomic<int> modelLatency { 0 };
+    int maxModelLatency = 0;
+
+    std::atomic<bool> modelActive { false };
+    WaitableEvent streamsServiced;  // Signalled after each pass that took in input
+
+    int64 fallbackSamples = 0;
+    int64 droppedChunks = 0;
+
+    // The time a frame's inference is given beyond its own hop
+    static constexpr double inferenceBudgetSeconds = 0.01;
+
+    // Results further apart than this (the worker skipped frames) are not interpolated across
+    static constexpr int maxResultGapHops = 2;
+
+    // Below this the model calls the frame unvoiced
+    static constexpr float voicingThreshold = 0.3f;
+
+    // The interpolated pitch moves in steps this long, so the scale lookup downstream does
+    // not run on every sample
+    static constexpr int interpolationStep = 32;
+
+    static constexpr int offlineWaitMs = 1000;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(InferenceWorker)
+};
@@ -0,0 +1,40 @@
+#include "LookaheadDelay.h"
+
+void LookaheadDelay::prepare(int maxDelaySamples)
+{
+    const int capacity = nextPowerOfTwo(jmax(1, maxDelaySamples) + 1);
+    ring.assign(static_cast<size_t>(capacity), 0.0f);
+    mask = capacity - 1;
+    delay = jlimit(0, mask, delay);
+    reset();
+}
+
+void LookaheadDelay::reset()
+{
+    std::fill(ring.begin(), ring.end(), 0.0f);
+    writePos = 0;
+}
+
+void LookaheadDelay::setDelay(int newDelaySamples)
+{
+    delay = jlimit(0, mask, newDelaySamples);
+}
+
+void LookaheadDelay::process(const float* input, float* output, int numSamples)
+{
+    if (ring.empty())
+    {
+        if (output != input)
+            std::copy(input, input + numSamples, output);
+        return;
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        // Written before reading, so a delay of 0 passes straight through (and the ring
+        // stays current for a later, longer delay)
+        ring[static_cast<size_t>(writePos)] = input[i];
+        output[i] = ring[static_cast<size_t>((writePos - delay) & mask)];
+        writePos = (writePos + 1) & mask;
+    }
+}
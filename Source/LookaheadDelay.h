@@ -0,0 +1,32 @@
+#pragma once
+
+#include "JuceHeader.h"
+#include "CacheAlignedVector.h"
+#include <vector>
+
+// Whole-sample delay line with a preallocated ring, for holding audio (or a control curve)
+// back while analysis runs ahead of it. The delay can change between blocks without
+// allocating; the samples already in the ring are kept, so a change skips or repeats some.
+class LookaheadDelay
+{
+public:
+    LookaheadDelay() = default;
+
+    // Sizes the ring for delays up to maxDelaySamples; call from prepare, not the audio thread
+    void prepare(int maxDelaySamples);
+    void reset();
+
+    void setDelay(int newDelaySamples);
+    int getDelay() const { return delay; }
+
+    // input and output may be the same buffer
+    void process(const float* input, float* output, int numSamples);
+
+private:
+    CacheAlignedVector<float> ring;
+    int mask = 0;
+    int writePos = 0;
+    int delay = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LookaheadDelay)
+};
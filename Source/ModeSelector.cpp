@@ -76,7 +76,7 @@ ModeSelector::PitchAlgorithm ModeSelector::getPitchAlgorithm(Parameters::Mode mo
         case Parameters::Mode::Hard:
             return PitchAlgorithm::YIN;
         case Parameters::Mode::AI:
-            return PitchAlgorithm::Combined;
+            return PitchAlgorithm::ProbabilisticYIN; // One tracked detector instead of the Combined ensemble
         default:
             return PitchAlgorithm::Autocorrelation;
     }
@@ -92,6 +92,30 @@ void ModeSelector::setQualityLevel(QualityLevel level)
     currentQuality = level;
 }
 
+ModeSelector::ShifterEngine ModeSelector::getShifterEngine() const
+{
+    return getShifterEngine(currentQuality);
+}
+
+ModeSelector::ShifterEngine ModeSelector::getShifterEngine(QualityLevel level) const
+{
+    switch (level)
+    {
+        case QualityLevel::Draft:
+            return ShifterEngine::PSOLA;
+#ifdef USE_RUBBERBAND
+        case QualityLevel::Good:
+            return ShifterEngine::RubberBandR2;
+        case QualityLevel::High:
+            return ShifterEngine::RubberBandR3Short;
+        case QualityLevel::Ultra:
+            return ShifterEngine::RubberBandR3;
+#endif
+        default:
+            return ShifterEngine::PhaseVocoder;
+    }
+}
+
 void ModeSelector::switchToMode(Parameters::Mode newMode)
 {
     if (!validateModeSwitch(newMode))
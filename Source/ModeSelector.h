@@ -69,7 +69,9 @@ public:
         YIN,
         Spectral,
         Harmonic,
-        Combined
+        Combined,
+        MPM,              // McLeod Pitch Method (NSDF via FFT)
+        ProbabilisticYIN  // pYIN candidates with online Viterbi tracking
     };
     
     PitchAlgorithm getPitchAlgorithm() const;
@@ -87,6 +89,27 @@ public:
     QualityLevel getQualityLevel() const;
     void setQualityLevel(QualityLevel level);
     
+    // Shifter behind each quality level in AI mode. Cost per channel at 44.1kHz from
+    // `AutoTuneBenchmarks shifters` (a sawtooth voice holding notes for 300ms with 50ms
+    // retunes; x86-64 Xeon, -O3, bundled Rubber Band with its built-in FFT):
+    //   Draft  PSOLA                    0.027 us/sample
+    //   Good   Rubber Band R2           1.28 us/sample
+    //   High   Rubber Band R3, short    1.02 us/sample
+    //   Ultra  Rubber Band R3           2.59 us/sample
+    // R2 measured no cheaper than R3 short on the built-in FFT. Without Rubber Band, Good
+    // and above use the phase vocoder (0.73 us/sample).
+    enum class ShifterEngine
+    {
+        PSOLA,
+        RubberBandR2,
+        RubberBandR3Short,
+        RubberBandR3,
+        PhaseVocoder
+    };
+    
+    ShifterEngine getShifterEngine() const;
+    ShifterEngine getShifterEngine(QualityLevel level) const;
+    
     // Mode switching
     void switchToMode(Parameters::Mode newMode);
     bool canSwitchToMode(Parameters::Mode mode) const;
@@ -0,0 +1,133 @@
+#include "ModelRegistry.h"
+
+#if ONNX_RUNTIME_SESSIONS
+
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+ModelRegistry::ModelRegistry()
+{
+    // No ORT worker threads and no spinning: each Run() computes on the thread that calls it
+    Ort::ThreadingOptions threading;
+    threading.SetGlobalIntraOpNumThreads(1);
+    threading.SetGlobalInterOpNumThreads(1);
+    threading.SetGlobalSpinControl(0);
+
+    environment = Ort::Env(threading, ORT_LOGGING_LEVEL_WARNING, "AutoTune");
+}
+
+ModelRegistry::~ModelRegistry() = default;
+
+std::shared_ptr<ModelRegistry::Model> ModelRegistry::acquire(const File& modelFile)
+{
+    const ScopedLock scopedLock(lock);
+
+    removeExpired();
+
+    const String fileKey = modelFile.getFullPathName() + "|" + String(modelFile.getSize())
+                         + "|" + String(modelFile.getLastModificationTime().toMilliseconds());
+
+    // A file seen before needs neither reading nor hashing
+    const auto known = contentKeys.find(fileKey);
+
+    if (known != contentKeys.end())
+    {
+        const auto open = models.find(known->second);
+
+        if (open != models.end())
+        {
+            if (auto model = open->second.lock())
+                return model;
+        }
+    }
+
+    auto mapped = std::make_unique<MemoryMappedFile>(modelFile, MemoryMappedFile::readOnly);
+
+    if (mapped->getData() == nullptr || mapped->getSize() == 0)
+        throw std::runtime_error("cannot map " + modelFile.getFullPathName().toStdString());
+
+    const String key = hashContents(*mapped);
+    contentKeys[fileKey] = key;
+
+    // The same contents under another path
+    const auto open = models.find(key);
+
+    if (open != models.end())
+    {
+        if (auto model = open->second.lock())
+            return model;
+    }
+
+    auto model = std::make_shared<Model>();
+    model->key = key;
+    model->file = modelFile;
+    model->sizeInBytes = static_cast<int64>(mapped->getSize());
+
+    Ort::SessionOptions options;
+    options.DisablePerSessionThreads();
+    options.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+    options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+
+    const bool ortFormat = modelFile.hasFileExtension("ort");
+
+    if (ortFormat)
+    {
+        options.AddConfigEntry("session.use_ort_model_bytes_directly", "1");
+        options.AddConfigEntry("session.use_ort_model_bytes_for_initializers", "1");
+    }
+
+    model->session = Ort::Session(environment, mapped->getData(), mapped->getSize(), options);
+
+    if (ortFormat)
+        model->mappedFile = std::move(mapped);
+
+    models[key] = model;
+    return model;
+}
+
+int ModelRegistry::getNumOpenModels() const
+{
+    const ScopedLock scopedLock(lock);
+
+    int open = 0;
+    for (const auto& entry : models)
+        open += entry.second.expired() ? 0 : 1;
+
+    return open;
+}
+
+void ModelRegistry::removeExpired()
+{
+    // Models whose last user let go, and every file that led to one: variant swaps would
+    // otherwise leave an entry behind for each file ever opened
+    for (auto entry = models.begin(); entry != models.end();)
+        entry = entry->second.expired() ? models.erase(entry) : std::next(entry);
+
+    for (auto entry = contentKeys.begin(); entry != contentKeys.end();)
+        entry = models.count(entry->second) == 0 ? contentKeys.erase(entry) : std::next(entry);
+}
+
+String ModelRegistry::hashContents(const MemoryMappedFile& mapped)
+{
+    // 64-bit FNV-1a over whole words, then the tail bytes; the size goes into the key too
+    const auto* bytes = static_cast<const uint8*>(mapped.getData());
+    const size_t size = mapped.getSize();
+    constexpr uint64 prime = 0x100000001b3ULL;
+    uint64 hash = 0xcbf29ce484222325ULL;
+    size_t position = 0;
+
+    for (; position + sizeof(uint64) <= size; position += sizeof(uint64))
+    {
+        uint64 word;
+        std::memcpy(&word, bytes + position, sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+
+    for (; position < size; ++position)
+        hash = (hash ^ bytes[position]) * prime;
+
+    return String::toHexString(static_cast<int64>(hash)) + "-" + String(static_cast<int64>(size));
+}
+
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "JuceHeader.h"
+#include "AIModelLoader.h"
+
+#if ONNX_RUNTIME_SESSIONS
+
+#include <atomic>
+#include <map>
+#include <memory>
+
+// Process-wide store of ONNX Runtime sessions, shared through SharedResourcePointer. Every
+// plugin instance that loads the same model file gets the same session, so memory stays flat
+// as instances are added and later loads return at once. Models are keyed by a hash of their
+// contents (a file is hashed once per path, size and modification time) and freed when the
+// last instance lets go. All sessions run on one ORT environment whose global thread pool
+// is the calling thread only: inference threads belong to InferenceScheduler, not to ORT.
+class ModelRegistry
+{
+public:
+    ModelRegistry();
+    ~ModelRegistry();
+
+    // A loaded model. The session is immutable once created and may be Run() from several
+    // threads at once; tensors and bindings belong to each caller.
+    struct Model
+    {
+        String key;
+        File file;
+        int64 sizeInBytes = 0;
+
+        // ORT-format models run straight from the mapped file (their weights are never
+        // copied), so it is declared before the session and unmapped after it; ONNX protobufs
+        // are parsed into ORT's own tensors and unmapped at load
+        std::unique_ptr<MemoryMappedFile> mappedFile;
+        Ort::Session session { nullptr };
+        std::atomic<double> frameMilliseconds { 0.0 };    // One frame's Run(), timed at first load
+    };
+
+    // The open model with modelFile's contents, loading it on first use. Throws
+    // (std::runtime_error or Ort::Exception) when the file cannot be read or ORT rejects it.
+    std::shared_ptr<Model> acquire(const File& modelFile);
+
+    int getNumOpenModels() const;
+
+private:
+    static String hashContents(const MemoryMappedFile& mapped);
+    void removeExpired();
+
+    CriticalSection lock;
+    Ort::Env environment { nullptr };
+    std::map<String, std::weak_ptr<Model>> models;     // By content key
+    std::map<String, String> contentKeys;              // Path, size and time -> content key
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ModelRegistry)
+};
+
+#endif
@@ -6,6 +6,10 @@ const String Parameters::AMOUNT_ID = "amount";
 const String Parameters::MODE_ID = "mode";
 const String Parameters::KEY_ID = "key";
 const String Parameters::SCALE_ID = "scale";
+const String Parameters::STEREO_LINK_ID = "stereoLink";
+const String Parameters::QUALITY_ID = "quality";
+const String Parameters::LOOKAHEAD_ID = "lookahead";
+const String Parameters::FORMANT_ID = "formant";
 
 Parameters::Parameters()
 {
@@ -89,6 +93,49 @@ AudioProcessorValueTreeState::ParameterLayout Parameters::createParameterLayout(
         SCALE_DEFAULT
     ));
 
+    // Stereo link parameter - One pitch analysis drives both channels of a stereo input
+    params.push_back(std::make_unique<AudioParameterBool>(
+        STEREO_LINK_ID,
+        "Stereo Link",
+        STEREO_LINK_DEFAULT
+    ));
+
+    // Quality parameter - Picks the AI mode shifter and CREPE tier, trading CPU for quality
+    StringArray qualityChoices;
+    qualityChoices.add("Draft");
+    qualityChoices.add("Good");
+    qualityChoices.add("High");
+    qualityChoices.add("Ultra");
+
+    params.push_back(std::make_unique<AudioParameterChoice>(
+        QUALITY_ID,
+        "Quality",
+        qualityChoices,
+        QUALITY_DEFAULT
+    ));
+
+    // Lookahead parameter - Delays the audio so correction starts right at each note
+    params.push_back(std::make_unique<AudioParameterFloat>(
+        LOOKAHEAD_ID,
+        "Lookahead",
+        NormalisableRange<float>(LOOKAHEAD_MIN, LOOKAHEAD_MAX, LOOKAHEAD_STEP),
+        LOOKAHEAD_DEFAULT,
+        String(),
+        AudioProcessorParameter::genericParameter,
+        [](float value, int) { return String(value, 1) + " ms"; }
+    ));
+
+    // Formant parameter - Moves the vocal formants in AI mode (0 keeps them where they are)
+    params.push_back(std::make_unique<AudioParameterFloat>(
+        FORMANT_ID,
+        "Formant",
+        NormalisableRange<float>(FORMANT_MIN, FORMANT_MAX, FORMANT_STEP),
+        FORMANT_DEFAULT,
+        String(),
+        AudioProcessorParameter::genericParameter,
+        [](float value, int) { return String(value, 1) + " st"; }
+    ));
+
     return { params.begin(), params.end() };
 }
 
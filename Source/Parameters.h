@@ -11,6 +11,10 @@ public:
     static const String MODE_ID;
     static const String KEY_ID;
     static const String SCALE_ID;
+    static const String STEREO_LINK_ID;
+    static const String QUALITY_ID;
+    static const String LOOKAHEAD_ID;
+    static const String FORMANT_ID;
 
     // Enums for categorical parameters
     enum class Mode
@@ -51,9 +55,21 @@ public:
     static constexpr float AMOUNT_DEFAULT = 50.0f;
     static constexpr float AMOUNT_STEP = 0.1f;
 
+    static constexpr float LOOKAHEAD_MIN = 0.0f;   // Milliseconds
+    static constexpr float LOOKAHEAD_MAX = 50.0f;
+    static constexpr float LOOKAHEAD_DEFAULT = 0.0f;
+    static constexpr float LOOKAHEAD_STEP = 0.1f;
+
+    static constexpr float FORMANT_MIN = -12.0f;   // Semitones
+    static constexpr float FORMANT_MAX = 12.0f;
+    static constexpr float FORMANT_DEFAULT = 0.0f;
+    static constexpr float FORMANT_STEP = 0.1f;
+
     static constexpr int MODE_DEFAULT = static_cast<int>(Mode::Classic);
     static constexpr int KEY_DEFAULT = static_cast<int>(Key::C);
     static constexpr int SCALE_DEFAULT = static_cast<int>(Scale::Major);
+    static constexpr bool STEREO_LINK_DEFAULT = true;
+    static constexpr int QUALITY_DEFAULT = 2; // High (ModeSelector::QualityLevel)
 
     // Utility functions
     static String getModeString(Mode mode);
@@ -1,23 +1,31 @@
 #include "PitchCorrectionEngine.h" 
 #include "Utils.h"
+#include "DSPKernels.h"
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <vector>
 
-// Include real Rubber Band library for professional pitch shifting
-#ifdef USE_RUBBERBAND
-#include "rubberband/RubberBandStretcher.h"
-#endif
-
 PitchCorrectionEngine::PitchCorrectionEngine()
 {
     // Initialize FFT
     fft = std::make_unique<dsp::FFT>(fftOrder);
+    decimatedFFT = std::make_unique<dsp::FFT>(decimatedFFTOrder);
     window = std::make_unique<dsp::WindowingFunction<float>>(fftSize, dsp::WindowingFunction<float>::hann);
     
-    // Allocate frequency domain buffer
+    // Allocate frequency domain buffer and FFT scratch (the FFT is not run in-place)
     frequencyData.allocate(fftSize, true);
-    magnitudeSpectrum.resize(fftSize / 2);
+    fftWorkspace.allocate(fftSize, true);
+    analysisFrame.bins.resize(fftSize / 2 + 1);
+    analysisFrame.magnitude.resize(fftSize / 2);
+    analysisFrame.logMagnitude.resize(fftSize / 2);
+    analysisFrame.logEnvelope.resize(envelopeSize);
+    envelopeWorkspace.allocate(envelopeFFTSize, true);
+    envelopeCepstrum.allocate(envelopeFFTSize, true);
+    spectralLogEnvelope.resize(envelopeSize);
+    hpsBuffer.resize(fftSize / 2);
+    for (auto& table : hannWindowTables)
+        table.resize(fftSize);
     
     // Initialize pitch history
     pitchHistory.resize(pitchHistoryLength, 0.0f);
@@ -25,9 +33,76 @@ PitchCorrectionEngine::PitchCorrectionEngine()
     // Initialize formant arrays
     formantFrequencies.resize(maxFormants, 0.0f);
     formantAmplitudes.resize(maxFormants, 0.0f);
+    formantPeakCandidates.reserve(fftSize / 4);
+    
+    // Hann table for PSOLA grains, read at whatever length a grain needs
+    psolaWindow.resize(psolaWindowResolution + 1);
+    for (int i = 0; i <= psolaWindowResolution; ++i)
+    {
+        psolaWindow[static_cast<size_t>(i)] = 0.5f * (1.0f - std::cos(2.0f * MathConstants<float>::pi * i / psolaWindowResolution));
+    }
+    
+    interpolator.prepare(interpolatorTaps, interpolatorPhases);
+    
+    // Phase vocoder frames have a fixed size, so their state does not depend on the sample rate
+    const int numSpectralBins = fftSize / 2 + 1;
+    spectralInput.resize(static_cast<size_t>(analysisWindowSize) * 2);
+    spectralOutput.resize(spectralOutputSize);
+    spectralBins.resize(numSpectralBins);
+    previousSpectralBins.resize(numSpectralBins);
+    spectralMagnitude.resize(numSpectralBins);
+    previousSpectralMagnitude.resize(numSpectralBins);
+    spectralRotation.resize(numSpectralBins);
+    nextSpectralRotation.resize(numSpectralBins);
+    spectralPeaks.reserve(numSpectralBins / 2);
+    
+    // Hann analysis and synthesis windows overlap-add to a constant once divided by the
+    // summed squared windows at each position of the hop
+    spectralSynthesisWindow.resize(analysisWindowSize);
+    for (int i = 0; i < analysisWindowSize; ++i)
+    {
+        float overlapSum = 0.0f;
+        for (int j = i % spectralShiftHop; j < analysisWindowSize; j += spectralShiftHop)
+        {
+            const float w = 0.5f * (1.0f - std::cos(2.0f * MathConstants<float>::pi * j / (analysisWindowSize - 1)));
+            overlapSum += w * w;
+        }
+        
+        const float w = 0.5f * (1.0f - std::cos(2.0f * MathConstants<float>::pi * i / (analysisWindowSize - 1)));
+        spectralSynthesisWindow[static_cast<size_t>(i)] = overlapSum > 0.0f ? w / overlapSum : 0.0f;
+    }
+    
+    // MPM and probabilistic YIN state
+    nsdfBuffer.resize(fftSize / 2 + 2);
+    pyinTracker.voicedScore.resize(pyinNumBins);
+    pyinTracker.unvoicedScore.resize(pyinNumBins);
+    pyinTracker.nextVoicedScore.resize(pyinNumBins);
+    pyinTracker.nextUnvoicedScore.resize(pyinNumBins);
+    pyinTracker.observation.resize(pyinNumBins, 0.0f);
+    pyinTracker.transition.resize(pyinMaxJump * 2 + 1);
+    
+    float transitionSum = 0.0f;
+    for (int jump = -pyinMaxJump; jump <= pyinMaxJump; ++jump)
+    {
+        float weight = static_cast<float>(pyinMaxJump + 1 - std::abs(jump));
+        pyinTracker.transition[jump + pyinMaxJump] = weight;
+        transitionSum += weight;
+    }
+    for (auto& weight : pyinTracker.transition)
+        weight /= transitionSum;
+    
+    // Beta(2, 18) prior over the thresholds 0.01..1.00 (mean 0.1, the classic YIN threshold)
+    float priorSum = 0.0f;
+    for (int i = 1; i <= 100; ++i)
+    {
+        float threshold = i * 0.01f;
+        priorSum += threshold * std::pow(1.0f - threshold, 17.0f);
+        pyinThresholdCDF[i] = priorSum;
+    }
+    for (auto& probability : pyinThresholdCDF)
+        probability /= priorSum;
     
-    // Initialize grain buffer
-    grainBuffer.reserve(32); // Reserve space for grains
+    resetPitchTracker();
 }
 
 PitchCorrectionEngine::~PitchCorrectionEngine()
@@ -40,14 +115,109 @@ void PitchCorrectionEngine::prepare(double newSampleRate, int newBlockSize)
     blockSize = newBlockSize;
     
     // Resize buffers
-    autocorrelationBuffer.resize(static_cast<size_t>(blockSize) * 2);
+    autocorrelationBuffer.resize(static_cast<size_t>(fftSize) / 2 + 1, 0.0f);
     windowedBuffer.resize(fftSize);
-    tempBuffer.resize(static_cast<size_t>(blockSize));
+    
+    // Analysis ring holds one full detection window
+    analysisRing.assign(static_cast<size_t>(analysisWindowSize) * 2, 0.0f);
+    
+    // At high sample rates the lag search runs on a copy decimated to ~12kHz
+    const int decimationFactor = (multiRateAnalysisEnabled && sampleRate >= multiRateMinSampleRate)
+        ? roundToInt(sampleRate / decimatedTargetRate) : 1;
+    analysisDecimator.prepare(sampleRate, decimationFactor);
+    analysisSampleRate = analysisDecimator.getOutputSampleRate();
+    
+    if (decimationFactor > 1)
+    {
+        decimatedRing.assign(static_cast<size_t>(decimatedWindowSize) * 2, 0.0f);
+        decimatedHopBuffer.assign(static_cast<size_t>(maxAnalysisHopSize) + 1, 0.0f);
+        
+        // Refinement searches +-factor full-rate samples around the coarse lag
+        const int maxRefinementLag = static_cast<int>(sampleRate / 50.0) + decimationFactor + 2;
+        refinementHistoryCapacity = refinementWindow + maxRefinementLag + 1;
+        refinementHistory.assign(static_cast<size_t>(refinementHistoryCapacity) * 2, 0.0f);
+        refinementDifference.assign(static_cast<size_t>(decimationFactor) + 4, 0.0f);
+        
+        // Keep the lag search on about the same time cadence as at 48kHz
+        lagSearchHopInterval = jmax(1, roundToInt(sampleRate / 48000.0));
+    }
+    else
+    {
+        decimatedRing.clear();
+        decimatedHopBuffer.clear();
+        refinementHistory.clear();
+        refinementDifference.clear();
+        refinementHistoryCapacity = 0;
+        lagSearchHopInterval = 1;
+    }
+    
+    // Streaming YIN state covers one integration window plus the longest lag (50Hz)
+    yinMaxTau = static_cast<int>(analysisSampleRate / 50.0) + 1;
+    
+    // The decimated integration window spans the same time as the full-rate one at 44.1kHz,
+    // otherwise the tracker would lag by the extra window length
+    yinIntegrationWindow = decimationFactor > 1
+        ? jmax(yinMaxTau, roundToInt(fullRateYinIntegrationWindow * analysisSampleRate / 44100.0))
+        : fullRateYinIntegrationWindow;
+    yinHistoryCapacity = yinIntegrationWindow + yinMaxTau + maxAnalysisHopSize;
+    yinHistory.assign(static_cast<size_t>(yinHistoryCapacity) * 2, 0.0f);
+    yinDifference.assign(static_cast<size_t>(yinMaxTau) + 1, 0.0);
+    yinBuffer.assign(static_cast<size_t>(jmax(yinMaxTau + 1, 1024)), 0.0f);
     
     // Calculate grain parameters based on sample rate
-    grainSize = static_cast<int>(sampleRate * 0.025); // 25ms grains
+    // Both shifters run at the same fixed latency so they can be swapped freely
+    shifterLatency = jmax(2 * shifterMinDelay, roundToInt(sampleRate * shifterLatencySeconds));
+    grainSize = 2 * (shifterLatency - shifterMinDelay);
     hopSize = grainSize / 4; // 75% overlap
     
+    // The shifter delay line covers one grain of tap travel behind the minimum delay
+    const int shifterDelayCapacity = nextPowerOfTwo(grainSize + shifterMinDelay + interpolatorTaps);
+    shifterDelayLine.assign(static_cast<size_t>(shifterDelayCapacity) * 2, 0.0f);
+    shifterDelayMask = shifterDelayCapacity - 1;
+    
+    // PSOLA rings hold the oldest grain still being searched or cut (2.5 periods back)
+    // plus the latency; the grain pool is filled here and never reallocated
+    psolaMaxPeriod = static_cast<int>(sampleRate / 50.0) + 1;
+    const int psolaCapacity = nextPowerOfTwo(3 * psolaMaxPeriod + shifterLatency + 4);
+    psolaInput.assign(static_cast<size_t>(psolaCapacity), 0.0f);
+    psolaOutput.assign(static_cast<size_t>(psolaCapacity), 0.0f);
+    psolaMask = psolaCapacity - 1;
+    
+    grainBuffer.resize(psolaPoolSize);
+    const auto grainCapacity = static_cast<size_t>(2 * psolaMaxPeriod + 1 + 2 * psolaGrainPadding);
+    for (auto& grain : grainBuffer)
+        grain.grain.assign(grainCapacity, 0.0f);
+    synthesisGrain.grain.assign(grainCapacity, 0.0f);
+    
+    // The detector can run a whole host block ahead of processSpectral()
+    spectralFrameQueue.resize(static_cast<size_t>(blockSize / spectralShiftHop + 2));
+    for (auto& frame : spectralFrameQueue)
+    {
+        frame.bins.assign(static_cast<size_t>(fftSize / 2 + 1), {});
+        frame.logEnvelope.assign(envelopeSize, 0.0f);
+    }
+    
+#ifdef USE_RUBBERBAND
+    rubberBandFaster.prepare(sampleRate, blockSize, RubberBandShifter::Engine::Faster);
+    rubberBandFinerShort.prepare(sampleRate, blockSize, RubberBandShifter::Engine::FinerShort);
+    rubberBandFiner.prepare(sampleRate, blockSize, RubberBandShifter::Engine::Finer);
+#endif
+    
+    // Quality tiers: every engine this build has is padded to the slowest one
+    shifterEngineLatency = 0;
+    for (int e = 0; e < numShifterEngines; ++e)
+        shifterEngineLatency = jmax(shifterEngineLatency, getShifterEngineOwnLatency(static_cast<ModeSelector::ShifterEngine>(e)));
+    
+    for (int e = 0; e < numShifterEngines; ++e)
+    {
+        const int delay = shifterEngineLatency - getShifterEngineOwnLatency(static_cast<ModeSelector::ShifterEngine>(e));
+        shifterAlignmentDelays[static_cast<size_t>(e)] = delay;
+        shifterAlignmentRings[static_cast<size_t>(e)].assign(delay > 0 ? static_cast<size_t>(nextPowerOfTwo(delay + 1)) : 0, 0.0f);
+    }
+    
+    shifterInputCopy.assign(static_cast<size_t>(blockSize), 0.0f);
+    shifterIncomingOutput.assign(static_cast<size_t>(blockSize), 0.0f);
+    
     reset();
 }
 
@@ -66,479 +236,2018 @@ void PitchCorrectionEngine::reset()
     std::fill(formantFrequencies.begin(), formantFrequencies.end(), 0.0f);
     std::fill(formantAmplitudes.begin(), formantAmplitudes.end(), 0.0f);
     
-    grainBuffer.clear();
+    std::fill(analysisRing.begin(), analysisRing.end(), 0.0f);
+    analysisRingWritePos = 0;
+    samplesUntilNextHop = analysisHopSize;
+    hopsSinceSpectralAnalysis = 0;
+    
+    std::fill(yinHistory.begin(), yinHistory.end(), 0.0f);
+    std::fill(yinDifference.begin(), yinDifference.end(), 0.0);
+    yinHistoryWritePos = 0;
+    yinHopsSinceRefresh = 0;
+    autocorrelationPitch = 0.0f;
+    
+    analysisDecimator.reset();
+    std::fill(decimatedRing.begin(), decimatedRing.end(), 0.0f);
+    std::fill(refinementHistory.begin(), refinementHistory.end(), 0.0f);
+    decimatedRingWritePos = 0;
+    decimatedHopSamples = 0;
+    refinementHistoryWritePos = 0;
+    yinStreamingPitch = 0.0f;
+    spectralHopCounter = 0;
+    lastAutocorrelationHop = -lagSearchHopInterval;
+    lastMPMHop = -lagSearchHopInterval;
+    detectorConfidence = {};
+    lastCascadeReport = {};
+    hopsSinceSpectralFrame = 0;
+    mpmPitch = 0.0f;
+    yinDifferenceStale = false;
+    resetPitchTracker();
+    voicingLevel = 0.0f;
+    hopsUntilVoicingGateCloses = 0;
+    voicingGateOpen = false;
+    
+    analysisFrame.valid = false;
+    analysisFrame.hopIndex = -1;
+    analysisFrame.spectralCentroid = 0.0f;
+    
+    for (auto& grain : grainBuffer)
+        grain.position = -1;
+    nextGrainSlot = 0;
+    std::fill(psolaInput.begin(), psolaInput.end(), 0.0f);
+    std::fill(psolaOutput.begin(), psolaOutput.end(), 0.0f);
+    psolaSampleCount = 0;
+    lastPitchMark = -1;
+    nextSynthesisMark = 0.0;
+    
+    std::fill(shifterDelayLine.begin(), shifterDelayLine.end(), 0.0f);
+    shifterWritePos = 0;
+    shifterPhase = 0.5f;
+    
+    resetSpectralShift();
+    analysisSampleCount = 0;
+    lastAnalysisInput = nullptr;
+    spectralShiftActive = false;
+    spectralFramesShared = false;
+    
+#ifdef USE_RUBBERBAND
+    rubberBandFaster.reset();
+    rubberBandFinerShort.reset();
+    rubberBandFiner.reset();
+#endif
+    
+    for (auto& ring : shifterAlignmentRings)
+        std::fill(ring.begin(), ring.end(), 0.0f);
+    shifterAlignmentWritePos.fill(0);
+    activeShifterEngine = requestedShifterEngine;
+    shifterEngineStarted = false;
+    shifterTransitionActive = false;
+    phaseVocoderRunning = false;
 }
 
-void PitchCorrectionEngine::detectPitch(const float* inputBuffer, int numSamples, float* pitchOutput)
+void PitchCorrectionEngine::setFormantShift(float ratio)
 {
-    // Enhanced pitch detection with multiple algorithms
-    for (int i = 0; i < numSamples; ++i)
+    formantShiftRatio = jlimit(0.5f, 2.0f, ratio);
+
+#ifdef USE_RUBBERBAND
+    rubberBandFaster.setFormantShift(formantShiftRatio);
+    rubberBandFinerShort.setFormantShift(formantShiftRatio);
+    rubberBandFiner.setFormantShift(formantShiftRatio);
+#endif
+}
+
+void PitchCorrectionEngine::setAnalysisHopSize(int newHopSize)
+{
+    analysisHopSize = jlimit(16, maxAnalysisHopSize, static_cast<int>(nextPowerOfTwo(newHopSize)));
+    samplesUntilNextHop = jmin(samplesUntilNextHop, analysisHopSize);
+}
+
+int PitchCorrectionEngine::getDetectionLatencySamples(ModeSelector::PitchAlgorithm algorithm) const
+{
+    // The windows span a fixed time; the median and tracking add a few hops on top
+    double seconds = 0.0;
+    double hops = 0.0;
+    
+    switch (algorithm)
     {
-        if (i % 128 == 0) // More frequent updates for better tracking
-        {
-            int analysisSize = std::min(2048, numSamples - i);
-            
-            // Use multiple detection methods and combine
-            float autoPitch = detectPitchAutocorrelation(&inputBuffer[i], analysisSize);
-            float yinPitch = detectPitchYIN(&inputBuffer[i], analysisSize);
-            
-            // Combine with confidence weighting
-            if (autoPitch > 0.0f && yinPitch > 0.0f)
-            {
-                currentPitch = (autoPitch + yinPitch) * 0.5f;
-            }
-            else if (autoPitch > 0.0f)
-            {
-                currentPitch = autoPitch;
-            }
-            else if (yinPitch > 0.0f)
-            {
-                currentPitch = yinPitch;
-            }
-            
-            smoothPitch(currentPitch);
-            rmsLevel = calculateRMS(&inputBuffer[i], analysisSize);
-        }
-        
-        pitchOutput[i] = currentPitch;
+        case ModeSelector::PitchAlgorithm::ProbabilisticYIN:
+            seconds = 0.0375;
+            hops = 1.0;
+            break;
+        case ModeSelector::PitchAlgorithm::MPM:
+            seconds = 0.041;
+            hops = 1.0;
+            break;
+        default:
+            seconds = 0.025;
+            hops = 3.5;
+            break;
     }
+    
+    return roundToInt(seconds * sampleRate + hops * analysisHopSize);
+}
+
+void PitchCorrectionEngine::detectPitch(const float* inputBuffer, int numSamples, float* pitchOutput)
+{
+    processAnalysisBlock(inputBuffer, numSamples, pitchOutput, ModeSelector::PitchAlgorithm::Autocorrelation);
 }
 
 void PitchCorrectionEngine::detectPitchAdvanced(const float* inputBuffer, int numSamples, float* pitchOutput)
 {
-    // Use multiple algorithms and combine results for AI mode
-    for (int i = 0; i < numSamples; ++i)
+    processAnalysisBlock(inputBuffer, numSamples, pitchOutput, ModeSelector::PitchAlgorithm::Combined);
+}
+
+void PitchCorrectionEngine::detectPitch(const float* inputBuffer, int numSamples, float* pitchOutput,
+                                        ModeSelector::PitchAlgorithm algorithm)
+{
+    processAnalysisBlock(inputBuffer, numSamples, pitchOutput, algorithm);
+}
+
+void PitchCorrectionEngine::processAnalysisBlock(const float* inputBuffer, int numSamples,
+                                                 float* pitchOutput, ModeSelector::PitchAlgorithm algorithm)
+{
+    if (analysisRing.empty()) return;
+    
+    lastAnalysisInput = inputBuffer;
+    int position = 0;
+    
+    while (position < numSamples)
     {
-        if (i % 128 == 0) // More frequent updates for AI mode
+        // Consume up to the next hop boundary; every sample in the chunk reports
+        // the pitch that was valid before the hop completed
+        int chunk = jmin(numSamples - position, samplesUntilNextHop);
+        
+        for (int i = 0; i < chunk; ++i)
         {
-            int analysisSize = std::min(2048, numSamples - i);
-            
-            // Get pitches from different algorithms
-            float autoPitch = detectPitchAutocorrelation(&inputBuffer[i], analysisSize);
-            float yinPitch = detectPitchYIN(&inputBuffer[i], analysisSize);
-            float spectralPitch = detectPitchSpectral(&inputBuffer[i], analysisSize);
-            float harmonicPitch = detectPitchHarmonic(&inputBuffer[i], analysisSize);
-            
-            // Combine results with confidence weighting
-            std::vector<float> pitches = {autoPitch, yinPitch, spectralPitch, harmonicPitch};
-            std::vector<float> weights = {0.2f, 0.3f, 0.3f, 0.2f}; // YIN and spectral get more weight
+            analysisRing[analysisRingWritePos] = inputBuffer[position + i];
+            analysisRing[analysisRingWritePos + analysisWindowSize] = inputBuffer[position + i];
+            analysisRingWritePos = (analysisRingWritePos + 1) % analysisWindowSize;
+        }
+        
+        if (isMultiRateAnalysisActive())
+            pushMultiRateInput(inputBuffer + position, chunk);
+        
+        std::fill(pitchOutput + position, pitchOutput + position + chunk, currentPitch);
+        
+        position += chunk;
+        samplesUntilNextHop -= chunk;
+        analysisSampleCount += chunk;
+        
+        if (samplesUntilNextHop == 0)
+        {
+            samplesUntilNextHop = analysisHopSize;
+            advanceAnalysisHop();
             
-            float combinedPitch = 0.0f;
-            float totalWeight = 0.0f;
+            const float* analysisWindow = &analysisRing[analysisRingWritePos];
             
-            for (size_t j = 0; j < pitches.size(); ++j)
+            if (voicingGateEnabled && !updateVoicingGate(analysisWindow))
             {
-                if (pitches[j] > 0.0f) // Valid pitch
-                {
-                    combinedPitch += pitches[j] * weights[j];
-                    totalWeight += weights[j];
-                }
+                skipUnvoicedHop(analysisWindow);
+                continue;
             }
             
-            if (totalWeight > 0.0f)
+            switch (algorithm)
             {
-                currentPitch = combinedPitch / totalWeight;
-                smoothPitch(currentPitch);
+                case ModeSelector::PitchAlgorithm::MPM:
+                    runMPMAnalysisHop();
+                    break;
+                case ModeSelector::PitchAlgorithm::ProbabilisticYIN:
+                    runProbabilisticYINHop();
+                    break;
+                case ModeSelector::PitchAlgorithm::Spectral:
+                case ModeSelector::PitchAlgorithm::Harmonic:
+                case ModeSelector::PitchAlgorithm::Combined:
+                    runAdvancedAnalysisHop();
+                    break;
+                case ModeSelector::PitchAlgorithm::Autocorrelation:
+                case ModeSelector::PitchAlgorithm::YIN:
+                default:
+                    runAnalysisHop();
+                    break;
             }
             
-            rmsLevel = calculateRMS(&inputBuffer[i], analysisSize);
-            analyzeSpectrum(&inputBuffer[i], analysisSize);
+            // A spectral detector that transformed this hop hands its frame to the phase vocoder
+            if (spectralShiftActive && spectralFramesShared && analysisSampleCount % spectralShiftHop == 0)
+                queueSpectralFrame();
         }
-        
-        pitchOutput[i] = currentPitch;
     }
 }
 
-float PitchCorrectionEngine::detectPitchAutocorrelation(const float* buffer, int numSamples)
+bool PitchCorrectionEngine::updateVoicingGate(const float* analysisWindow)
 {
-    if (numSamples < 64) return 0.0f;
+    const float* recent = analysisWindow + analysisWindowSize - voicingWindowSize;
+    voicingLevel = calculateRMS(recent, voicingWindowSize);
     
-    // Copy to windowed buffer and apply window
-    int analysisSize = std::min(numSamples, static_cast<int>(windowedBuffer.size()));
-    std::copy(buffer, buffer + analysisSize, windowedBuffer.begin());
-    applyHannWindow(windowedBuffer.data(), analysisSize);
+    const float levelDb = Utils::linearToDecibels(voicingLevel);
+    const float crossingsPerSecond = Utils::calculateZeroCrossingRate(recent, voicingWindowSize)
+                                   * static_cast<float>(sampleRate);
     
-    // Calculate autocorrelation
-    std::fill(autocorrelationBuffer.begin(), autocorrelationBuffer.end(), 0.0f);
+    ++voicingStats.evaluatedHops;
     
-    for (int lag = 1; lag < analysisSize / 2; ++lag)
+    // Hysteresis: an open gate tolerates a lower level and a noisier signal
+    const bool voiced = voicingGateOpen
+        ? (levelDb > voicingCloseLevelDb && crossingsPerSecond < voicingCloseCrossingsPerSecond)
+        : (levelDb > voicingOpenLevelDb && crossingsPerSecond < voicingOpenCrossingsPerSecond);
+    
+    if (voiced)
     {
-        for (int i = 0; i < analysisSize - lag; ++i)
-        {
-            autocorrelationBuffer[lag] += windowedBuffer[i] * windowedBuffer[i + lag];
-        }
-        autocorrelationBuffer[lag] /= (analysisSize - lag); // Normalize
+        voicingGateOpen = true;
+        hopsUntilVoicingGateCloses = jmax(1, roundToInt(voicingHoldSeconds * sampleRate / analysisHopSize));
+        return true;
     }
     
-    // Find peak in autocorrelation
-    float maxValue = 0.0f;
-    int maxLag = 0;
-    int minLag = static_cast<int>(sampleRate / 800.0); // Min freq ~800Hz
-    int maxLagLimit = static_cast<int>(sampleRate / 50.0); // Max freq ~50Hz
+    // Hold the gate over short dips such as consonant onsets inside a phrase
+    if (voicingGateOpen && --hopsUntilVoicingGateCloses > 0)
+        return true;
+    
+    if (voicingGateOpen)
+        closeVoicingGate();
+    
+    return false;
+}
+
+void PitchCorrectionEngine::skipUnvoicedHop(const float* analysisWindow)
+{
+    // Keep the lag histories moving so the detectors resume on current audio
+    skipYINAtAnalysisRate(analysisWindow + analysisWindowSize - analysisHopSize);
+    rmsLevel = voicingLevel;
+    ++voicingStats.skippedHops;
+}
+
+void PitchCorrectionEngine::closeVoicingGate()
+{
+    voicingGateOpen = false;
     
-    for (int lag = minLag; lag < maxLagLimit && lag < autocorrelationBuffer.size(); ++lag)
+    // Nothing from the previous note may leak into the next one
+    currentPitch = 0.0f;
+    pitchConfidence = 0.0f;
+    std::fill(pitchHistory.begin(), pitchHistory.end(), 0.0f);
+    autocorrelationPitch = 0.0f;
+    mpmPitch = 0.0f;
+    yinStreamingPitch = 0.0f;
+    detectorConfidence = {};
+    lastCascadeReport = {};
+    lastAutocorrelationHop = spectralHopCounter - lagSearchHopInterval;
+    lastMPMHop = spectralHopCounter - lagSearchHopInterval;
+    resetPitchTracker();
+}
+
+bool PitchCorrectionEngine::isSpectralAnalysisHop()
+{
+    // FFT-based detectors run every 128 samples even when the hop is finer
+    if (++hopsSinceSpectralAnalysis >= jmax(1, spectralAnalysisHop / analysisHopSize))
     {
-        if (autocorrelationBuffer[lag] > maxValue)
-        {
-            maxValue = autocorrelationBuffer[lag];
-            maxLag = lag;
-        }
+        hopsSinceSpectralAnalysis = 0;
+        ++spectralHopCounter;
+        return true;
+    }
+    
+    return false;
+}
+
+void PitchCorrectionEngine::runAnalysisHop()
+{
+    // The most recent window starts at the write position of the doubled ring
+    const float* analysisWindow = &analysisRing[analysisRingWritePos];
+    const float* newestHop = analysisWindow + analysisWindowSize - analysisHopSize;
+    
+    // Enhanced pitch detection with multiple algorithms
+    float yinPitch = detectPitchYINAtAnalysisRate(newestHop);
+    
+    if (isSpectralAnalysisHop())
+    {
+        autocorrelationPitch = detectPitchAutocorrelationAtAnalysisRate(analysisWindow);
+        rmsLevel = calculateRMS(analysisWindow, analysisWindowSize);
     }
     
-    if (maxLag > 0 && maxValue > 0.3f) // Confidence threshold
+    float autoPitch = autocorrelationPitch;
+    
+    // Combine with confidence weighting
+    if (autoPitch > 0.0f && yinPitch > 0.0f)
     {
-        // Parabolic interpolation for sub-sample accuracy
-        if (maxLag > 1 && maxLag < autocorrelationBuffer.size() - 1)
+        currentPitch = (autoPitch + yinPitch) * 0.5f;
+    }
+    else if (autoPitch > 0.0f)
+    {
+        currentPitch = autoPitch;
+    }
+    else if (yinPitch > 0.0f)
+    {
+        currentPitch = yinPitch;
+    }
+    
+    smoothPitch(currentPitch);
+}
+
+void PitchCorrectionEngine::runAdvancedAnalysisHop()
+{
+    const float* analysisWindow = &analysisRing[analysisRingWritePos];
+    const float* newestHop = analysisWindow + analysisWindowSize - analysisHopSize;
+    
+    // Stage 1: YIN is updated every hop anyway
+    std::array<PitchEstimate, 4> estimates;
+    int numEstimates = 0;
+    estimates[numEstimates++] = { detectPitchYINAtAnalysisRate(newestHop), detectorConfidence.yin };
+    
+    if (!isSpectralAnalysisHop())
+        return;
+    
+    CascadeReport report;
+    const PitchEstimate& yin = estimates[0];
+    bool resolved = yin.frequency > 0.0f
+                 && yin.confidence >= cascadeConfidenceThreshold
+                 && !isOctaveError(yin.frequency, currentPitch);
+    
+    // Stage 2: autocorrelation when YIN is unsure or an octave away from the track
+    if (!resolved)
+    {
+        estimates[numEstimates++] = { detectPitchAutocorrelationAtAnalysisRate(analysisWindow),
+                                      detectorConfidence.autocorrelation };
+        report.ranAutocorrelation = true;
+        resolved = areConfidentEstimatesConsistent(estimates.data(), numEstimates);
+    }
+    
+    // Stage 3: spectral peak and HPS arbitrate when the lag detectors are unsure or disagree
+    if (!resolved)
+    {
+        estimates[numEstimates++] = { detectPitchSpectral(analysisWindow, analysisWindowSize),
+                                      detectorConfidence.spectral };
+        estimates[numEstimates++] = { detectPitchHarmonic(analysisWindow, analysisWindowSize),
+                                      detectorConfidence.harmonic };
+        report.ranSpectral = true;
+    }
+    
+    PitchEstimate combined = combineEstimates(estimates.data(), numEstimates);
+    report.confidence = combined.confidence;
+    pitchConfidence = combined.confidence;
+    
+    if (combined.frequency > 0.0f)
+    {
+        currentPitch = combined.frequency;
+        smoothPitch(currentPitch);
+    }
+    
+    lastCascadeReport = report;
+    ++cascadeStats.evaluatedHops;
+    cascadeStats.autocorrelationHops += report.ranAutocorrelation ? 1 : 0;
+    cascadeStats.spectralHops += report.ranSpectral ? 1 : 0;
+    
+    rmsLevel = calculateRMS(analysisWindow, analysisWindowSize);
+    
+    // The spectral frame also feeds the centroid and formants, so it is refreshed
+    // periodically even when the cascade exits early
+    if (report.ranSpectral || ++hopsSinceSpectralFrame >= spectralFrameRefreshInterval)
+    {
+        hopsSinceSpectralFrame = 0;
+        analyzeSpectrum(analysisWindow, analysisWindowSize);
+    }
+}
+
+bool PitchCorrectionEngine::pitchesAgree(float a, float b)
+{
+    return std::abs(1200.0f * std::log2(a / b)) <= cascadeAgreementCents;
+}
+
+bool PitchCorrectionEngine::isOctaveError(float a, float b)
+{
+    if (a <= 0.0f || b <= 0.0f)
+        return false;
+    
+    // Within the agreement tolerance of a non-zero whole number of octaves
+    float octaves = std::abs(std::log2(a / b));
+    float nearestOctave = std::round(octaves);
+    return nearestOctave >= 1.0f && std::abs(octaves - nearestOctave) * 1200.0f <= cascadeAgreementCents * 2.0f;
+}
+
+bool PitchCorrectionEngine::areConfidentEstimatesConsistent(const PitchEstimate* estimates, int numEstimates) const
+{
+    // Resolved when at least one estimate is confident and all confident ones agree
+    const PitchEstimate* reference = nullptr;
+    
+    for (int i = 0; i < numEstimates; ++i)
+    {
+        const auto& estimate = estimates[i];
+        if (estimate.frequency <= 0.0f || estimate.confidence < cascadeConfidenceThreshold)
+            continue;
+        
+        if (reference == nullptr)
+            reference = &estimate;
+        else if (!pitchesAgree(estimate.frequency, reference->frequency))
+            return false;
+    }
+    
+    return reference != nullptr && !isOctaveError(reference->frequency, currentPitch);
+}
+
+PitchCorrectionEngine::PitchEstimate PitchCorrectionEngine::combineEstimates(const PitchEstimate* estimates,
+                                                                             int numEstimates) const
+{
+    // Confidence-weighted vote: the estimate backed by the most agreeing confidence wins,
+    // and the agreeing estimates are averaged by confidence. Ties go to the earlier stage.
+    int bestIndex = -1;
+    float bestSupport = 0.0f;
+    int numValid = 0;
+    
+    for (int i = 0; i < numEstimates; ++i)
+    {
+        if (estimates[i].frequency <= 0.0f || estimates[i].confidence <= 0.0f)
+            continue;
+        
+        ++numValid;
+        float support = 0.0f;
+        
+        for (int j = 0; j < numEstimates; ++j)
         {
-            float y1 = autocorrelationBuffer[maxLag - 1];
-            float y2 = autocorrelationBuffer[maxLag];
-            float y3 = autocorrelationBuffer[maxLag + 1];
-            
-            float a = (y1 - 2*y2 + y3) / 2.0f;
-            if (std::abs(a) > 1e-6f)
-            {
-                float peak = -0.5f * (y3 - y1) / a;
-                float trueLag = maxLag + peak;
-                pitchConfidence = maxValue;
-                return static_cast<float>(sampleRate / trueLag);
-            }
+            if (estimates[j].frequency > 0.0f && pitchesAgree(estimates[i].frequency, estimates[j].frequency))
+                support += estimates[j].confidence;
         }
         
-        pitchConfidence = maxValue;
-        return static_cast<float>(sampleRate / maxLag);
+        if (support > bestSupport)
+        {
+            bestSupport = support;
+            bestIndex = i;
+        }
     }
     
-    pitchConfidence = 0.0f;
-    return 0.0f;
+    if (bestIndex < 0)
+        return {};
+    
+    float weightedFrequency = 0.0f;
+    for (int j = 0; j < numEstimates; ++j)
+    {
+        if (estimates[j].frequency > 0.0f && pitchesAgree(estimates[bestIndex].frequency, estimates[j].frequency))
+            weightedFrequency += estimates[j].frequency * estimates[j].confidence;
+    }
+    
+    return { weightedFrequency / bestSupport, jmin(1.0f, bestSupport / numValid) };
+}
+
+void PitchCorrectionEngine::runMPMAnalysisHop()
+{
+    const float* analysisWindow = &analysisRing[analysisRingWritePos];
+    const float* newestHop = analysisWindow + analysisWindowSize - analysisHopSize;
+    
+    // MPM does not use YIN, but its history keeps advancing so other backends can resume
+    skipYINAtAnalysisRate(newestHop);
+    
+    if (!isSpectralAnalysisHop())
+        return;
+    
+    float mpmResult = detectPitchMPMAtAnalysisRate(analysisWindow);
+    rmsLevel = calculateRMS(analysisWindow, analysisWindowSize);
+    
+    if (mpmResult > 0.0f)
+    {
+        currentPitch = mpmResult;
+        smoothPitch(currentPitch);
+    }
+}
+
+void PitchCorrectionEngine::runProbabilisticYINHop()
+{
+    const float* analysisWindow = &analysisRing[analysisRingWritePos];
+    const float* newestHop = analysisWindow + analysisWindowSize - analysisHopSize;
+    
+    // Updates the streaming difference function and leaves the CMNDF in yinBuffer
+    detectPitchYINAtAnalysisRate(newestHop);
+    findPitchCandidates(yinMaxTau + 1, analysisSampleRate);
+    float trackedPitch = trackPitchCandidates();
+    
+    if (isSpectralAnalysisHop())
+        rmsLevel = calculateRMS(analysisWindow, analysisWindowSize);
+    
+    // The Viterbi path is already smooth, so it bypasses smoothPitch
+    if (trackedPitch > 0.0f)
+        currentPitch = isMultiRateAnalysisActive() ? refinePitchAtFullRate(trackedPitch) : trackedPitch;
+}
+
+void PitchCorrectionEngine::pushMultiRateInput(const float* input, int numSamples)
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        refinementHistory[refinementHistoryWritePos] = input[i];
+        refinementHistory[refinementHistoryWritePos + refinementHistoryCapacity] = input[i];
+        refinementHistoryWritePos = (refinementHistoryWritePos + 1) % refinementHistoryCapacity;
+    }
+    
+    float* decimated = decimatedHopBuffer.data() + decimatedHopSamples;
+    const int numDecimated = analysisDecimator.process(input, numSamples, decimated);
+    
+    for (int i = 0; i < numDecimated; ++i)
+    {
+        decimatedRing[decimatedRingWritePos] = decimated[i];
+        decimatedRing[decimatedRingWritePos + decimatedWindowSize] = decimated[i];
+        decimatedRingWritePos = (decimatedRingWritePos + 1) % decimatedWindowSize;
+    }
+    
+    decimatedHopSamples += numDecimated;
+}
+
+float PitchCorrectionEngine::detectPitchYINAtAnalysisRate(const float* newestHop)
+{
+    if (!isMultiRateAnalysisActive())
+        return detectPitchYINStreaming(newestHop, analysisHopSize);
+    
+    // A hop shorter than the decimation factor may not produce a new sample
+    if (decimatedHopSamples > 0)
+    {
+        float coarsePitch = detectPitchYINStreaming(decimatedHopBuffer.data(), decimatedHopSamples);
+        yinStreamingPitch = refinePitchAtFullRate(coarsePitch);
+        decimatedHopSamples = 0;
+    }
+    
+    return yinStreamingPitch;
+}
+
+float PitchCorrectionEngine::detectPitchAutocorrelationAtAnalysisRate(const float* analysisWindow)
+{
+    if (!isMultiRateAnalysisActive())
+        return detectPitchAutocorrelation(analysisWindow, analysisWindowSize, *fft, sampleRate);
+    
+    if (!isLagSearchDue(lastAutocorrelationHop))
+        return autocorrelationPitch;
+    
+    const float* decimatedWindow = &decimatedRing[decimatedRingWritePos];
+    float coarsePitch = detectPitchAutocorrelation(decimatedWindow, decimatedWindowSize,
+                                                   *decimatedFFT, analysisSampleRate);
+    autocorrelationPitch = refinePitchAtFullRate(coarsePitch);
+    return autocorrelationPitch;
+}
+
+float PitchCorrectionEngine::detectPitchMPMAtAnalysisRate(const float* analysisWindow)
+{
+    if (!isMultiRateAnalysisActive())
+        return detectPitchMPM(analysisWindow, analysisWindowSize, *fft, sampleRate);
+    
+    if (!isLagSearchDue(lastMPMHop))
+        return mpmPitch;
+    
+    const float* decimatedWindow = &decimatedRing[decimatedRingWritePos];
+    float coarsePitch = detectPitchMPM(decimatedWindow, decimatedWindowSize, *decimatedFFT, analysisSampleRate);
+    mpmPitch = refinePitchAtFullRate(coarsePitch);
+    return mpmPitch;
+}
+
+void PitchCorrectionEngine::skipYINAtAnalysisRate(const float* newestHop)
+{
+    if (!isMultiRateAnalysisActive())
+    {
+        appendYINHistory(newestHop, analysisHopSize);
+    }
+    else
+    {
+        appendYINHistory(decimatedHopBuffer.data(), decimatedHopSamples);
+        decimatedHopSamples = 0;
+    }
+    
+    yinDifferenceStale = true;
+}
+
+bool PitchCorrectionEngine::isLagSearchDue(int64& lastSearchHop)
+{
+    // Decimated lag searches keep about the same time cadence as at 48kHz. Counting
+    // spectral hops (not calls) keeps the cached result fresh when a caller skips hops.
+    if (spectralHopCounter - lastSearchHop < lagSearchHopInterval)
+        return false;
+    
+    lastSearchHop = spectralHopCounter;
+    return true;
+}
+
+float PitchCorrectionEngine::refinePitchAtFullRate(float coarsePitch)
+{
+    if (coarsePitch <= 0.0f) return coarsePitch;
+    
+    float difference = 0.0f;
+    const float lag = refineLagAtFullRate(roundToInt(sampleRate / coarsePitch), difference);
+    
+    if (lag <= 0.0f) return coarsePitch;
+    
+    // A period that falls between decimated samples can lose the decimated lag search to
+    // twice itself, whose rounding costs relatively less. Within the detectors' 800Hz
+    // ceiling, half the lag was the period when it fits the full-rate signal about as well
+    // as the lag itself. A fair dip is not enough: voices with a weak fundamental have one
+    // there, an octave too high.
+    const int halfLag = roundToInt(0.5f * lag);
+    
+    if (halfLag >= static_cast<int>(sampleRate / 800.0))
+    {
+        const float* newest = &refinementHistory[refinementHistoryWritePos + refinementHistoryCapacity - refinementWindow];
+        const float energy = DSPKernels::sumOfSquares(newest, refinementWindow);
+        float halfDifference = 0.0f;
+        const float refinedHalfLag = refineLagAtFullRate(halfLag, halfDifference);
+        
+        if (refinedHalfLag > 0.0f
+            && halfDifference < refinementOctaveThreshold * 2.0f * energy
+            && halfDifference <= jmax(refinementOctaveMatch * difference, refinementOctaveFloor * 2.0f * energy))
+            return static_cast<float>(sampleRate / refinedHalfLag);
+    }
+    
+    return static_cast<float>(sampleRate / lag);
+}
+
+float PitchCorrectionEngine::refineLagAtFullRate(int coarseLag, float& minimumDifference)
+{
+    // Search the difference function d(tau) = sum (x[n] - x[n - tau])^2 over the newest
+    // full-rate samples, within half a decimated sample (plus one) of the coarse lag
+    const int factor = analysisDecimator.getFactor();
+    const int maxLag = refinementHistoryCapacity - refinementWindow - 1;
+    const int numTaus = jmin(2 * (factor / 2) + 3, static_cast<int>(refinementDifference.size()), maxLag - 1);
+    
+    if (numTaus < 3) return -1.0f;
+    
+    const float* newest = &refinementHistory[refinementHistoryWritePos + refinementHistoryCapacity - refinementWindow];
+    int firstTau = coarseLag - numTaus / 2;
+    
+    // A minimum on the edge means the coarse lag was off by more than the range, as with low
+    // voices whose few periods in the decimated window bias its peak; the search then moves
+    // that way, a few ranges at most, rather than settle for a neighbouring slope
+    for (int attempt = 0; attempt < maxRefinementAttempts; ++attempt)
+    {
+        firstTau = jlimit(2, maxLag - numTaus + 1, firstTau);
+        int bestIndex = 0;
+        
+        for (int i = 0; i < numTaus; ++i)
+        {
+            refinementDifference[i] = DSPKernels::sumOfSquaredDifferences(newest, newest - (firstTau + i), refinementWindow);
+            
+            if (refinementDifference[i] < refinementDifference[bestIndex])
+                bestIndex = i;
+        }
+        
+        if (bestIndex == 0 || bestIndex == numTaus - 1)
+        {
+            firstTau += bestIndex == 0 ? 2 - numTaus : numTaus - 2;
+            continue;
+        }
+        
+        float d0 = refinementDifference[bestIndex - 1];
+        float d1 = refinementDifference[bestIndex];
+        float d2 = refinementDifference[bestIndex + 1];
+        float curvature = d0 - 2.0f * d1 + d2;
+        float offset = curvature > 0.0f ? 0.5f * (d0 - d2) / curvature : 0.0f;
+        
+        minimumDifference = d1;
+        return static_cast<float>(firstTau + bestIndex) + offset;
+    }
+    
+    return -1.0f;
+}
+
+float PitchCorrectionEngine::detectPitchAutocorrelation(const float* buffer, int numSamples,
+                                                        dsp::FFT& transform, double rate)
+{
+    if (numSamples < 64) return 0.0f;
+    
+    const int transformSize = transform.getSize();
+    
+    // Copy to windowed buffer and apply window. The window is limited to half the
+    // FFT size so the zero-padded circular correlation equals the linear one.
+    int analysisSize = std::min(numSamples, transformSize / 2);
+    std::copy(buffer, buffer + analysisSize, windowedBuffer.begin());
+    applyHannWindow(windowedBuffer.data(), analysisSize);
+    
+    // Wiener-Khinchin: autocorrelation = IFFT(|FFT(x)|^2) on the zero-padded frame
+    for (int i = 0; i < transformSize; ++i)
+    {
+        fftWorkspace[i] = dsp::Complex<float>(i < analysisSize ? windowedBuffer[i] : 0.0f, 0.0f);
+    }
+    
+    transform.perform(fftWorkspace, frequencyData, false);
+    
+    for (int i = 0; i < transformSize; ++i)
+    {
+        fftWorkspace[i] = dsp::Complex<float>(std::norm(frequencyData[i]), 0.0f);
+    }
+    
+    transform.perform(fftWorkspace, frequencyData, true);
+    
+    // Only the 50-800 Hz lag window (plus one neighbour for interpolation) is needed
+    const int halfSize = analysisSize / 2;
+    const int maxBufferLag = jmin(static_cast<int>(autocorrelationBuffer.size()) - 1, transformSize / 2);
+    int minLag = jmax(1, static_cast<int>(rate / 800.0)); // Min freq ~800Hz
+    int maxLagLimit = jmin(static_cast<int>(rate / 50.0), maxBufferLag); // Max freq ~50Hz
+    
+    for (int lag = minLag - 1; lag <= maxLagLimit; ++lag)
+    {
+        autocorrelationBuffer[lag] = (lag > 0 && lag < halfSize)
+            ? frequencyData[lag].real() / (analysisSize - lag) // Normalize
+            : 0.0f;
+    }
+    
+    // Find peak in autocorrelation
+    float maxValue = 0.0f;
+    int maxLag = 0;
+    
+    for (int lag = minLag; lag < maxLagLimit; ++lag)
+    {
+        if (autocorrelationBuffer[lag] > maxValue)
+        {
+            maxValue = autocorrelationBuffer[lag];
+            maxLag = lag;
+        }
+    }
+    
+    // Peak relative to the zero-lag power, so the confidence does not depend on level
+    const float zeroLagPower = frequencyData[0].real() / analysisSize;
+    const float normalisedPeak = zeroLagPower > 0.0f ? jlimit(0.0f, 1.0f, maxValue / zeroLagPower) : 0.0f;
+    
+    if (maxLag > 0 && normalisedPeak > 0.3f) // Confidence threshold
+    {
+        detectorConfidence.autocorrelation = normalisedPeak;
+
+        // Parabolic interpolation for sub-sample accuracy
+        if (maxLag > 1 && maxLag < maxBufferLag)
+        {
+            float y1 = autocorrelationBuffer[maxLag - 1];
+            float y2 = autocorrelationBuffer[maxLag];
+            float y3 = autocorrelationBuffer[maxLag + 1];
+            
+            float curvature = y1 - 2*y2 + y3;
+            if (std::abs(curvature) > 1e-6f)
+            {
+                float peak = 0.5f * (y1 - y3) / curvature;
+                float trueLag = maxLag + peak;
+                pitchConfidence = normalisedPeak;
+                return static_cast<float>(rate / trueLag);
+            }
+        }
+        
+        pitchConfidence = normalisedPeak;
+        return static_cast<float>(rate / maxLag);
+    }
+    
+    detectorConfidence.autocorrelation = 0.0f;
+    pitchConfidence = 0.0f;
+    return 0.0f;
+}
+
+float PitchCorrectionEngine::detectPitchYINStreaming(const float* newSamples, int numNewSamples)
+{
+    numNewSamples = appendYINHistory(newSamples, numNewSamples);
+    if (numNewSamples <= 0) return 0.0f;
+    
+    // v[0, windowSpan) is the previous window, v[hop, hop + windowSpan) the current one
+    const int windowSpan = yinIntegrationWindow + yinMaxTau;
+    const float* v = &yinHistory[yinHistoryWritePos + yinHistoryCapacity - windowSpan - numNewSamples];
+    const float* current = v + numNewSamples;
+    
+    if (++yinHopsSinceRefresh >= yinRefreshInterval || yinDifferenceStale)
+    {
+        // Periodic full recompute so add/remove rounding cannot accumulate, and
+        // after hops that only advanced the history
+        yinHopsSinceRefresh = 0;
+        yinDifferenceStale = false;
+        for (int tau = 1; tau <= yinMaxTau; ++tau)
+        {
+            yinDifference[tau] = DSPKernels::sumOfSquaredDifferences(current, current + tau, yinIntegrationWindow);
+        }
+    }
+    else
+    {
+        // d'(tau) = d(tau) + terms entering the window - terms leaving it
+        const float* entering = v + yinIntegrationWindow;
+        for (int tau = 1; tau <= yinMaxTau; ++tau)
+        {
+            double added = DSPKernels::sumOfSquaredDifferences(entering, entering + tau, numNewSamples);
+            double removed = DSPKernels::sumOfSquaredDifferences(v, v + tau, numNewSamples);
+            yinDifference[tau] = jmax(0.0, yinDifference[tau] + added - removed);
+        }
+    }
+    
+    for (int tau = 1; tau <= yinMaxTau; ++tau)
+    {
+        yinBuffer[tau] = static_cast<float>(yinDifference[tau]);
+    }
+    
+    return findYinPitch(yinMaxTau + 1, analysisSampleRate);
+}
+
+int PitchCorrectionEngine::appendYINHistory(const float* newSamples, int numNewSamples)
+{
+    numNewSamples = jmin(numNewSamples, maxAnalysisHopSize);
+    if (numNewSamples <= 0 || yinHistoryCapacity == 0) return 0;
+    
+    // Append the hop to the history ring (each sample is stored twice so the
+    // most recent window can always be read as one contiguous block)
+    for (int i = 0; i < numNewSamples; ++i)
+    {
+        yinHistory[yinHistoryWritePos] = newSamples[i];
+        yinHistory[yinHistoryWritePos + yinHistoryCapacity] = newSamples[i];
+        yinHistoryWritePos = (yinHistoryWritePos + 1) % yinHistoryCapacity;
+    }
+    
+    return numNewSamples;
+}
+
+float PitchCorrectionEngine::findYinPitch(int bufferLength, double rate)
+{
+    // Step 2: Cumulative mean normalized difference
+    yinBuffer[0] = 1.0f;
+    float runningSum = 0.0f;
+    for (int tau = 1; tau < bufferLength; ++tau)
+    {
+        runningSum += yinBuffer[tau];
+        if (runningSum > 0.0f)
+        {
+            yinBuffer[tau] *= tau / runningSum;
+        }
+        else
+        {
+            yinBuffer[tau] = 1.0f;
+        }
+    }
+    
+    // Step 3: Absolute threshold
+    const float threshold = 0.1f;
+    int minTau = static_cast<int>(rate / 800.0);
+    int maxTau = static_cast<int>(rate / 50.0);
+    
+    for (int tau = minTau; tau < maxTau && tau < bufferLength; ++tau)
+    {
+        if (yinBuffer[tau] < threshold)
+        {
+            // Step 4: Parabolic interpolation
+            while (tau + 1 < bufferLength && yinBuffer[tau + 1] < yinBuffer[tau])
+            {
+                tau++;
+            }
+            
+            detectorConfidence.yin = jlimit(0.0f, 1.0f, 1.0f - yinBuffer[tau]);
+            
+            // Interpolation
+            if (tau > 0 && tau < bufferLength - 1)
+            {
+                float s0 = yinBuffer[tau - 1];
+                float s1 = yinBuffer[tau];
+                float s2 = yinBuffer[tau + 1];
+                
+                float betterTau = tau + (s2 - s0) / (2.0f * (2.0f * s1 - s2 - s0));
+                return static_cast<float>(rate / betterTau);
+            }
+            
+            return static_cast<float>(rate / tau);
+        }
+    }
+    
+    detectorConfidence.yin = 0.0f;
+    return 0.0f;
+}
+
+float PitchCorrectionEngine::detectPitchMPM(const float* buffer, int numSamples, dsp::FFT& transform, double rate)
+{
+    const int transformSize = transform.getSize();
+    const int windowSize = jmin(numSamples, transformSize / 2);
+    const int minTau = jmax(2, static_cast<int>(rate / 800.0));
+    const int maxTau = jmin(static_cast<int>(rate / 50.0), windowSize / 2);
+    
+    if (maxTau <= minTau + 1) return 0.0f;
+    
+    // r(tau) = IFFT(|FFT(x)|^2) on the zero-padded, unwindowed frame
+    for (int i = 0; i < transformSize; ++i)
+    {
+        fftWorkspace[i] = dsp::Complex<float>(i < windowSize ? buffer[i] : 0.0f, 0.0f);
+    }
+    
+    transform.perform(fftWorkspace, frequencyData, false);
+    
+    for (int i = 0; i < transformSize; ++i)
+    {
+        fftWorkspace[i] = dsp::Complex<float>(std::norm(frequencyData[i]), 0.0f);
+    }
+    
+    transform.perform(fftWorkspace, frequencyData, true);
+    
+    // NSDF n(tau) = 2 r(tau) / m(tau), with m(tau) = sum of x[j]^2 + x[j + tau]^2 over
+    // the overlap, shrunk by two squares per lag
+    double m = 2.0 * DSPKernels::sumOfSquares(buffer, windowSize);
+    for (int tau = 1; tau <= maxTau + 1; ++tau)
+    {
+        m -= static_cast<double>(buffer[tau - 1]) * buffer[tau - 1]
+           + static_cast<double>(buffer[windowSize - tau]) * buffer[windowSize - tau];
+        nsdfBuffer[tau] = m > 1.0e-9 ? static_cast<float>(2.0 * frequencyData[tau].real() / m) : 0.0f;
+    }
+    
+    // Key maxima: the highest point of each positive lobe after the first negative crossing
+    std::array<int, 64> keyMaxima;
+    int numKeyMaxima = 0;
+    int lobePeak = 0;
+    float highest = 0.0f;
+    
+    int tau = 1;
+    while (tau <= maxTau && nsdfBuffer[tau] > 0.0f)
+        ++tau;
+    
+    for (; tau <= maxTau && numKeyMaxima < static_cast<int>(keyMaxima.size()); ++tau)
+    {
+        if (nsdfBuffer[tau] > 0.0f)
+        {
+            if (lobePeak == 0 || nsdfBuffer[tau] > nsdfBuffer[lobePeak])
+                lobePeak = tau;
+        }
+        
+        if ((nsdfBuffer[tau] <= 0.0f || tau == maxTau) && lobePeak > 0)
+        {
+            if (lobePeak >= minTau)
+            {
+                keyMaxima[numKeyMaxima++] = lobePeak;
+                highest = jmax(highest, nsdfBuffer[lobePeak]);
+            }
+            lobePeak = 0;
+        }
+    }
+    
+    if (highest < mpmMinimumClarity)
+    {
+        pitchConfidence = 0.0f;
+        return 0.0f;
+    }
+    
+    // The first key maximum close to the highest one is the period, not a multiple
+    for (int i = 0; i < numKeyMaxima; ++i)
+    {
+        const int peak = keyMaxima[i];
+        if (nsdfBuffer[peak] < mpmKeyMaximumThreshold * highest)
+            continue;
+        
+        float y1 = nsdfBuffer[peak - 1];
+        float y2 = nsdfBuffer[peak];
+        float y3 = nsdfBuffer[peak + 1];
+        float a = (y1 - 2.0f * y2 + y3) / 2.0f;
+        float offset = std::abs(a) > 1e-6f ? -0.5f * (y3 - y1) / (2.0f * a) : 0.0f;
+        
+        pitchConfidence = y2;
+        return static_cast<float>(rate / (peak + offset));
+    }
+    
+    pitchConfidence = 0.0f;
+    return 0.0f;
+}
+
+void PitchCorrectionEngine::findPitchCandidates(int bufferLength, double rate)
+{
+    // yinBuffer holds the CMNDF. A YIN scan with threshold s stops at the first dip
+    // below s, so a dip gets the prior mass of thresholds between its value and the
+    // lowest earlier dip.
+    numPyinCandidates = 0;
+    
+    const int minTau = jmax(2, static_cast<int>(rate / 800.0));
+    const int maxTau = jmin(static_cast<int>(rate / 50.0), bufferLength - 2);
+    float lowestDip = 2.0f; // Above every threshold
+    
+    auto thresholdCDF = [this](float value)
+    {
+        return pyinThresholdCDF[static_cast<size_t>(jlimit(0, 100, static_cast<int>(value * 100.0f)))];
+    };
+    
+    for (int tau = minTau; tau <= maxTau && numPyinCandidates < static_cast<int>(pyinCandidates.size()); ++tau)
+    {
+        float value = yinBuffer[tau];
+        
+        if (value >= lowestDip || value >= yinBuffer[tau - 1] || value > yinBuffer[tau + 1])
+            continue;
+        
+        float probability = thresholdCDF(lowestDip) - thresholdCDF(value);
+        lowestDip = value;
+        
+        if (probability <= 0.0f)
+            continue;
+        
+        float s0 = yinBuffer[tau - 1];
+        float s2 = yinBuffer[tau + 1];
+        float denominator = 2.0f * (2.0f * value - s2 - s0);
+        float betterTau = std::abs(denominator) > 1e-9f ? tau + (s2 - s0) / denominator : static_cast<float>(tau);
+        
+        pyinCandidates[static_cast<size_t>(numPyinCandidates++)] = { static_cast<float>(rate / betterTau), probability };
+    }
+}
+
+float PitchCorrectionEngine::trackPitchCandidates()
+{
+    auto& tracker = pyinTracker;
+    
+    auto binForFrequency = [](float frequency)
+    {
+        return roundToInt(1200.0f * std::log2(frequency / pyinMinFrequency) / pyinBinCents);
+    };
+    
+    float voicedMass = 0.0f;
+    for (int i = 0; i < numPyinCandidates; ++i)
+    {
+        const auto& candidate = pyinCandidates[static_cast<size_t>(i)];
+        int bin = binForFrequency(candidate.frequency);
+        
+        if (bin >= 0 && bin < pyinNumBins)
+        {
+            tracker.observation[bin] += candidate.probability;
+            voicedMass += candidate.probability;
+        }
+    }
+    
+    voicedMass = jmin(voicedMass, 1.0f);
+    const float unvoicedObservation = (1.0f - voicedMass) / pyinNumBins;
+    const float stayProbability = 1.0f - pyinVoicingSwitchProbability;
+    
+    // One max-product Viterbi step over voiced/unvoiced copies of each pitch bin
+    float total = 0.0f;
+    for (int bin = 0; bin < pyinNumBins; ++bin)
+    {
+        float bestVoiced = 0.0f;
+        float bestUnvoiced = 0.0f;
+        const int firstBin = jmax(0, bin - pyinMaxJump);
+        const int lastBin = jmin(pyinNumBins - 1, bin + pyinMaxJump);
+        
+        for (int from = firstBin; from <= lastBin; ++from)
+        {
+            float weight = tracker.transition[from - bin + pyinMaxJump];
+            float fromVoiced = tracker.voicedScore[from] * weight;
+            float fromUnvoiced = tracker.unvoicedScore[from] * weight;
+            
+            bestVoiced = jmax(bestVoiced, fromVoiced * stayProbability, fromUnvoiced * pyinVoicingSwitchProbability);
+            bestUnvoiced = jmax(bestUnvoiced, fromUnvoiced * stayProbability, fromVoiced * pyinVoicingSwitchProbability);
+        }
+        
+        tracker.nextVoicedScore[bin] = bestVoiced * tracker.observation[bin];
+        tracker.nextUnvoicedScore[bin] = bestUnvoiced * unvoicedObservation;
+        total += tracker.nextVoicedScore[bin] + tracker.nextUnvoicedScore[bin];
+    }
+    
+    // Only the bins this hop touched need clearing
+    for (int i = 0; i < numPyinCandidates; ++i)
+    {
+        int bin = binForFrequency(pyinCandidates[static_cast<size_t>(i)].frequency);
+        if (bin >= 0 && bin < pyinNumBins)
+            tracker.observation[bin] = 0.0f;
+    }
+    
+    if (total <= 0.0f)
+    {
+        resetPitchTracker();
+        pitchConfidence = 0.0f;
+        return 0.0f;
+    }
+    
+    // Normalise so the scores never underflow, and take the best end state
+    std::swap(tracker.voicedScore, tracker.nextVoicedScore);
+    std::swap(tracker.unvoicedScore, tracker.nextUnvoicedScore);
+    
+    int bestBin = 0;
+    float bestScore = -1.0f;
+    bool bestIsVoiced = false;
+    
+    for (int bin = 0; bin < pyinNumBins; ++bin)
+    {
+        tracker.voicedScore[bin] /= total;
+        tracker.unvoicedScore[bin] /= total;
+        
+        if (tracker.voicedScore[bin] > bestScore)
+        {
+            bestScore = tracker.voicedScore[bin];
+            bestBin = bin;
+            bestIsVoiced = true;
+        }
+        
+        if (tracker.unvoicedScore[bin] > bestScore)
+        {
+            bestScore = tracker.unvoicedScore[bin];
+            bestBin = bin;
+            bestIsVoiced = false;
+        }
+    }
+    
+    if (!bestIsVoiced)
+    {
+        pitchConfidence = 0.0f;
+        return 0.0f;
+    }
+    
+    // Report the strongest candidate in the chosen bin rather than the bin centre
+    float trackedPitch = pyinMinFrequency * std::exp2(bestBin * pyinBinCents / 1200.0f);
+    float strongest = 0.0f;
+    
+    for (int i = 0; i < numPyinCandidates; ++i)
+    {
+        const auto& candidate = pyinCandidates[static_cast<size_t>(i)];
+        if (std::abs(binForFrequency(candidate.frequency) - bestBin) <= 1 && candidate.probability > strongest)
+        {
+            strongest = candidate.probability;
+            trackedPitch = candidate.frequency;
+        }
+    }
+    
+    pitchConfidence = voicedMass;
+    return trackedPitch;
+}
+
+void PitchCorrectionEngine::resetPitchTracker()
+{
+    const float uniform = 0.5f / pyinNumBins;
+    std::fill(pyinTracker.voicedScore.begin(), pyinTracker.voicedScore.end(), uniform);
+    std::fill(pyinTracker.unvoicedScore.begin(), pyinTracker.unvoicedScore.end(), uniform);
+    std::fill(pyinTracker.observation.begin(), pyinTracker.observation.end(), 0.0f);
+    numPyinCandidates = 0;
+}
+
+float PitchCorrectionEngine::detectPitchSpectral(const float* buffer, int numSamples)
+{
+    detectorConfidence.spectral = 0.0f;
+    analyzeSpectrum(buffer, numSamples);
+    if (!analysisFrame.valid) return 0.0f;
+    
+    const auto& magnitudeSpectrum = analysisFrame.magnitude;
+    const int numBins = static_cast<int>(magnitudeSpectrum.size());
+    
+    // Find peak in magnitude spectrum
+    float maxMag = 0.0f;
+    int peakBin = 0;
+    int minBin = static_cast<int>(50.0f * fftSize / sampleRate); // 50Hz minimum
+    int maxBin = static_cast<int>(800.0f * fftSize / sampleRate); // 800Hz maximum
+    
+    for (int i = minBin; i < maxBin && i < numBins; ++i)
+    {
+        if (magnitudeSpectrum[i] > maxMag)
+        {
+            maxMag = magnitudeSpectrum[i];
+            peakBin = i;
+        }
+    }
+    
+    if (peakBin > 0 && maxMag > 0.01f)
+    {
+        // Confidence: share of the 50-800Hz energy within two bins of the peak
+        float bandEnergy = DSPKernels::sumOfSquares(&magnitudeSpectrum[minBin], jmin(maxBin, numBins) - minBin);
+        int peakStart = jmax(minBin, peakBin - 2);
+        float peakEnergy = DSPKernels::sumOfSquares(&magnitudeSpectrum[peakStart], jmin(peakBin + 3, maxBin, numBins) - peakStart);
+        detectorConfidence.spectral = bandEnergy > 0.0f ? peakEnergy / bandEnergy : 0.0f;
+        
+        // Parabolic interpolation for better frequency resolution
+        if (peakBin > 1 && peakBin < numBins - 1)
+        {
+            float y1 = magnitudeSpectrum[peakBin - 1];
+            float y2 = magnitudeSpectrum[peakBin];
+            float y3 = magnitudeSpectrum[peakBin + 1];
+            
+            float curvature = y1 - 2*y2 + y3;
+            if (std::abs(curvature) > 1e-6f)
+            {
+                float peak = 0.5f * (y1 - y3) / curvature;
+                float trueBin = peakBin + peak;
+                return static_cast<float>(trueBin * sampleRate / fftSize);
+            }
+        }
+        
+        return static_cast<float>(peakBin * sampleRate / fftSize);
+    }
+    
+    return 0.0f;
+}
+
+float PitchCorrectionEngine::detectPitchHarmonic(const float* buffer, int numSamples)
+{
+    // Harmonic product spectrum method, evaluated as a sum of log magnitudes
+    detectorConfidence.harmonic = 0.0f;
+    analyzeSpectrum(buffer, numSamples);
+    if (!analysisFrame.valid) return 0.0f;
+    
+    const auto& logMagnitude = analysisFrame.logMagnitude;
+    const size_t numBins = logMagnitude.size();
+    std::copy(logMagnitude.begin(), logMagnitude.end(), hpsBuffer.begin());
+    
+    // Add the decimated log spectra (multiplying the magnitudes)
+    const int maxHarmonics = 5;
+    for (int harmonic = 2; harmonic <= maxHarmonics; ++harmonic)
+    {
+        for (size_t i = 0; i < numBins / harmonic; ++i)
+        {
+            hpsBuffer[i] += logMagnitude[i * harmonic];
+        }
+    }
+    
+    // Find peak in HPS
+    float maxValue = -std::numeric_limits<float>::max();
+    int peakBin = 0;
+    int minBin = static_cast<int>(50.0f * fftSize / sampleRate);
+    int maxBin = static_cast<int>(800.0f * fftSize / sampleRate);
+    
+    for (int i = jmax(1, minBin); i < maxBin && i < static_cast<int>(numBins); ++i)
+    {
+        if (hpsBuffer[i] > maxValue)
+        {
+            maxValue = hpsBuffer[i];
+            peakBin = i;
+        }
+    }
+    
+    if (peakBin > 0)
+    {
+        // Confidence from how far the peak stands above the band average, per harmonic
+        const int firstBin = jmax(1, minBin);
+        const int lastBin = jmin(maxBin, static_cast<int>(numBins));
+        float bandMean = DSPKernels::sum(&hpsBuffer[firstBin], lastBin - firstBin) / jmax(1, lastBin - firstBin);
+        detectorConfidence.harmonic = 1.0f - std::exp(-jmax(0.0f, maxValue - bandMean) / maxHarmonics);
+        
+        return static_cast<float>(peakBin * sampleRate / fftSize);
+    }
+    
+    return 0.0f;
+}
+
+void PitchCorrectionEngine::analyzeSpectrum(const float* buffer, int numSamples)
+{
+    // Window, FFT, magnitude, log-magnitude, centroid and formants are computed
+    // once per hop; later callers within the same hop reuse the cached frame
+    if (analysisFrame.hopIndex == analysisHopCounter)
+        return;
+    
+    analysisFrame.hopIndex = analysisHopCounter;
+    analysisFrame.valid = false;
+    
+    // Frames shorter than half the FFT are too coarse for 50Hz resolution
+    if (numSamples < fftSize / 2)
+        return;
+    
+    transformAnalysisWindow(buffer, numSamples);
+    
+    // Later FFTs in this hop reuse frequencyData, so the bins are kept with the frame
+    std::copy(frequencyData.getData(), frequencyData.getData() + fftSize / 2 + 1, analysisFrame.bins.begin());
+    
+    // Calculate magnitude and log-magnitude spectra
+    auto& magnitude = analysisFrame.magnitude;
+    auto& logMagnitude = analysisFrame.logMagnitude;
+    
+    for (int i = 0; i < fftSize / 2; ++i)
+    {
+        magnitude[i] = std::abs(frequencyData[i]);
+        logMagnitude[i] = std::log(magnitude[i] + 1.0e-9f);
+    }
+    
+    analysisFrame.spectralCentroid = calculateCentroid(magnitude);
+    computeSpectralEnvelope(magnitude.data(), fftSize / 2, analysisFrame.logEnvelope.data());
+    detectFormants(analysisFrame.logEnvelope);
+    analysisFrame.valid = true;
+}
+
+void PitchCorrectionEngine::transformAnalysisWindow(const float* buffer, int numSamples)
+{
+    // Prepare FFT input (zero-padded when the frame is shorter than the FFT)
+    int analysisSize = std::min(numSamples, fftSize);
+    std::fill(windowedBuffer.begin(), windowedBuffer.end(), 0.0f);
+    std::copy(buffer, buffer + analysisSize, windowedBuffer.begin());
+    
+    // Apply window
+    if (analysisSize == fftSize)
+        window->multiplyWithWindowingTable(windowedBuffer.data(), fftSize);
+    else
+        applyHannWindow(windowedBuffer.data(), analysisSize);
+    
+    // Convert to complex and perform FFT
+    for (int i = 0; i < fftSize; ++i)
+    {
+        fftWorkspace[i] = dsp::Complex<float>(windowedBuffer[i], 0.0f);
+    }
+    
+    fft->perform(fftWorkspace, frequencyData, false);
+}
+
+void PitchCorrectionEngine::computeSpectralEnvelope(const float* magnitude, int numBins, float* logEnvelope)
+{
+    // Each grid point takes the loudest bin within half a harmonic spacing, so the curve runs
+    // through the harmonics' peaks. Sampling the valleys between them too (the grid is
+    // coarser than the harmonics of most voices) aliases the harmonic ripple into the short
+    // cepstrum, where the lifter below cannot remove it.
+    const float pitch = currentPitch > 0.0f ? currentPitch : envelopeFallbackPitch;
+    const int reach = jmax(2, roundToInt(0.5f * pitch * fftSize / static_cast<float>(sampleRate)));
+    
+    for (int j = 0; j < envelopeSize; ++j)
+    {
+        const int centre = j * envelopeDecimation;
+        float loudest = 0.0f;
+        
+        for (int k = jmax(0, centre - reach); k <= jmin(numBins - 1, centre + reach); ++k)
+            loudest = jmax(loudest, magnitude[k]);
+        
+        // An even sequence, so the cepstrum is real
+        const float logMagnitude = std::log(loudest + 1.0e-9f);
+        envelopeWorkspace[j] = { logMagnitude, 0.0f };
+        if (j > 0 && j < envelopeFFTSize / 2)
+            envelopeWorkspace[envelopeFFTSize - j] = { logMagnitude, 0.0f };
+    }
+    
+    decimatedFFT->perform(envelopeWorkspace, envelopeCepstrum, true);
+    
+    // Everything below the pitch period is envelope; the first rahmonic sits at the period
+    const float cutoff = jlimit(16.0f, envelopeFFTSize * 0.5f - 1.0f, static_cast<float>(sampleRate / pitch));
+    
+    for (int q = 1; q < envelopeFFTSize / 2; ++q)
+    {
+        const float lifter = q < cutoff ? 0.5f * (1.0f + std::cos(MathConstants<float>::pi * q / cutoff)) : 0.0f;
+        envelopeCepstrum[q] *= lifter;
+        envelopeCepstrum[envelopeFFTSize - q] *= lifter;
+    }
+    envelopeCepstrum[envelopeFFTSize / 2] = {};
+    
+    decimatedFFT->perform(envelopeCepstrum, envelopeWorkspace, false);
+    
+    for (int j = 0; j < envelopeSize; ++j)
+        logEnvelope[j] = envelopeWorkspace[j].real();
+}
+
+float PitchCorrectionEngine::getEnvelopeAt(const float* logEnvelope, float bin) const
+{
+    // Linear between grid points; beyond Nyquist the top of the envelope holds
+    const float position = jlimit(0.0f, static_cast<float>(envelopeSize - 1), bin / envelopeDecimation);
+    const int index = jmin(static_cast<int>(position), envelopeSize - 2);
+    const float fraction = position - index;
+    
+    return logEnvelope[index] + fraction * (logEnvelope[index + 1] - logEnvelope[index]);
+}
+
+void PitchCorrectionEngine::detectFormants(const std::vector<float>& logEnvelope)
+{
+    // Formants are the peaks of the smoothed envelope, not of the harmonics
+    std::fill(formantFrequencies.begin(), formantFrequencies.end(), 0.0f);
+    std::fill(formantAmplitudes.begin(), formantAmplitudes.end(), 0.0f);
+    
+    auto& peaks = formantPeakCandidates;
+    peaks.clear();
+    
+    const double gridFrequency = sampleRate * envelopeDecimation / fftSize;
+    
+    for (int j = 1; j < static_cast<int>(logEnvelope.size()) - 1; ++j)
+    {
+        const double freq = j * gridFrequency;
+        if (freq > 200.0 && freq < 4000.0 // Typical formant range
+            && logEnvelope[j] > logEnvelope[j - 1] && logEnvelope[j] >= logEnvelope[j + 1]
+            && peaks.size() < peaks.capacity())
+        {
+            peaks.push_back({ logEnvelope[j], j });
+        }
+    }
+    
+    // Keep only the strongest peaks
+    const size_t numFormants = std::min(static_cast<size_t>(maxFormants), peaks.size());
+    std::partial_sort(peaks.begin(), peaks.begin() + static_cast<std::ptrdiff_t>(numFormants), peaks.end(),
+                      std::greater<std::pair<float, int>>());
+    
+    for (size_t i = 0; i < numFormants; ++i)
+    {
+        // Parabolic interpolation between the grid points
+        const int j = peaks[i].second;
+        const float left = logEnvelope[j - 1], centre = logEnvelope[j], right = logEnvelope[j + 1];
+        const float curvature = left - 2.0f * centre + right;
+        const float offset = curvature < 0.0f ? 0.5f * (left - right) / curvature : 0.0f;
+        
+        formantAmplitudes[i] = std::exp(centre - 0.25f * (left - right) * offset);
+        formantFrequencies[i] = static_cast<float>((j + offset) * gridFrequency);
+    }
+}
+
+void PitchCorrectionEngine::process(const float* input, float* output, int numSamples, const float* ratioCurve)
+{
+    if (shifterDelayLine.empty()) return;
+    
+    spectralShiftActive = false;
+    
+    const float grainLength = static_cast<float>(grainSize);
+    const float settleStep = shifterSettleRate / grainLength;
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        // Written before reading so input and output may alias
+        shifterDelayLine[static_cast<size_t>(shifterWritePos)] = input[i];
+        shifterDelayLine[static_cast<size_t>(shifterWritePos + shifterDelayMask + 1)] = input[i];
+        
+        const float ratio = jlimit(shifterMinRatio, shifterMaxRatio, ratioCurve[i]);
+        
+        if (ratio != 1.0f)
+        {
+            // Raising the pitch shortens the delay, lowering it lengthens the delay
+            shifterPhase += (1.0f - ratio) / grainLength;
+            shifterPhase -= std::floor(shifterPhase);
+        }
+        else
+        {
+            // Drift towards a single tap at the nominal delay so bypass is a clean delay
+            const float settled = std::round(shifterPhase * 2.0f) * 0.5f;
+            shifterPhase += jlimit(-settleStep, settleStep, settled - shifterPhase);
+            if (shifterPhase >= 1.0f) shifterPhase -= 1.0f;
+        }
+        
+        float otherPhase = shifterPhase + 0.5f;
+        if (otherPhase >= 1.0f) otherPhase -= 1.0f;
+        
+        // Each tap jumps back a grain exactly where its window is zero
+        const float window = std::sin(MathConstants<float>::pi * shifterPhase);
+        const float gain = window * window;
+        
+        output[i] = gain * readDelayLine(shifterMinDelay + shifterPhase * grainLength)
+                  + (1.0f - gain) * readDelayLine(shifterMinDelay + otherPhase * grainLength);
+        
+        shifterWritePos = (shifterWritePos + 1) & shifterDelayMask;
+    }
+}
+
+float PitchCorrectionEngine::readDelayLine(float delay) const
+{
+    const float readPosition = static_cast<float>(shifterWritePos) - delay;
+    const float floorPosition = std::floor(readPosition);
+    const float fraction = readPosition - floorPosition;
+    const int index = static_cast<int>(floorPosition);
+    
+    const int firstTap = (index - interpolator.getFirstTapOffset()) & shifterDelayMask;
+    return interpolator.interpolate(&shifterDelayLine[static_cast<size_t>(firstTap)], fraction);
+}
+
+void PitchCorrectionEngine::process(const float* input, float* output, int numSamples,
+                                    const float* ratioCurve, const float* pitchCurve)
+{
+    if (psolaInput.empty()) return;
+    
+    spectralShiftActive = false;
+    
+    for (int i = 0; i < numSamples; ++i)
+    {
+        psolaInput[static_cast<size_t>(psolaSampleCount & psolaMask)] = input[i];
+        ++psolaSampleCount;
+        
+        const float period = pitchCurve[i] > 0.0f
+            ? jlimit(2.0f, static_cast<float>(psolaMaxPeriod), static_cast<float>(sampleRate) / pitchCurve[i])
+            : 0.0f;
+        
+        extractGrains(period);
+        synthesizeGrains(jlimit(shifterMinRatio, shifterMaxRatio, ratioCurve[i]), period);
+        
+        // Every grain touching this position has been added by now
+        auto& accumulated = psolaOutput[static_cast<size_t>((psolaSampleCount - 1 - shifterLatency) & psolaMask)];
+        output[i] = accumulated;
+        accumulated = 0.0f;
+    }
+}
+
+void PitchCorrectionEngine::processShifterEngine(const float* input, float* output, int numSamples,
+                                                 const float* ratioCurve, const float* pitchCurve)
+{
+    if (shifterInputCopy.empty()) return;
+    
+    // The scratch buffers hold one prepared block
+    const int chunkSize = static_cast<int>(shifterInputCopy.size());
+    
+    for (int position = 0; position < numSamples; position += chunkSize)
+    {
+        const int chunk = jmin(chunkSize, numSamples - position);
+        processShifterEngineChunk(input + position, output + position, chunk,
+                                  ratioCurve + position, pitchCurve + position);
+    }
 }
 
-float PitchCorrectionEngine::detectPitchYIN(const float* buffer, int numSamples)
+void PitchCorrectionEngine::processShifterEngineChunk(const float* input, float* output, int numSamples,
+                                                      const float* ratioCurve, const float* pitchCurve)
 {
-    // Simplified YIN algorithm implementation
-    if (numSamples < 128) return 0.0f;
-    
-    int bufferSize = std::min(numSamples, 2048);
-    std::vector<float> yinBuffer(static_cast<size_t>(bufferSize) / 2, 0.0f);
-    
-    // Step 1: Difference function
-    for (int tau = 1; tau < bufferSize / 2; ++tau)
+    if (!shifterEngineStarted)
     {
-        for (int i = 0; i < bufferSize / 2; ++i)
-        {
-            float delta = buffer[i] - buffer[i + tau];
-            yinBuffer[tau] += delta * delta;
-        }
+        activeShifterEngine = requestedShifterEngine;
+        shifterEngineStarted = true;
     }
     
-    // Step 2: Cumulative mean normalized difference
-    yinBuffer[0] = 1.0f;
-    float runningSum = 0.0f;
-    for (int tau = 1; tau < bufferSize / 2; ++tau)
+    // A new request only retargets a transition that has not started fading yet
+    if (!shifterTransitionActive && requestedShifterEngine != activeShifterEngine)
     {
-        runningSum += yinBuffer[tau];
-        if (runningSum > 0.0f)
-        {
-            yinBuffer[tau] *= tau / runningSum;
-        }
-        else
-        {
-            yinBuffer[tau] = 1.0f;
-        }
+        shifterTransitionActive = true;
+        shifterFadePosition = 0;
+        incomingShifterEngine = requestedShifterEngine;
+        shifterWarmupRemaining = shifterEngineLatency + getShifterEngineOwnLatency(incomingShifterEngine);
+    }
+    else if (shifterTransitionActive && shifterFadePosition == 0 && requestedShifterEngine != incomingShifterEngine)
+    {
+        shifterTransitionActive = requestedShifterEngine != activeShifterEngine;
+        incomingShifterEngine = requestedShifterEngine;
+        shifterWarmupRemaining = shifterEngineLatency + getShifterEngineOwnLatency(incomingShifterEngine);
     }
     
-    // Step 3: Absolute threshold
-    const float threshold = 0.1f;
-    int minTau = static_cast<int>(sampleRate / 800.0);
-    int maxTau = static_cast<int>(sampleRate / 50.0);
+    const bool vocoderWasRunning = phaseVocoderRunning;
+    phaseVocoderRunning = false;
     
-    for (int tau = minTau; tau < maxTau && tau < yinBuffer.size(); ++tau)
+    if (!shifterTransitionActive)
     {
-        if (yinBuffer[tau] < threshold)
+        runShifterEngine(activeShifterEngine, input, output, numSamples, ratioCurve, pitchCurve);
+    }
+    else
+    {
+        // Both engines read the same input, which output may overwrite
+        std::copy(input, input + numSamples, shifterInputCopy.begin());
+        
+        // The phase vocoder goes last: the other engines mark its frame history stale
+        const bool incomingFirst = activeShifterEngine == ModeSelector::ShifterEngine::PhaseVocoder;
+        
+        if (incomingFirst)
+            runShifterEngine(incomingShifterEngine, shifterInputCopy.data(), shifterIncomingOutput.data(),
+                             numSamples, ratioCurve, pitchCurve);
+        
+        spectralShiftActive = vocoderWasRunning;
+        runShifterEngine(activeShifterEngine, shifterInputCopy.data(), output, numSamples, ratioCurve, pitchCurve);
+        
+        if (!incomingFirst)
         {
-            // Step 4: Parabolic interpolation
-            while (tau + 1 < yinBuffer.size() && yinBuffer[tau + 1] < yinBuffer[tau])
+            spectralShiftActive = vocoderWasRunning;
+            runShifterEngine(incomingShifterEngine, shifterInputCopy.data(), shifterIncomingOutput.data(),
+                             numSamples, ratioCurve, pitchCurve);
+        }
+        
+        // Outputs are time-aligned, so a linear crossfade over one prepared block is seamless
+        const int fadeLength = static_cast<int>(shifterInputCopy.size());
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            if (shifterWarmupRemaining > 0)
             {
-                tau++;
+                --shifterWarmupRemaining;
             }
-            
-            // Interpolation
-            if (tau > 0 && tau < yinBuffer.size() - 1)
+            else if (shifterTransitionActive)
             {
-                float s0 = yinBuffer[tau - 1];
-                float s1 = yinBuffer[tau];
-                float s2 = yinBuffer[tau + 1];
+                const float gain = static_cast<float>(++shifterFadePosition) / fadeLength;
+                output[i] += (shifterIncomingOutput[static_cast<size_t>(i)] - output[i]) * gain;
                 
-                float betterTau = tau + (s2 - s0) / (2.0f * (2.0f * s1 - s2 - s0));
-                return static_cast<float>(sampleRate / betterTau);
+                if (shifterFadePosition >= fadeLength)
+                {
+                    shifterTransitionActive = false;
+                    activeShifterEngine = incomingShifterEngine;
+                }
+            }
+            else
+            {
+                output[i] = shifterIncomingOutput[static_cast<size_t>(i)];
             }
-            
-            return static_cast<float>(sampleRate / tau);
         }
     }
-    
-    return 0.0f;
 }
 
-float PitchCorrectionEngine::detectPitchSpectral(const float* buffer, int numSamples)
+void PitchCorrectionEngine::runShifterEngine(ModeSelector::ShifterEngine engine, const float* input, float* output,
+                                             int numSamples, const float* ratioCurve, const float* pitchCurve)
 {
-    if (numSamples < fftSize) return 0.0f;
+    using Engine = ModeSelector::ShifterEngine;
     
-    // Prepare FFT input
-    std::fill(windowedBuffer.begin(), windowedBuffer.end(), 0.0f);
-    std::copy(buffer, buffer + std::min(numSamples, fftSize), windowedBuffer.begin());
+    switch (engine)
+    {
+        case Engine::PSOLA:
+            process(input, output, numSamples, ratioCurve, pitchCurve);
+            break;
+            
+#ifdef USE_RUBBERBAND
+        case Engine::RubberBandR2:
+            spectralShiftActive = false;
+            rubberBandFaster.process(input, output, numSamples, ratioCurve);
+            break;
+            
+        case Engine::RubberBandR3Short:
+            spectralShiftActive = false;
+            rubberBandFinerShort.process(input, output, numSamples, ratioCurve);
+            break;
+            
+        case Engine::RubberBandR3:
+            spectralShiftActive = false;
+            rubberBandFiner.process(input, output, numSamples, ratioCurve);
+            break;
+#endif
+            
+        case Engine::PhaseVocoder:
+        default:
+            processSpectral(input, output, numSamples, ratioCurve);
+            phaseVocoderRunning = true;
+            break;
+    }
     
-    // Apply window
-    window->multiplyWithWindowingTable(windowedBuffer.data(), fftSize);
+    // Pad to the common latency
+    const auto index = static_cast<size_t>(engine);
+    const int delay = shifterAlignmentDelays[index];
     
-    // Convert to complex and perform FFT
-    for (int i = 0; i < fftSize; ++i)
+    if (delay > 0)
     {
-        frequencyData[i] = dsp::Complex<float>(windowedBuffer[i], 0.0f);
+        auto& ring = shifterAlignmentRings[index];
+        const int mask = static_cast<int>(ring.size()) - 1;
+        int writePos = shifterAlignmentWritePos[index];
+        
+        for (int i = 0; i < numSamples; ++i)
+        {
+            ring[static_cast<size_t>(writePos)] = output[i];
+            output[i] = ring[static_cast<size_t>((writePos - delay) & mask)];
+            writePos = (writePos + 1) & mask;
+        }
+        
+        shifterAlignmentWritePos[index] = writePos;
     }
+}
+
+int PitchCorrectionEngine::getShifterEngineOwnLatency(ModeSelector::ShifterEngine engine) const
+{
+    using Engine = ModeSelector::ShifterEngine;
     
-    fft->perform(frequencyData, frequencyData, false);
-    
-    // Calculate magnitude spectrum
-    for (int i = 0; i < fftSize / 2; ++i)
+    switch (engine)
+    {
+        case Engine::PSOLA:             return getLatencySamples();
+#ifdef USE_RUBBERBAND
+        case Engine::RubberBandR2:      return rubberBandFaster.getLatencySamples();
+        case Engine::RubberBandR3Short: return rubberBandFinerShort.getLatencySamples();
+        case Engine::RubberBandR3:      return rubberBandFiner.getLatencySamples();
+#else
+        case Engine::RubberBandR2:
+        case Engine::RubberBandR3Short:
+        case Engine::RubberBandR3:
+#endif
+        case Engine::PhaseVocoder:
+        default:                        return getSpectralLatencySamples();
+    }
+}
+
+void PitchCorrectionEngine::extractGrains(float period)
+{
+    if (period <= 0.0f)
     {
-        magnitudeSpectrum[i] = std::abs(frequencyData[i]);
+        // Unvoiced: drop the epochs so the next onset starts from fresh grains
+        if (lastPitchMark >= 0)
+            for (auto& grain : grainBuffer)
+                grain.position = -1;
+        
+        lastPitchMark = -1;
+        return;
     }
     
-    // Find peak in magnitude spectrum
-    float maxMag = 0.0f;
-    int peakBin = 0;
-    int minBin = static_cast<int>(50.0f * fftSize / sampleRate); // 50Hz minimum
-    int maxBin = static_cast<int>(800.0f * fftSize / sampleRate); // 800Hz maximum
+    const int halfLength = roundToInt(period);
+    const int64 newest = psolaSampleCount - 1;
     
-    for (int i = minBin; i < maxBin && i < magnitudeSpectrum.size(); ++i)
+    // Marks are only placed once the grain around them is complete
+    if (lastPitchMark < 0 || newest - lastPitchMark > 3 * static_cast<int64>(psolaMaxPeriod))
     {
-        if (magnitudeSpectrum[i] > maxMag)
-        {
-            maxMag = magnitudeSpectrum[i];
-            peakBin = i;
-        }
+        // Onset: strongest peak within the last complete period
+        lastPitchMark = findPitchMark(newest - 2 * halfLength, newest - halfLength);
     }
-    
-    if (peakBin > 0 && maxMag > 0.01f)
+    else
     {
-        // Parabolic interpolation for better frequency resolution
-        if (peakBin > 1 && peakBin < magnitudeSpectrum.size() - 1)
-        {
-            float y1 = magnitudeSpectrum[peakBin - 1];
-            float y2 = magnitudeSpectrum[peakBin];
-            float y3 = magnitudeSpectrum[peakBin + 1];
-            
-            float a = (y1 - 2*y2 + y3) / 2.0f;
-            if (std::abs(a) > 1e-6f)
-            {
-                float peak = -0.5f * (y3 - y1) / a;
-                float trueBin = peakBin + peak;
-                return static_cast<float>(trueBin * sampleRate / fftSize);
-            }
-        }
+        // Next epoch: strongest peak within a quarter period of the expected one
+        const int64 expected = lastPitchMark + halfLength;
+        const int tolerance = jmax(1, halfLength / 4);
         
-        return static_cast<float>(peakBin * sampleRate / fftSize);
+        if (newest < expected + tolerance + halfLength)
+            return;
+        
+        lastPitchMark = findPitchMark(expected - tolerance, expected + tolerance);
     }
     
-    return 0.0f;
+    auto& grain = grainBuffer[static_cast<size_t>(nextGrainSlot)];
+    nextGrainSlot = (nextGrainSlot + 1) % psolaPoolSize;
+    cutGrain(grain, lastPitchMark, halfLength);
 }
 
-float PitchCorrectionEngine::detectPitchHarmonic(const float* buffer, int numSamples)
+int64 PitchCorrectionEngine::findPitchMark(int64 start, int64 end) const
 {
-    // Harmonic product spectrum method
-    if (numSamples < fftSize) return 0.0f;
-    
-    // Use existing spectrum from spectral method
-    analyzeSpectrum(buffer, numSamples);
-    
-    std::vector<float> hps(magnitudeSpectrum.size());
-    std::copy(magnitudeSpectrum.begin(), magnitudeSpectrum.end(), hps.begin());
+    int64 mark = start;
+    float peak = psolaInput[static_cast<size_t>(start & psolaMask)];
     
-    // Multiply spectrum with its decimated versions
-    const int maxHarmonics = 5;
-    for (int harmonic = 2; harmonic <= maxHarmonics; ++harmonic)
+    for (int64 position = start + 1; position <= end; ++position)
     {
-        for (size_t i = 0; i < hps.size() / harmonic; ++i)
+        const float value = psolaInput[static_cast<size_t>(position & psolaMask)];
+        if (value > peak)
         {
-            hps[i] *= magnitudeSpectrum[i * harmonic];
+            peak = value;
+            mark = position;
         }
     }
     
-    // Find peak in HPS
-    float maxValue = 0.0f;
-    int peakBin = 0;
-    int minBin = static_cast<int>(50.0f * fftSize / sampleRate);
-    int maxBin = static_cast<int>(800.0f * fftSize / sampleRate);
+    return mark;
+}
+
+void PitchCorrectionEngine::synthesizeGrains(float pitchRatio, float period)
+{
+    const int64 outputPosition = psolaSampleCount - 1 - shifterLatency;
+    const int unvoicedHalfLength = shifterLatency / 2;
     
-    for (int i = minBin; i < maxBin && i < hps.size(); ++i)
+    // At a ratio of exactly 1 voiced input takes the unvoiced path as well, a clean delay
+    const bool voiced = period > 0.0f && pitchRatio != 1.0f;
+    
+    for (;;)
     {
-        if (hps[i] > maxValue)
+        const double markFloor = std::floor(nextSynthesisMark);
+        const auto centre = static_cast<int64>(markFloor);
+        const GrainData* nearest = nullptr;
+        
+        if (voiced)
         {
-            maxValue = hps[i];
-            peakBin = i;
+            // Periods longer than the latency only have epochs well behind the mark,
+            // so any grain still in the pool is usable; the pool bounds its age
+            for (const auto& grain : grainBuffer)
+            {
+                if (grain.position >= 0
+                    && (nearest == nullptr || std::abs(grain.position - centre) < std::abs(nearest->position - centre)))
+                {
+                    nearest = &grain;
+                }
+            }
+        }
+        
+        // Unvoiced or no epoch yet: a grain cut right at the (whole-sample) synthesis mark
+        const int cutHalfLength = voiced ? jmin(roundToInt(period), unvoicedHalfLength) : unvoicedHalfLength;
+        const int halfLength = nearest != nullptr ? nearest->halfLength : cutHalfLength;
+        
+        if (centre - halfLength > outputPosition)
+            break;
+        
+        // A grain starting on samples already output would begin with a step: at start-up,
+        // after a long unvoiced grain, or when the grain gets longer (voicing changes, a
+        // lower note). Move the mark up so the grain starts at the read position.
+        if (centre - halfLength < outputPosition)
+        {
+            nextSynthesisMark = static_cast<double>(outputPosition + halfLength);
+            continue;
+        }
+        
+        if (nearest != nullptr)
+        {
+            // Voiced: the epoch's grain, respaced to the target period
+            applyGrain(*nearest, centre, static_cast<float>(nextSynthesisMark - markFloor), outputPosition);
+            nextSynthesisMark += period / pitchRatio;
+        }
+        else
+        {
+            cutGrain(synthesisGrain, centre, cutHalfLength);
+            applyGrain(synthesisGrain, centre, 0.0f, outputPosition);
+            nextSynthesisMark = markFloor + cutHalfLength;
         }
     }
+}
+
+void PitchCorrectionEngine::cutGrain(GrainData& grain, int64 centre, int halfLength)
+{
+    const float windowStep = static_cast<float>(psolaWindowResolution) / (2 * halfLength);
+    float* samples = grain.grain.data() + psolaGrainPadding + halfLength;
     
-    if (peakBin > 0)
+    for (int j = -halfLength; j <= halfLength; ++j)
     {
-        return static_cast<float>(peakBin * sampleRate / fftSize);
+        const float sample = psolaInput[static_cast<size_t>((centre + j) & psolaMask)];
+        const auto windowIndex = static_cast<size_t>(roundToInt((j + halfLength) * windowStep));
+        samples[j] = sample * psolaWindow[windowIndex];
     }
     
-    return 0.0f;
+    // The leading padding is never written; clear what a longer grain left behind the end
+    std::fill(samples + halfLength + 1, samples + halfLength + 1 + psolaGrainPadding, 0.0f);
+    
+    grain.position = centre;
+    grain.halfLength = halfLength;
+    grain.pitch = static_cast<float>(sampleRate) / halfLength;
 }
 
-void PitchCorrectionEngine::analyzeSpectrum(const float* buffer, int numSamples)
+void PitchCorrectionEngine::applyGrain(const GrainData& grain, int64 centre, float fraction, int64 firstWritablePosition)
 {
-    // This would be called from detectPitchSpectral, so just ensure spectrum is available
-    detectPitchSpectral(buffer, numSamples);
-    detectFormants(magnitudeSpectrum);
+    const float* samples = grain.grain.data() + psolaGrainPadding + grain.halfLength;
+    
+    // Positions before the read position have already been output
+    const int first = static_cast<int>(std::max<int64>(-grain.halfLength, firstWritablePosition - centre));
+    
+    if (fraction <= 0.0f)
+    {
+        for (int j = first; j <= grain.halfLength; ++j)
+            psolaOutput[static_cast<size_t>((centre + j) & psolaMask)] += samples[j] * grain.amplitude;
+        
+        return;
+    }
+    
+    // Centred at centre + fraction: output j reads the grain at j - fraction, one sample
+    // past the whole-sample grain on the right
+    const float readFraction = 1.0f - fraction;
+    
+    for (int j = first; j <= grain.halfLength + 1; ++j)
+    {
+        const float value = interpolator.interpolate(samples + j - 1 - interpolator.getFirstTapOffset(), readFraction);
+        psolaOutput[static_cast<size_t>((centre + j) & psolaMask)] += value * grain.amplitude;
+    }
 }
 
-void PitchCorrectionEngine::detectFormants(const std::vector<float>& spectrum)
+void PitchCorrectionEngine::processSpectral(const float* input, float* output, int numSamples, const float* ratioCurve)
 {
-    // Simple formant detection using peak picking
-    std::fill(formantFrequencies.begin(), formantFrequencies.end(), 0.0f);
-    std::fill(formantAmplitudes.begin(), formantAmplitudes.end(), 0.0f);
+    if (spectralInput.empty()) return;
     
-    // Look for peaks in the spectrum
-    std::vector<std::pair<float, int>> peaks;
+    // Frames queued by the detector only describe this input if it analysed this very buffer
+    const bool useQueuedFrames = spectralShiftActive && lastAnalysisInput == input;
     
-    for (int i = 2; i < static_cast<int>(spectrum.size()) - 2; ++i)
+    if (!spectralShiftActive)
     {
-        float freq = static_cast<float>(i * sampleRate / fftSize);
-        if (freq > 200.0f && freq < 4000.0f) // Typical formant range
-        {
-            if (spectrum[i] > spectrum[i-1] && spectrum[i] > spectrum[i+1] &&
-                spectrum[i] > spectrum[i-2] && spectrum[i] > spectrum[i+2])
-            {
-                peaks.push_back({spectrum[i], i});
-            }
-        }
+        // Start clean, on the detector's sample grid (it has already consumed this block)
+        resetSpectralShift();
+        spectralSampleCount = lastAnalysisInput == input ? std::max<int64>(0, analysisSampleCount - numSamples) : 0;
     }
     
-    // Sort peaks by amplitude
-    std::sort(peaks.begin(), peaks.end(), std::greater<std::pair<float, int>>());
+    spectralShiftActive = true;
+    spectralFramesShared = lastAnalysisInput == input;
+    lastAnalysisInput = nullptr;
     
-    // Take the top formants
-    for (size_t i = 0; i < std::min(static_cast<size_t>(maxFormants), peaks.size()); ++i)
+    for (int i = 0; i < numSamples; ++i)
     {
-        formantAmplitudes[i] = peaks[i].first;
-        formantFrequencies[i] = static_cast<float>(peaks[i].second * sampleRate / fftSize);
+        spectralInput[static_cast<size_t>(spectralInputWritePos)] = input[i];
+        spectralInput[static_cast<size_t>(spectralInputWritePos + analysisWindowSize)] = input[i];
+        spectralInputWritePos = (spectralInputWritePos + 1) % analysisWindowSize;
+        ++spectralSampleCount;
+        
+        if (spectralSampleCount % spectralShiftHop == 0)
+            runSpectralShiftHop(jlimit(shifterMinRatio, shifterMaxRatio, ratioCurve[i]), useQueuedFrames);
+        
+        // Every frame covering this position has been added by now
+        auto& accumulated = spectralOutput[static_cast<size_t>((spectralSampleCount - analysisWindowSize) & (spectralOutputSize - 1))];
+        output[i] = accumulated;
+        accumulated = 0.0f;
     }
 }
 
-void PitchCorrectionEngine::correctPitch(float* buffer, int numSamples, 
-                                        float targetPitch, float speed, float amount)
+void PitchCorrectionEngine::queueSpectralFrame()
 {
-    if (currentPitch <= 0.0f || targetPitch <= 0.0f) return;
+    // Only a frame the detector already paid for; the vocoder transforms anything else itself
+    if (analysisFrame.hopIndex != analysisHopCounter || !analysisFrame.valid || spectralFrameQueue.empty())
+        return;
     
-    float pitchRatio = targetPitch / currentPitch;
-    float correction = (pitchRatio - 1.0f) * amount * 0.01f; // Scale amount
+    auto& frame = spectralFrameQueue[static_cast<size_t>(nextSpectralFrameSlot)];
+    nextSpectralFrameSlot = (nextSpectralFrameSlot + 1) % static_cast<int>(spectralFrameQueue.size());
     
-    // REAL PITCH SHIFTING using phase-locked granular synthesis
-    if (std::abs(pitchRatio - 1.0f) > 0.001f) // Only process if pitch change needed
+    std::copy(analysisFrame.bins.begin(), analysisFrame.bins.end(), frame.bins.begin());
+    std::copy(analysisFrame.logEnvelope.begin(), analysisFrame.logEnvelope.end(), frame.logEnvelope.begin());
+    frame.position = analysisSampleCount;
+}
+
+const PitchCorrectionEngine::SpectralFrame* PitchCorrectionEngine::findQueuedSpectralFrame(int64 position) const
+{
+    for (const auto& frame : spectralFrameQueue)
     {
-        applyGranularPitchShift(buffer, numSamples, pitchRatio, speed * 0.01f);
+        if (frame.position == position)
+            return &frame;
     }
+    
+    return nullptr;
 }
 
-void PitchCorrectionEngine::correctPitchHard(float* buffer, int numSamples, 
-                                            float targetPitch, float speed, float amount)
+void PitchCorrectionEngine::runSpectralShiftHop(float pitchRatio, bool useQueuedFrames)
 {
-    if (currentPitch <= 0.0f || targetPitch <= 0.0f) return;
+    const int numBins = fftSize / 2 + 1;
+    const SpectralFrame* queued = useQueuedFrames ? findQueuedSpectralFrame(spectralSampleCount) : nullptr;
+    
+    if (queued != nullptr)
+    {
+        // The detector's frame comes with its envelope
+        std::copy(queued->bins.begin(), queued->bins.end(), spectralBins.begin());
+        std::copy(queued->logEnvelope.begin(), queued->logEnvelope.end(), spectralLogEnvelope.begin());
+    }
+    else
+    {
+        transformAnalysisWindow(&spectralInput[static_cast<size_t>(spectralInputWritePos)], analysisWindowSize);
+        std::copy(frequencyData.getData(), frequencyData.getData() + numBins, spectralBins.begin());
+    }
     
-    float pitchRatio = targetPitch / currentPitch;
-    float correction = (pitchRatio - 1.0f) * amount * 0.01f;
+    // Builds the full shifted spectrum in fftWorkspace
+    shiftSpectralPeaks(pitchRatio, queued != nullptr);
+    fft->perform(fftWorkspace, frequencyData, true);
     
-    // HARD MODE: Instant pitch quantization with anti-aliasing
-    float hardSpeed = jmin(speed * 0.2f, 1.0f);
+    // The frame fills the first half of the FFT, so the time spread of the per-peak phase
+    // changes runs into the zero padding instead of wrapping onto the frame; the synthesis
+    // window (zero at both ends) then cuts it off with the frame
+    const int64 frameStart = spectralSampleCount - analysisWindowSize;
     
-    if (std::abs(pitchRatio - 1.0f) > 0.001f)
+    for (int i = 0; i < analysisWindowSize; ++i)
     {
-        applyHardPitchQuantization(buffer, numSamples, pitchRatio, hardSpeed);
+        spectralOutput[static_cast<size_t>((frameStart + i) & (spectralOutputSize - 1))]
+            += frequencyData[i].real() * spectralSynthesisWindow[static_cast<size_t>(i)];
     }
 }
 
-void PitchCorrectionEngine::correctPitchAI(float* buffer, int numSamples, 
-                                          float targetPitch, float speed, float amount)
+void PitchCorrectionEngine::shiftSpectralPeaks(float pitchRatio, bool envelopeKnown)
 {
-    // AI mode with formant preservation and natural correction
-    if (currentPitch <= 0.0f || targetPitch <= 0.0f) return;
+    const int numBins = fftSize / 2 + 1;
+    const float binFrequency = 2.0f * MathConstants<float>::pi / fftSize;  // Radians per sample
+    const float hop = static_cast<float>(spectralShiftHop);
+    const float frameCentre = (analysisWindowSize - 1) * 0.5f;
     
-    float pitchRatio = targetPitch / currentPitch;
-    
-    // Preserve formants during pitch shifting
-    preserveFormants(buffer, numSamples, pitchRatio);
+    auto wrapPhase = [](float phase)
+    {
+        return phase - MathConstants<float>::twoPi * std::round(phase / MathConstants<float>::twoPi);
+    };
     
-    // AI MODE: Advanced pitch correction with spectral analysis
+    float loudest = 0.0f;
+    float total = 0.0f;
+    float rising = 0.0f;
     
-    #ifdef USE_RUBBERBAND
-    // Use Rubber Band for professional pitch shifting
-    static RubberBand::RubberBandStretcher* aiStretcher = nullptr;
-    if (!aiStretcher) {
-        aiStretcher = new RubberBand::RubberBandStretcher(
-            sampleRate, 1,
-            RubberBand::RubberBandStretcher::OptionProcessRealTime |
-            RubberBand::RubberBandStretcher::OptionFormantPreserved |
-            RubberBand::RubberBandStretcher::OptionPitchHighQuality |
-            RubberBand::RubberBandStretcher::OptionEngineFiner  // R3 engine for setPitchScale()
-        );
+    for (int k = 0; k < numBins; ++k)
+    {
+        spectralMagnitude[k] = std::abs(spectralBins[k]);
+        loudest = jmax(loudest, spectralMagnitude[k]);
+        total += spectralMagnitude[k];
+        rising += jmax(0.0f, spectralMagnitude[k] - previousSpectralMagnitude[k]);
     }
     
-    aiStretcher->setPitchScale(pitchRatio);
-    aiStretcher->setFormantScale(1.0f); // Preserve formants
+    // Transient: start every peak again from its analysis phase
+    const bool transient = !spectralHistoryValid || rising > spectralTransientThreshold * total;
     
-    const float* input = buffer;
-    aiStretcher->process(&input, numSamples, false);
+    if (!envelopeKnown)
+        computeSpectralEnvelope(spectralMagnitude.data(), numBins, spectralLogEnvelope.data());
     
-    int available = aiStretcher->available();
-    if (available > 0) {
-        float* output = buffer;
-        aiStretcher->retrieve(&output, std::min(available, numSamples));
-    }
-    #else
-    // Fallback: enhanced spectral correction
-    float correction = (pitchRatio - 1.0f) * amount * 0.005f;
-    float naturalSpeed = speed * 0.002f; // Very smooth correction
+    spectralPeaks.clear();
     
-    for (int i = 0; i < numSamples; ++i)
+    for (int k = 2; k < numBins - 2; ++k)
     {
-        float smoothCorrection = interpolateValue(0.0f, correction, naturalSpeed);
-        buffer[i] *= (1.0f + smoothCorrection);
+        const float m = spectralMagnitude[k];
+        if (m > loudest * spectralPeakFloor
+            && m > spectralMagnitude[k - 1] && m >= spectralMagnitude[k + 1]
+            && m > spectralMagnitude[k - 2] && m >= spectralMagnitude[k + 2]
+            && spectralPeaks.size() < spectralPeaks.capacity())
+        {
+            // Instantaneous frequency from the phase advance since the previous frame
+            float frequency = k * binFrequency;
+            if (spectralHistoryValid)
+            {
+                const float advance = std::arg(spectralBins[k] * std::conj(previousSpectralBins[k]));
+                frequency += wrapPhase(advance - frequency * hop) / hop;
+            }
+            
+            spectralPeaks.push_back({ k, roundToInt(frequency * (pitchRatio - 1.0f) / binFrequency), frequency });
+        }
     }
-    #endif
-}
-
-void PitchCorrectionEngine::preserveFormants(float* buffer, int numSamples, float pitchShiftRatio)
-{
-    // Simplified formant preservation
-    // In a full implementation, this would involve spectral envelope manipulation
     
-    if (pitchShiftRatio == 1.0f) return;
+    for (int i = 0; i < fftSize; ++i)
+        fftWorkspace[i] = {};
+    std::fill(nextSpectralRotation.begin(), nextSpectralRotation.end(), 0.0f);
     
-    // Apply spectral processing to preserve formant structure
-    // This is a simplified approach - real formant preservation requires
-    // more sophisticated spectral manipulation
+    const int numPeaks = static_cast<int>(spectralPeaks.size());
     
-    for (int i = 0; i < numSamples; ++i)
+    for (int p = 0; p < numPeaks; ++p)
     {
-        // Apply slight formant compensation
-        float compensation = 1.0f - (pitchShiftRatio - 1.0f) * 0.3f;
-        buffer[i] *= compensation;
+        const auto& peak = spectralPeaks[static_cast<size_t>(p)];
+        const int target = jlimit(0, numBins - 1, peak.bin + peak.shift);
+        
+        // Each peak owns the bins up to halfway to its neighbours (identity phase locking),
+        // measured both before and after the shift so downward shifts do not overlap
+        int first = 0;
+        int last = numBins - 1;
+        
+        if (p > 0)
+        {
+            const auto& previous = spectralPeaks[static_cast<size_t>(p - 1)];
+            first = jmax((previous.bin + peak.bin) / 2 + 1,
+                         (previous.bin + previous.shift + target) / 2 + 1 - peak.shift);
+        }
+        
+        if (p < numPeaks - 1)
+        {
+            const auto& next = spectralPeaks[static_cast<size_t>(p + 1)];
+            last = jmin((peak.bin + next.bin) / 2,
+                        (target + next.bin + next.shift) / 2 - peak.shift);
+        }
+        
+        // The shifted peak advances pitchRatio times as fast as the analysed one; the
+        // rotation carries that difference from frame to frame
+        const float rotation = transient ? 0.0f
+                             : wrapPhase(spectralRotation[static_cast<size_t>(target)] + (pitchRatio - 1.0f) * peak.frequency * hop);
+        
+        // The peak leaves its own envelope level behind and takes the level of the envelope
+        // (moved by the formant shift) where it lands
+        const float envelopeGain = jlimit(1.0f / maxEnvelopeGain, maxEnvelopeGain,
+                                          std::exp(getEnvelopeAt(spectralLogEnvelope.data(), target / formantShiftRatio)
+                                                   - getEnvelopeAt(spectralLogEnvelope.data(), static_cast<float>(peak.bin))));
+        
+        // Referenced to the frame centre, so the whole-bin shift errs symmetrically in time
+        const auto phasor = std::polar(envelopeGain, rotation - binFrequency * peak.shift * frameCentre);
+        
+        for (int k = jmax(first, -peak.shift); k <= jmin(last, numBins - 1 - peak.shift); ++k)
+        {
+            fftWorkspace[k + peak.shift] += spectralBins[k] * phasor;
+            nextSpectralRotation[static_cast<size_t>(k + peak.shift)] = rotation;
+        }
     }
+    
+    // Real output: DC and Nyquist are real, negative frequencies mirror the positive ones
+    fftWorkspace[0] = { fftWorkspace[0].real(), 0.0f };
+    fftWorkspace[fftSize / 2] = { fftWorkspace[fftSize / 2].real(), 0.0f };
+    for (int k = 1; k < fftSize / 2; ++k)
+        fftWorkspace[fftSize - k] = std::conj(fftWorkspace[k]);
+    
+    std::copy(spectralBins.begin(), spectralBins.end(), previousSpectralBins.begin());
+    std::swap(spectralMagnitude, previousSpectralMagnitude);
+    std::swap(spectralRotation, nextSpectralRotation);
+    spectralHistoryValid = true;
+}
+
+void PitchCorrectionEngine::resetSpectralShift()
+{
+    std::fill(spectralInput.begin(), spectralInput.end(), 0.0f);
+    std::fill(spectralOutput.begin(), spectralOutput.end(), 0.0f);
+    std::fill(spectralRotation.begin(), spectralRotation.end(), 0.0f);
+    std::fill(previousSpectralMagnitude.begin(), previousSpectralMagnitude.end(), 0.0f);
+    spectralInputWritePos = 0;
+    spectralSampleCount = 0;
+    spectralHistoryValid = false;
+    nextSpectralFrameSlot = 0;
+    
+    for (auto& frame : spectralFrameQueue)
+        frame.position = -1;
 }
 
 float PitchCorrectionEngine::calculateRMS(const float* buffer, int numSamples)
 {
     if (numSamples <= 0) return 0.0f;
     
-    float sum = 0.0f;
-    for (int i = 0; i < numSamples; ++i)
-    {
-        sum += buffer[i] * buffer[i];
-    }
-    
-    return std::sqrt(sum / numSamples);
+    return std::sqrt(DSPKernels::sumOfSquares(buffer, numSamples) / numSamples);
 }
 
 float PitchCorrectionEngine::calculateCentroid(const std::vector<float>& spectrum)
@@ -596,6 +2305,31 @@ float PitchCorrectionEngine::interpolateValue(float current, float target, float
 
 void PitchCorrectionEngine::applyHannWindow(float* buffer, int numSamples)
 {
+    if (numSamples <= 1) return;
+    
+    // Tables are only rebuilt when a new window length is requested
+    int slot = numSamples == hannWindowTableSizes[0] ? 0
+             : numSamples == hannWindowTableSizes[1] ? 1 : -1;
+    
+    if (slot < 0 && numSamples <= fftSize)
+    {
+        slot = nextHannWindowSlot;
+        nextHannWindowSlot = 1 - nextHannWindowSlot;
+        
+        auto& table = hannWindowTables[static_cast<size_t>(slot)];
+        for (int i = 0; i < numSamples; ++i)
+        {
+            table[i] = 0.5f * (1.0f - std::cos(2.0f * MathConstants<float>::pi * i / (numSamples - 1)));
+        }
+        hannWindowTableSizes[static_cast<size_t>(slot)] = numSamples;
+    }
+    
+    if (slot >= 0)
+    {
+        DSPKernels::multiply(buffer, hannWindowTables[static_cast<size_t>(slot)].data(), numSamples);
+        return;
+    }
+    
     for (int i = 0; i < numSamples; ++i)
     {
         float windowValue = 0.5f * (1.0f - std::cos(2.0f * MathConstants<float>::pi * i / (numSamples - 1)));
@@ -616,89 +2350,3 @@ void PitchCorrectionEngine::applyBlackmanWindow(float* buffer, int numSamples)
         buffer[i] *= windowValue;
     }
 }
-
-// ============================================================================
-// REAL PITCH SHIFTING ALGORITHMS
-// ============================================================================
-
-void PitchCorrectionEngine::applyGranularPitchShift(float* buffer, int numSamples, float pitchRatio, float speed)
-{
-    // Real-time granular pitch shifting using overlap-add technique
-    static std::vector<float> overlapBuffer(4096, 0.0f);
-    static int overlapPosition = 0;
-    
-    int grainSize = std::min(512, numSamples);
-    int hopSize = static_cast<int>(grainSize * speed);
-    
-    for (int pos = 0; pos < numSamples; pos += hopSize)
-    {
-        int actualGrainSize = std::min(grainSize, numSamples - pos);
-        
-        // Create grain with pitch shifting
-        std::vector<float> grain(actualGrainSize);
-        for (int i = 0; i < actualGrainSize; ++i)
-        {
-            // Sample with pitch ratio (simple linear interpolation)
-            float sourceIndex = i / pitchRatio;
-            int index1 = static_cast<int>(sourceIndex);
-            int index2 = index1 + 1;
-            float fraction = sourceIndex - index1;
-            
-            if (index1 >= 0 && index2 < actualGrainSize)
-            {
-                grain[i] = buffer[pos + index1] * (1.0f - fraction) + 
-                          buffer[pos + index2] * fraction;
-            }
-            else if (index1 >= 0 && index1 < actualGrainSize)
-            {
-                grain[i] = buffer[pos + index1];
-            }
-            
-            // Apply Hann window to grain
-            float window = 0.5f * (1.0f - std::cos(2.0f * MathConstants<float>::pi * i / (actualGrainSize - 1)));
-            grain[i] *= window;
-        }
-        
-        // Overlap-add the grain back to buffer
-        for (int i = 0; i < actualGrainSize; ++i)
-        {
-            int bufferIndex = pos + i;
-            if (bufferIndex < numSamples)
-            {
-                buffer[bufferIndex] = grain[i] * 0.7f + buffer[bufferIndex] * 0.3f; // Blend
-            }
-        }
-    }
-}
-
-void PitchCorrectionEngine::applyHardPitchQuantization(float* buffer, int numSamples, float pitchRatio, float speed)
-{
-    // Hard quantization with phase coherence
-    static float phase = 0.0f;
-    
-    for (int i = 0; i < numSamples; ++i)
-    {
-        // Apply instant pitch shift with anti-aliasing
-        float sourcePhase = phase / pitchRatio;
-        
-        // Use sinc interpolation for anti-aliasing
-        float result = 0.0f;
-        int kernelSize = 8;
-        
-        for (int k = -kernelSize; k <= kernelSize; ++k)
-        {
-            int sourceIndex = static_cast<int>(sourcePhase) + k;
-            if (sourceIndex >= 0 && sourceIndex < i)
-            {
-                float x = sourcePhase - sourceIndex;
-                float sincValue = (x == 0.0f) ? 1.0f : std::sin(MathConstants<float>::pi * x) / (MathConstants<float>::pi * x);
-                float window = 0.54f - 0.46f * std::cos(2.0f * MathConstants<float>::pi * (k + kernelSize) / (2 * kernelSize));
-                result += buffer[sourceIndex] * sincValue * window;
-            }
-        }
-        
-        // Apply hard correction with smooth blending
-        buffer[i] = result * speed + buffer[i] * (1.0f - speed);
-        phase += 1.0f;
-    }
-}
@@ -1,6 +1,12 @@
 #pragma once
 
 #include "JuceHeader.h"
+#include "ModeSelector.h"
+#include "PolyphaseDecimator.h"
+#include "FractionalDelayInterpolator.h"
+#include "RubberBandShifter.h"
+#include "CacheAlignedVector.h"
+#include <array>
 #include <memory>
 #include <vector>
 #include <complex>
@@ -13,7 +19,11 @@
 #include <Eigen/Dense>
 #endif
 
-class PitchCorrectionEngine
+// All DSP state lives in the engine, one per channel, so plugin instances on different host
+// threads share nothing. Cache-line alignment keeps the state of neighbouring heap objects
+// (e.g. another instance's engine) off the lines this one writes every sample, and the rings
+// written every sample (CacheAlignedVector) start and end on lines of their own.
+class alignas(64) PitchCorrectionEngine
 {
 public:
     PitchCorrectionEngine();
@@ -23,24 +33,114 @@ public:
     void prepareToPlay(double sampleRate, int blockSize);
     void reset();
 
-    // Basic pitch detection methods
+    // Basic pitch detection methods. Input is accumulated across calls and analysed
+    // at a fixed hop over a full window, so results do not depend on the host block size.
+    // Samples report 0 while the voicing gate is closed.
     void detectPitch(const float* inputBuffer, int numSamples, float* pitchOutput);
     void detectPitchAdvanced(const float* inputBuffer, int numSamples, float* pitchOutput);
     
-    // Pitch correction methods
-    void correctPitch(float* buffer, int numSamples, 
-                     float targetPitch, float speed, float amount);
+    // Runs the backend chosen by ModeSelector. Autocorrelation and YIN use the blend of
+    // detectPitch(); Spectral, Harmonic and Combined the ensemble of detectPitchAdvanced().
+    // MPM and ProbabilisticYIN each run alone at a constant cost per hop.
+    void detectPitch(const float* inputBuffer, int numSamples, float* pitchOutput,
+                     ModeSelector::PitchAlgorithm algorithm);
     
-    void correctPitchHard(float* buffer, int numSamples, 
-                         float targetPitch, float speed, float amount);
+    // Block pitch shifting: each output sample is the input shifted by the matching entry of
+    // ratioCurve (1 = unchanged). input and output may be the same buffer. While the curve
+    // holds exactly 1 the shifter settles into a clean delay of getLatencySamples().
+    void process(const float* input, float* output, int numSamples, const float* ratioCurve);
     
-    void correctPitchAI(float* buffer, int numSamples, 
-                       float targetPitch, float speed, float amount);
+    // TD-PSOLA variant for monophonic voice: pitchCurve is the detected F0 per sample (0 when
+    // unvoiced), which places the pitch marks. Same latency as the delay-line shifter above,
+    // and at a ratio of exactly 1 a clean delay of it as well.
+    void process(const float* input, float* output, int numSamples,
+                 const float* ratioCurve, const float* pitchCurve);
+    
+    int getLatencySamples() const { return shifterLatency; }
+    
+    // Phase-vocoder variant: peak-locked bin shifting of 2048-sample frames every 512 samples,
+    // with a phase reset on transients. When detectPitch() has just analysed the same buffer
+    // with a spectral detector (Spectral, Harmonic, Combined) its FFT frames are reused, so one
+    // forward and one inverse FFT per hop cover detection, formants and shifting; behind the
+    // time-domain detectors (YIN, pYIN, MPM) the vocoder runs its own STFT. Each shifted peak
+    // is divided by the frame's spectral envelope and takes the envelope's level where it
+    // lands, so the formants stay put (or move by the formant shift) whatever the pitch ratio.
+    // The latency is one frame, getSpectralLatencySamples().
+    void processSpectral(const float* input, float* output, int numSamples, const float* ratioCurve);
+    int getSpectralLatencySamples() const { return analysisWindowSize - 1; }
+    
+    // Formant shift as a frequency ratio (1 = formants preserved). Applies to the phase vocoder
+    // and the Rubber Band R3 engines; PSOLA and R2 always preserve the formants.
+    void setFormantShift(float ratio);
+    float getFormantShift() const { return formantShiftRatio; }
+    
+    // AI mode shifter, one engine per quality level (ModeSelector::getShifterEngine): PSOLA,
+    // Rubber Band R2 / R3 short / R3 (formant preserving, streamed at a fixed latency), or the
+    // phase vocoder without Rubber Band. Every engine is delayed to one common latency,
+    // getShifterEngineLatencySamples(), so switching is seamless: the new engine runs beside
+    // the old on the live input until its output is valid, then the two crossfade over one
+    // prepared block. pitchCurve is only read by PSOLA.
+    void setShifterEngine(ModeSelector::ShifterEngine newEngine) { requestedShifterEngine = newEngine; }
+    ModeSelector::ShifterEngine getShifterEngine() const { return activeShifterEngine; }
+    void processShifterEngine(const float* input, float* output, int numSamples,
+                              const float* ratioCurve, const float* pitchCurve);
+    int getShifterEngineLatencySamples() const { return shifterEngineLatency; }
+    
+    // Analysis hop (power of two, 16-512 samples). YIN runs every hop; the FFT
+    // based detectors keep a 128-sample cadence when the hop is finer than that.
+    void setAnalysisHopSize(int newHopSize);
+    int getAnalysisHopSize() const { return analysisHopSize; }
+    
+    // How long after a note change the detected pitch gets halfway to the new note, at the
+    // current hop. A lower bound from step-response measurements (44.1-96kHz), so audio
+    // delayed by this much lines the pitch curve up with the note, never ahead of it.
+    int getDetectionLatencySamples(ModeSelector::PitchAlgorithm algorithm) const;
+
+    // Multi-rate analysis (on by default): at 88.2kHz and above the lag search runs
+    // on a ~12kHz decimated copy and is refined on the full-rate signal.
+    // Takes effect on the next prepare().
+    void setMultiRateAnalysisEnabled(bool shouldBeEnabled) { multiRateAnalysisEnabled = shouldBeEnabled; }
+    bool isMultiRateAnalysisActive() const { return analysisDecimator.getFactor() > 1; }
 
     // Analysis methods
     float getCurrentPitch() const { return currentPitch; }
     float getCurrentConfidence() const { return pitchConfidence; }
     float getRMSLevel() const { return rmsLevel; }
+    float getSpectralCentroid() const { return analysisFrame.spectralCentroid; }
+    
+    // Detector cascade of detectPitchAdvanced(): YIN runs every hop, autocorrelation only
+    // when YIN is unsure or jumps by an octave, and the spectral peak + HPS stage only when
+    // the earlier estimates are still unsure or disagree
+    struct CascadeReport
+    {
+        bool ranAutocorrelation = false;
+        bool ranSpectral = false;   // Spectral peak and HPS share one FFT frame
+        float confidence = 0.0f;
+    };
+    
+    struct CascadeStats
+    {
+        int64 evaluatedHops = 0;
+        int64 autocorrelationHops = 0;
+        int64 spectralHops = 0;
+    };
+    
+    const CascadeReport& getLastCascadeReport() const { return lastCascadeReport; }
+    const CascadeStats& getCascadeStats() const { return cascadeStats; }
+    void resetCascadeStats() { cascadeStats = {}; }
+    
+    // Voicing gate (on by default): hops that are silent, breathy or sibilant skip
+    // detection and report no pitch, so the correction stage leaves them untouched
+    struct VoicingStats
+    {
+        int64 evaluatedHops = 0;
+        int64 skippedHops = 0;
+    };
+    
+    void setVoicingGateEnabled(bool shouldBeEnabled) { voicingGateEnabled = shouldBeEnabled; }
+    bool isVoiced() const { return voicingGateOpen || !voicingGateEnabled; }
+    const VoicingStats& getVoicingStats() const { return voicingStats; }
+    void resetVoicingStats() { voicingStats = {}; }
 
 private:
     double sampleRate = 44100.0;
@@ -55,55 +155,366 @@ private:
     std::unique_ptr<dsp::FFT> fft;
     std::unique_ptr<dsp::WindowingFunction<float>> window;
     HeapBlock<dsp::Complex<float>> frequencyData;
+    HeapBlock<dsp::Complex<float>> fftWorkspace;
     
     // Autocorrelation-based pitch detection
     std::vector<float> autocorrelationBuffer;
     std::vector<float> windowedBuffer;
-    std::vector<float> tempBuffer;
-    std::vector<float> magnitudeSpectrum;
+    // Cached Hann coefficients for applyHannWindow. Two slots so the full-rate and
+    // decimated window lengths do not evict each other.
+    std::array<std::vector<float>, 2> hannWindowTables;
+    std::array<int, 2> hannWindowTableSizes {};
+    int nextHannWindowSlot = 0;
     static constexpr int fftOrder = 12; // 2^12 = 4096
     static constexpr int fftSize = 1 << fftOrder;
     
+    // Analysis scheduler: input is collected in a ring (written twice so the
+    // latest window is always contiguous) and analysed every analysisHopSize samples
+    CacheAlignedVector<float> analysisRing;
+    int analysisRingWritePos = 0;
+    int analysisHopSize = 128;
+    int samplesUntilNextHop = 128;
+    int hopsSinceSpectralAnalysis = 0;
+    static constexpr int analysisWindowSize = 2048;
+    static constexpr int spectralAnalysisHop = 128;
+    static constexpr int maxAnalysisHopSize = 512;
+    
+    // Streaming YIN: the difference function is kept between hops and updated
+    // with the samples entering and leaving the integration window
+    CacheAlignedVector<float> yinHistory; // Ring written twice so any window is contiguous
+    std::vector<double> yinDifference;    // d(tau) for the current window
+    std::vector<float> yinBuffer;         // Cumulative mean normalised difference scratch
+    int yinHistoryCapacity = 0;
+    int yinHistoryWritePos = 0;
+    int yinMaxTau = 0;
+    int yinHopsSinceRefresh = 0;
+    bool yinDifferenceStale = false;    // History advanced without updating d(tau)
+    float autocorrelationPitch = 0.0f;
+    int yinIntegrationWindow = 1024;    // About 23ms at the analysis rate
+    static constexpr int fullRateYinIntegrationWindow = 1024;
+    static constexpr int yinRefreshInterval = 256; // Full recompute bounds rounding drift
+    
+    // Multi-rate analysis: YIN and autocorrelation see the decimated signal, and their
+    // coarse period is refined against a full-rate history around the decimated lag
+    PolyphaseDecimator analysisDecimator;
+    std::unique_ptr<dsp::FFT> decimatedFFT;
+    CacheAlignedVector<float> decimatedRing;     // Written twice, decimatedWindowSize long
+    std::vector<float> decimatedHopBuffer;   // Decimated samples produced since the last hop
+    CacheAlignedVector<float> refinementHistory; // Full-rate ring written twice
+    std::vector<float> refinementDifference; // d(tau) scratch around the coarse lag
+    double analysisSampleRate = 44100.0;
+    int decimatedRingWritePos = 0;
+    int decimatedHopSamples = 0;
+    int refinementHistoryCapacity = 0;
+    int refinementHistoryWritePos = 0;
+    int lagSearchHopInterval = 1;        // Spectral hops between decimated lag searches
+    int64 spectralHopCounter = 0;
+    int64 lastAutocorrelationHop = -1;
+    int64 lastMPMHop = -1;
+    float yinStreamingPitch = 0.0f;
+    bool multiRateAnalysisEnabled = true;
+    static constexpr double multiRateMinSampleRate = 88200.0;
+    static constexpr double decimatedTargetRate = 12000.0;
+    static constexpr int decimatedWindowSize = 512;
+    static constexpr int decimatedFFTOrder = 10;
+    static constexpr int refinementWindow = 1024;
+    static constexpr int maxRefinementAttempts = 4;
+    static constexpr float refinementOctaveThreshold = 0.1f; // d(tau) against 2x the window's energy
+    static constexpr float refinementOctaveMatch = 2.0f;       // Half-lag d(tau) against the lag's
+    static constexpr float refinementOctaveFloor = 1.0e-3f;    // Below this either fits exactly
+    
+    // McLeod Pitch Method: normalised square difference function built from the
+    // FFT autocorrelation; the first key maximum within k of the highest one wins
+    std::vector<float> nsdfBuffer;
+    float mpmPitch = 0.0f;
+    static constexpr float mpmKeyMaximumThreshold = 0.93f;
+    static constexpr float mpmMinimumClarity = 0.5f;
+    
+    // Probabilistic YIN: every CMNDF dip is a candidate weighted by a Beta(2, 18) prior
+    // over YIN thresholds, and an online Viterbi over a 20-cent grid (voiced and unvoiced
+    // copies of each bin) picks the track. Only the latest path scores are kept.
+    struct PitchCandidate
+    {
+        float frequency = 0.0f;
+        float probability = 0.0f;
+    };
+    
+    struct ViterbiTracker
+    {
+        std::vector<float> voicedScore;    // Best path probability ending in each state
+        std::vector<float> unvoicedScore;
+        std::vector<float> nextVoicedScore;
+        std::vector<float> nextUnvoicedScore;
+        std::vector<float> observation;    // Candidate probability mass per pitch bin
+        std::vector<float> transition;     // Triangular pitch-jump weights, -maxJump..maxJump
+    };
+    
+    std::array<PitchCandidate, 32> pyinCandidates;
+    int numPyinCandidates = 0;
+    std::array<float, 101> pyinThresholdCDF {}; // P(threshold <= i / 100)
+    ViterbiTracker pyinTracker;
+    static constexpr float pyinMinFrequency = 50.0f;
+    static constexpr float pyinBinCents = 20.0f;
+    static constexpr int pyinNumBins = 241;       // 50-800Hz
+    static constexpr int pyinMaxJump = 12;        // Bins per hop (240 cents)
+    static constexpr float pyinVoicingSwitchProbability = 0.01f;
+    
+    // Detector cascade. Each detector leaves its 0-1 confidence here on every run.
+    struct PitchEstimate
+    {
+        float frequency = 0.0f;
+        float confidence = 0.0f;
+    };
+    
+    struct DetectorConfidence
+    {
+        float yin = 0.0f;             // 1 - CMNDF at the chosen dip
+        float autocorrelation = 0.0f; // Peak over zero-lag power
+        float spectral = 0.0f;        // Share of 50-800Hz energy in the peak
+        float harmonic = 0.0f;        // HPS peak prominence
+    };
+    
+    DetectorConfidence detectorConfidence;
+    CascadeReport lastCascadeReport;
+    CascadeStats cascadeStats;
+    int hopsSinceSpectralFrame = 0;
+    static constexpr float cascadeConfidenceThreshold = 0.85f;
+    static constexpr float cascadeAgreementCents = 50.0f;
+    static constexpr int spectralFrameRefreshInterval = 8; // Keeps centroid and formants current
+    
+    // Voicing gate: level and zero-crossing rate of the newest part of the window, with
+    // separate open/close thresholds and a hold time so note tails do not chatter
+    VoicingStats voicingStats;
+    float voicingLevel = 0.0f;
+    int hopsUntilVoicingGateCloses = 0;
+    bool voicingGateOpen = false;
+    bool voicingGateEnabled = true;
+    static constexpr int voicingWindowSize = 1024;
+    static constexpr float voicingOpenLevelDb = -50.0f;
+    static constexpr float voicingCloseLevelDb = -56.0f;
+    static constexpr float voicingOpenCrossingsPerSecond = 5000.0f;  // Bright vowels reach ~4000, breath ~9000+
+    static constexpr float voicingCloseCrossingsPerSecond = 6500.0f;
+    static constexpr double voicingHoldSeconds = 0.03;
+    
     // Pitch tracking
     std::vector<float> pitchHistory;
     static constexpr int pitchHistoryLength = 10;
     float pitchSmoothingFactor = 0.8f;
     
+    // Spectral analysis of one hop, shared by the spectral, HPS, formant, centroid and
+    // phase-vocoder consumers. Recomputed only after advanceAnalysisHop().
+    struct AnalysisFrame
+    {
+        std::vector<dsp::Complex<float>> bins;  // DC to Nyquist
+        std::vector<float> magnitude;
+        std::vector<float> logMagnitude;
+        std::vector<float> logEnvelope;         // Cepstral envelope on the coarse envelope grid
+        float spectralCentroid = 0.0f;
+        int64 hopIndex = -1;
+        bool valid = false;
+    };
+    
+    AnalysisFrame analysisFrame;
+    int64 analysisHopCounter = 0;
+    std::vector<float> hpsBuffer;
+    
     // Formant preservation
     std::vector<float> formantFrequencies;
     std::vector<float> formantAmplitudes;
+    std::vector<std::pair<float, int>> formantPeakCandidates;
     static constexpr int maxFormants = 5;
     
-    // PSOLA (Pitch Synchronous Overlap Add) for pitch shifting
+    // Spectral envelope: the magnitude spectrum is averaged 4:1 onto a 513-point grid, and
+    // its log goes through decimatedFFT's 1024-point cepstrum, liftered below the pitch period
+    // with a raised cosine. One inverse and one forward transform a quarter the frame's size.
+    HeapBlock<dsp::Complex<float>> envelopeWorkspace;
+    HeapBlock<dsp::Complex<float>> envelopeCepstrum;
+    std::vector<float> spectralLogEnvelope;     // Envelope of the phase vocoder's current frame
+    float formantShiftRatio = 1.0f;
+    static constexpr int envelopeFFTSize = 1 << decimatedFFTOrder;
+    static constexpr int envelopeDecimation = fftSize / envelopeFFTSize;
+    static constexpr int envelopeSize = envelopeFFTSize / 2 + 1;  // DC to Nyquist
+    static constexpr float envelopeFallbackPitch = 400.0f;        // Lifter when no pitch is known
+    static constexpr float maxEnvelopeGain = 16.0f;               // +-24dB per peak
+    
+    // PSOLA (Pitch Synchronous Overlap Add) for pitch shifting. Each pitch mark's grain
+    // (one period either side, Hann windowed) is cut once into a fixed pool; synthesis
+    // overlap-adds the pooled grain nearest each synthesis mark into a ring at the target
+    // period, at sub-sample positions through the shared interpolator. Unvoiced input uses
+    // grains cut at the synthesis marks themselves, which reconstructs the delayed input exactly.
     struct GrainData
     {
-        std::vector<float> grain;
-        int position;
-        float pitch;
-        float amplitude;
+        std::vector<float> grain;   // Longest period in prepare(), zero-padded for the interpolator
+        int64 position = -1;        // Input sample the grain is centred on, -1 when empty
+        int halfLength = 0;
+        float pitch = 0.0f;
+        float amplitude = 1.0f;
+    };
+    
+    std::vector<GrainData> grainBuffer;    // Ring of the latest voiced grains
+    GrainData synthesisGrain;              // Scratch for grains cut at a synthesis mark
+    int nextGrainSlot = 0;
+    CacheAlignedVector<float> psolaInput;  // Rings indexed by absolute sample number
+    CacheAlignedVector<float> psolaOutput;
+    std::vector<float> psolaWindow;        // Hann over one grain, shared by every grain length
+    int64 psolaMask = 0;
+    int64 psolaSampleCount = 0;
+    int64 lastPitchMark = -1;
+    double nextSynthesisMark = 0.0;
+    int psolaMaxPeriod = 0;
+    int shifterLatency = 0;
+    static constexpr int psolaPoolSize = 8;
+    static constexpr int psolaWindowResolution = 1024;
+    static constexpr double shifterLatencySeconds = 0.008;
+    
+    // Windowed-sinc fractional reads shared by both shifters (table built once)
+    FractionalDelayInterpolator interpolator;
+    static constexpr int interpolatorTaps = 16;
+    static constexpr int interpolatorPhases = 512;
+    static constexpr int psolaGrainPadding = interpolatorTaps / 2;
+    
+    // Phase vocoder: frames on a fixed 512-sample grid of absolute sample positions. The
+    // detector queues the frames it has transformed anyway on that grid; processSpectral()
+    // takes them when it reaches the same position of the same input and transforms the
+    // rest itself.
+    struct SpectralFrame
+    {
+        std::vector<dsp::Complex<float>> bins;
+        std::vector<float> logEnvelope;
+        int64 position = -1;     // Analysed sample count at the end of the frame
+    };
+    
+    struct SpectralPeak
+    {
+        int bin = 0;
+        int shift = 0;           // Whole bins towards the target frequency
+        float frequency = 0.0f;  // Instantaneous frequency, radians per sample
     };
     
-    std::vector<GrainData> grainBuffer;
+    std::vector<SpectralFrame> spectralFrameQueue;
+    int nextSpectralFrameSlot = 0;
+    CacheAlignedVector<float> spectralInput;   // Ring written twice so the frame is contiguous
+    CacheAlignedVector<float> spectralOutput;  // Overlap-add ring indexed by absolute sample number
+    std::vector<float> spectralSynthesisWindow; // Hann over the sum of squared windows at this hop
+    std::vector<dsp::Complex<float>> spectralBins;
+    std::vector<dsp::Complex<float>> previousSpectralBins;
+    std::vector<float> spectralMagnitude;
+    std::vector<float> previousSpectralMagnitude;
+    std::vector<float> spectralRotation;       // Accumulated phase rotation per output bin
+    std::vector<float> nextSpectralRotation;
+    std::vector<SpectralPeak> spectralPeaks;
+    int spectralInputWritePos = 0;
+    int64 spectralSampleCount = 0;
+    int64 analysisSampleCount = 0;
+    const float* lastAnalysisInput = nullptr;  // Buffer the detector's queued frames came from
+    bool spectralShiftActive = false;          // processSpectral() ran in the previous block...
+    bool spectralFramesShared = false;         // ...on the buffer the detector had analysed
+    bool spectralHistoryValid = false;
+    static constexpr int spectralShiftHop = analysisWindowSize / 4;
+    static constexpr int spectralOutputSize = analysisWindowSize * 2;
+    static constexpr float spectralPeakFloor = 1.0e-3f;          // -60dB below the loudest bin
+    static constexpr float spectralTransientThreshold = 0.5f;    // Share of rising magnitude
+    
     int grainSize = 1024;
     int hopSize = 256;
     int grainOverlap = 4;
     
+    // Block shifter: two read taps half a grain apart sweep a delay line at (1 - ratio)
+    // samples per sample and crossfade with complementary sin^2 windows
+    CacheAlignedVector<float> shifterDelayLine;         // Written twice so every tap window is contiguous
+    int shifterDelayMask = 0;
+    int shifterWritePos = 0;
+    float shifterPhase = 0.5f;                          // 0.5: tap 1 alone, at the nominal delay
+    static constexpr int shifterMinDelay = interpolatorTaps / 2; // Keeps the sinc taps behind the write head
+    static constexpr float shifterMinRatio = 0.25f;
+    static constexpr float shifterMaxRatio = 4.0f;
+    static constexpr float shifterSettleRate = 0.03f;   // Tap drift while settling, ~50 cents
+    
+#ifdef USE_RUBBERBAND
+    // AI mode stretchers, all created in prepare() so a switch never allocates
+    RubberBandShifter rubberBandFaster;
+    RubberBandShifter rubberBandFinerShort;
+    RubberBandShifter rubberBandFiner;
+#endif
+    
+    // Quality-tier shifter state. Idle engines are not fed; one that resumes is warmed up on
+    // the live input for its own plus the common latency before it is heard.
+    static constexpr int numShifterEngines = 5;
+    ModeSelector::ShifterEngine activeShifterEngine = ModeSelector::ShifterEngine::PhaseVocoder;
+    ModeSelector::ShifterEngine requestedShifterEngine = ModeSelector::ShifterEngine::PhaseVocoder;
+    ModeSelector::ShifterEngine incomingShifterEngine = ModeSelector::ShifterEngine::PhaseVocoder;
+    bool shifterEngineStarted = false;        // Until the first block an engine change is immediate
+    bool shifterTransitionActive = false;
+    bool phaseVocoderRunning = false;
+    int shifterWarmupRemaining = 0;
+    int shifterFadePosition = 0;
+    int shifterEngineLatency = 0;
+    std::array<CacheAlignedVector<float>, numShifterEngines> shifterAlignmentRings; // Pads each engine to the common latency
+    std::array<int, numShifterEngines> shifterAlignmentDelays {};
+    std::array<int, numShifterEngines> shifterAlignmentWritePos {};
+    std::vector<float> shifterInputCopy;      // Input kept while two engines share an in-place buffer
+    std::vector<float> shifterIncomingOutput;
+    
     // Private methods
-    float detectPitchAutocorrelation(const float* buffer, int numSamples);
-    float detectPitchYIN(const float* buffer, int numSamples);
+    void processAnalysisBlock(const float* inputBuffer, int numSamples, float* pitchOutput,
+                              ModeSelector::PitchAlgorithm algorithm);
+    void runAnalysisHop();
+    void runAdvancedAnalysisHop();
+    void runMPMAnalysisHop();
+    void runProbabilisticYINHop();
+    bool updateVoicingGate(const float* analysisWindow);
+    void skipUnvoicedHop(const float* analysisWindow);
+    void closeVoicingGate();
+    bool isSpectralAnalysisHop();
+    float detectPitchAutocorrelation(const float* buffer, int numSamples, dsp::FFT& transform, double rate);
+    float detectPitchYINStreaming(const float* newSamples, int numNewSamples);
+    int appendYINHistory(const float* newSamples, int numNewSamples);
+    float findYinPitch(int bufferLength, double rate);
+    
+    // Multi-rate dispatch: full-rate detectors below 88.2kHz, decimated + refined above
+    void pushMultiRateInput(const float* input, int numSamples);
+    float detectPitchYINAtAnalysisRate(const float* newestHop);
+    float detectPitchAutocorrelationAtAnalysisRate(const float* analysisWindow);
+    float detectPitchMPMAtAnalysisRate(const float* analysisWindow);
+    void skipYINAtAnalysisRate(const float* newestHop);
+    bool isLagSearchDue(int64& lastSearchHop);
+    float refinePitchAtFullRate(float coarsePitch);
+    float refineLagAtFullRate(int coarseLag, float& minimumDifference);
+    
+    // MPM and probabilistic YIN
+    float detectPitchMPM(const float* buffer, int numSamples, dsp::FFT& transform, double rate);
+    void findPitchCandidates(int bufferLength, double rate);
+    float trackPitchCandidates();
+    void resetPitchTracker();
+    
+    // Detector cascade
+    static bool pitchesAgree(float a, float b);
+    static bool isOctaveError(float a, float b);
+    bool areConfidentEstimatesConsistent(const PitchEstimate* estimates, int numEstimates) const;
+    PitchEstimate combineEstimates(const PitchEstimate* estimates, int numEstimates) const;
     float detectPitchSpectral(const float* buffer, int numSamples);
     float detectPitchHarmonic(const float* buffer, int numSamples);
     
     void analyzeSpectrum(const float* buffer, int numSamples);
-    void detectFormants(const std::vector<float>& spectrum);
-    void preserveFormants(float* buffer, int numSamples, float pitchShiftRatio);
+    void transformAnalysisWindow(const float* buffer, int numSamples);
+    void advanceAnalysisHop() { ++analysisHopCounter; }
+    void computeSpectralEnvelope(const float* magnitude, int numBins, float* logEnvelope);
+    float getEnvelopeAt(const float* logEnvelope, float bin) const;
+    void detectFormants(const std::vector<float>& logEnvelope);
+    
+    // PSOLA methods (one input sample per call, after it is written to psolaInput)
+    void extractGrains(float period);
+    void synthesizeGrains(float pitchRatio, float period);
+    void cutGrain(GrainData& grain, int64 centre, int halfLength);
+    void applyGrain(const GrainData& grain, int64 centre, float fraction, int64 firstWritablePosition);
+    int64 findPitchMark(int64 start, int64 end) const;
     
-    // PSOLA methods
-    void extractGrains(const float* buffer, int numSamples, float pitch);
-    void synthesizeGrains(float* outputBuffer, int numSamples, 
-                         float targetPitch, float speed, float amount);
-    void applyGrain(float* outputBuffer, const GrainData& grain, 
-                   int startPosition, float amplitude);
+    // Phase vocoder methods
+    void queueSpectralFrame();
+    const SpectralFrame* findQueuedSpectralFrame(int64 position) const;
+    void runSpectralShiftHop(float pitchRatio, bool useQueuedFrames);
+    void shiftSpectralPeaks(float pitchRatio, bool envelopeKnown);
+    void resetSpectralShift();
     
     // Utility methods
     float calculateRMS(const float* buffer, int numSamples);
@@ -115,9 +526,16 @@ private:
     void applyHannWindow(float* buffer, int numSamples);
     void applyBlackmanWindow(float* buffer, int numSamples);
     
-    // REAL PITCH SHIFTING METHODS
-    void applyGranularPitchShift(float* buffer, int numSamples, float pitchRatio, float speed);
-    void applyHardPitchQuantization(float* buffer, int numSamples, float pitchRatio, float speed);
+    // Block shifter helpers
+    float readDelayLine(float delay) const;
+    int getShifterEngineOwnLatency(ModeSelector::ShifterEngine engine) const;
+    void runShifterEngine(ModeSelector::ShifterEngine engine, const float* input, float* output,
+                          int numSamples, const float* ratioCurve, const float* pitchCurve);
+    void processShifterEngineChunk(const float* input, float* output, int numSamples,
+                                   const float* ratioCurve, const float* pitchCurve);
+    
+    // Tests and benchmarks call the individual detectors through this (Tests/PitchCorrectionEngineProbe.h)
+    friend struct PitchCorrectionEngineProbe;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PitchCorrectionEngine)
 };
@@ -108,6 +108,62 @@ void AutoTuneAudioProcessorEditor::setupControls()
     scaleAttachment = std::make_unique<AudioProcessorValueTreeState::ComboBoxAttachment>(
         audioProcessor.getValueTreeState(), Parameters::SCALE_ID, scaleSelector);
     
+    // Stereo Link Toggle
+    stereoLinkButton.setButtonText("Stereo Link");
+    stereoLinkButton.setColour(ToggleButton::textColourId, Colours::white);
+    addAndMakeVisible(stereoLinkButton);
+    
+    stereoLinkAttachment = std::make_unique<AudioProcessorValueTreeState::ButtonAttachment>(
+        audioProcessor.getValueTreeState(), Parameters::STEREO_LINK_ID, stereoLinkButton);
+    
+    // Quality Selector
+    qualitySelector.addItem("Draft", 1);
+    qualitySelector.addItem("Good", 2);
+    qualitySelector.addItem("High", 3);
+    qualitySelector.addItem("Ultra", 4);
+    qualitySelector.setSelectedId(3); // High
+    addAndMakeVisible(qualitySelector);
+    
+    qualityLabel.setText("Quality", dontSendNotification);
+    qualityLabel.setJustificationType(Justification::centredRight);
+    qualityLabel.setColour(Label::textColourId, Colours::white);
+    addAndMakeVisible(qualityLabel);
+    
+    qualityAttachment = std::make_unique<AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.getValueTreeState(), Parameters::QUALITY_ID, qualitySelector);
+    
+    // Lookahead Slider
+    lookaheadSlider.setSliderStyle(Slider::LinearHorizontal);
+    lookaheadSlider.setTextBoxStyle(Slider::TextBoxRight, false, 60, 20);
+    lookaheadSlider.setRange(0.0, 50.0, 0.1);
+    lookaheadSlider.setValue(0.0);
+    lookaheadSlider.setTextValueSuffix(" ms");
+    addAndMakeVisible(lookaheadSlider);
+    
+    lookaheadLabel.setText("Lookahead", dontSendNotification);
+    lookaheadLabel.setJustificationType(Justification::centredRight);
+    lookaheadLabel.setColour(Label::textColourId, Colours::white);
+    addAndMakeVisible(lookaheadLabel);
+    
+    lookaheadAttachment = std::make_unique<AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getValueTreeState(), Parameters::LOOKAHEAD_ID, lookaheadSlider);
+    
+    // Formant Slider
+    formantSlider.setSliderStyle(Slider::LinearHorizontal);
+    formantSlider.setTextBoxStyle(Slider::TextBoxRight, false, 60, 20);
+    formantSlider.setRange(-12.0, 12.0, 0.1);
+    formantSlider.setValue(0.0);
+    formantSlider.setTextValueSuffix(" st");
+    addAndMakeVisible(formantSlider);
+    
+    formantLabel.setText("Formant", dontSendNotification);
+    formantLabel.setJustificationType(Justification::centredRight);
+    formantLabel.setColour(Label::textColourId, Colours::white);
+    addAndMakeVisible(formantLabel);
+    
+    formantAttachment = std::make_unique<AudioProcessorValueTreeState::SliderAttachment>(
+        audioProcessor.getValueTreeState(), Parameters::FORMANT_ID, formantSlider);
+    
     // Preset Controls
     savePresetButton.setButtonText("Save");
     savePresetButton.addListener(this);
@@ -349,6 +405,27 @@ void AutoTuneAudioProcessorEditor::resized()
     scaleLabel.setBounds(scaleArea.removeFromTop(20));
     scaleSelector.setBounds(scaleArea.reduced(10));
     
+    // Stereo link toggle, quality selector and lookahead below the selectors
+    auto optionsArea = controlsBounds.removeFromTop(30);
+    stereoLinkButton.setBounds(optionsArea.removeFromLeft(selectorWidth).reduced(10, 0));
+    
+    optionsArea.removeFromLeft(30); // Spacing
+    
+    auto qualityArea = optionsArea.removeFromLeft(selectorWidth);
+    qualityLabel.setBounds(qualityArea.removeFromLeft(60));
+    qualitySelector.setBounds(qualityArea.reduced(10, 2));
+    
+    optionsArea.removeFromLeft(30); // Spacing
+    
+    lookaheadLabel.setBounds(optionsArea.removeFromLeft(70));
+    lookaheadSlider.setBounds(optionsArea.reduced(10, 2));
+    
+    // Formant shift on a row of its own, under the quality selector and lookahead
+    auto formantArea = controlsBounds.removeFromTop(30);
+    formantArea.removeFromLeft(selectorWidth + 30);
+    formantLabel.setBounds(formantArea.removeFromLeft(60));
+    formantSlider.setBounds(formantArea.reduced(10, 2));
+    
     // Preset controls at bottom
     auto presetBounds = bounds.removeFromBottom(60).reduced(20, 10);
     auto buttonWidth = 80;
@@ -44,6 +44,21 @@ private:
     Label scaleLabel;
     std::unique_ptr<AudioProcessorValueTreeState::ComboBoxAttachment> scaleAttachment;
     
+    ToggleButton stereoLinkButton;
+    std::unique_ptr<AudioProcessorValueTreeState::ButtonAttachment> stereoLinkAttachment;
+    
+    ComboBox qualitySelector;
+    Label qualityLabel;
+    std::unique_ptr<AudioProcessorValueTreeState::ComboBoxAttachment> qualityAttachment;
+    
+    Slider lookaheadSlider;
+    Label lookaheadLabel;
+    std::unique_ptr<AudioProcessorValueTreeState::SliderAttachment> lookaheadAttachment;
+    
+    Slider formantSlider;
+    Label formantLabel;
+    std::unique_ptr<AudioProcessorValueTreeState::SliderAttachment> formantAttachment;
+    
     // Preset controls
     TextButton savePresetButton;
     TextButton loadPresetButton;
@@ -14,7 +14,7 @@ AutoTuneAudioProcessor::AutoTuneAudioProcessor()
     pluginParameters(),
     parameters(*this, nullptr, Identifier("AutoTuneParameters"), pluginParameters.createParameterLayout()),
     presetManager(parameters),
-    pitchEngine(),
+    pitchEngines(),
     modeSelector(),
     aiModelLoader()
 {
@@ -24,9 +24,18 @@ AutoTuneAudioProcessor::AutoTuneAudioProcessor()
     parameters.addParameterListener(Parameters::MODE_ID, this);
     parameters.addParameterListener(Parameters::KEY_ID, this);
     parameters.addParameterListener(Parameters::SCALE_ID, this);
-
-    // Initialize pitch correction engine
-    pitchEngine.prepareToPlay(44100.0, 512);
+    parameters.addParameterListener(Parameters::LOOKAHEAD_ID, this);
+    parameters.addParameterListener(Parameters::QUALITY_ID, this);
+
+    // The Quality tiers map one to one onto the CREPE tiers; the tier's variant (or
+    // crepe_model.onnx) is then loaded from the model directory when it is there. Another
+    // instance already holding it makes this instant (ModelRegistry).
+    aiModelLoader.setProcessingQuality(getModelQuality());
+    aiModelLoader.reloadModels();
+
+    // Initialize pitch correction engines
+    for (auto& engine : pitchEngines)
+        engine.prepareToPlay(44100.0, 512);
 }
 
 AutoTuneAudioProcessor::~AutoTuneAudioProcessor()
@@ -36,6 +45,9 @@ AutoTuneAudioProcessor::~AutoTuneAudioProcessor()
     parameters.removeParameterListener(Parameters::MODE_ID, this);
     parameters.removeParameterListener(Parameters::KEY_ID, this);
     parameters.removeParameterListener(Parameters::SCALE_ID, this);
+    parameters.removeParameterListener(Parameters::LOOKAHEAD_ID, this);
+    parameters.removeParameterListener(Parameters::QUALITY_ID, this);
+    cancelPendingUpdate();
 }
 
 // Methods moved to header as inline functions
@@ -56,11 +68,44 @@ void AutoTuneAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBloc
     currentSampleRate = sampleRate;
     currentBlockSize = samplesPerBlock;
 
-    // Prepare pitch correction engine
-    pitchEngine.prepareToPlay(sampleRate, samplesPerBlock);
+    // Prepare pitch correction engines (one per channel so streaming analysis state stays separate)
+    for (auto& engine : pitchEngines)
+        engine.prepareToPlay(sampleRate, samplesPerBlock);
+    
+    // Starts (or restarts) the inference thread; it idles until a CREPE model is loaded
+    inferenceWorker.prepare(sampleRate, samplesPerBlock);
+    
+    // Lookahead rings cover the longest setting and AI mode's model lag, so changing either
+    // never allocates
+    const int maxLookaheadSamples = jmax(static_cast<int>(std::ceil(Parameters::LOOKAHEAD_MAX * 0.001 * sampleRate)),
+                                         inferenceWorker.getMaxLatencySamples());
+    
+    for (int channel = 0; channel < maxChannels; ++channel)
+    {
+        lookaheadAudioDelays[static_cast<size_t>(channel)].prepare(maxLookaheadSamples);
+        lookaheadPitchDelays[static_cast<size_t>(channel)].prepare(maxLookaheadSamples);
+    }
+    
+    lookaheadBuffer.setSize(maxChannels, samplesPerBlock);
+    lookaheadSamples = -1;
+    
+    // Every mode runs its output through one of the engine's shifters
+    const auto mode = static_cast<Parameters::Mode>(
+        static_cast<int>(*parameters.getRawParameterValue(Parameters::MODE_ID)));
+    updateLookahead(mode);
+    updateReportedLatency(mode);
 
     // Initialize buffers
     pitchBuffer.setSize(2, samplesPerBlock);
+    pitchCurve.assign(static_cast<size_t>(samplesPerBlock), 0.0f);
+    ratioCurve.assign(static_cast<size_t>(samplesPerBlock), 1.0f);
+    channelPitchCurves.setSize(maxChannels, samplesPerBlock);
+    channelRatioCurves.setSize(maxChannels, samplesPerBlock);
+    correctionRatios.fill(1.0f);
+    
+    // One worker per channel beyond the first; idle unless the host renders offline
+    if (offlineRenderPool == nullptr)
+        offlineRenderPool = std::make_unique<ThreadPool>(maxChannels - 1);
     correctedBuffer.setSize(2, samplesPerBlock);
     overlapBuffer.setSize(2, overlapSize);
     fftBuffer.setSize(1, fftSize);
@@ -74,28 +119,20 @@ void AutoTuneAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBloc
     
     speedSmoothed.setCurrentAndTargetValue(*parameters.getRawParameterValue(Parameters::SPEED_ID));
     amountSmoothed.setCurrentAndTargetValue(*parameters.getRawParameterValue(Parameters::AMOUNT_ID));
-
-#ifdef USE_RUBBERBAND
-    // Initialize Rubber Band stretcher
-    rubberBand = std::make_unique<RubberBand::RubberBandStretcher>(
-        sampleRate, 2,
-        RubberBand::RubberBandStretcher::OptionProcessRealTime |
-        RubberBand::RubberBandStretcher::OptionPitchHighQuality |
-        RubberBand::RubberBandStretcher::OptionEngineFiner  // R3 engine for setPitchScale()
-    );
-#endif
 }
 
 void AutoTuneAudioProcessor::releaseResources()
 {
+    inferenceWorker.release();
     pitchBuffer.setSize(0, 0);
+    pitchCurve.clear();
+    ratioCurve.clear();
+    channelPitchCurves.setSize(0, 0);
+    channelRatioCurves.setSize(0, 0);
+    lookaheadBuffer.setSize(0, 0);
     correctedBuffer.setSize(0, 0);
     overlapBuffer.setSize(0, 0);
     fftBuffer.setSize(0, 0);
-
-#ifdef USE_RUBBERBAND
-    rubberBand.reset();
-#endif
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -144,6 +181,8 @@ void AutoTuneAudioProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer
         static_cast<int>(*parameters.getRawParameterValue(Parameters::MODE_ID))
     );
 
+    updateLookahead(currentMode);
+
     // Process based on selected mode
     switch (currentMode)
     {
@@ -157,12 +196,123 @@ void AutoTuneAudioProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer
             processAIMode(buffer);
             break;
     }
+    
+    samplePosition += buffer.getNumSamples();
+}
+
+bool AutoTuneAudioProcessor::updateStereoLink(int numChannels)
+{
+    const bool shouldLink = numChannels == 2
+        && *parameters.getRawParameterValue(Parameters::STEREO_LINK_ID) > 0.5f;
+    
+    // Linked analysis runs on the first engine only, so both engines restart from a
+    // clean history whenever the routing changes
+    if (shouldLink != stereoLinkActive)
+    {
+        stereoLinkActive = shouldLink;
+        
+        for (auto& engine : pitchEngines)
+            engine.reset();
+        
+        for (auto& delay : lookaheadPitchDelays)
+            delay.reset();
+        
+        correctionRatios.fill(1.0f);
+    }
+    
+    return stereoLinkActive;
+}
+
+const float* AutoTuneAudioProcessor::getLinkedAnalysisInput(const AudioBuffer<float>& buffer)
+{
+    const int numSamples = buffer.getNumSamples();
+    
+    if (pitchBuffer.getNumSamples() < numSamples)
+        pitchBuffer.setSize(2, numSamples, false, false, true);
+    
+    auto* mid = pitchBuffer.getWritePointer(0);
+    FloatVectorOperations::add(mid, buffer.getReadPointer(0), buffer.getReadPointer(1), numSamples);
+    FloatVectorOperations::multiply(mid, 0.5f, numSamples);
+    
+    // Material that is largely out of phase cancels in the mid sum; analyse the louder side then
+    const float leftLevel = buffer.getRMSLevel(0, 0, numSamples);
+    const float rightLevel = buffer.getRMSLevel(1, 0, numSamples);
+    
+    if (pitchBuffer.getRMSLevel(0, 0, numSamples) < 0.5f * jmax(leftLevel, rightLevel))
+        return buffer.getReadPointer(leftLevel >= rightLevel ? 0 : 1);
+    
+    return mid;
+}
+
+void AutoTuneAudioProcessor::ensurePitchCurveSize(int numSamples)
+{
+    // Hosts may exceed the prepared block size; grow rather than overrun
+    if (pitchCurve.size() < static_cast<size_t>(numSamples))
+    {
+        pitchCurve.resize(static_cast<size_t>(numSamples), 0.0f);
+        ratioCurve.resize(static_cast<size_t>(numSamples), 1.0f);
+    }
+    
+    if (channelPitchCurves.getNumSamples() < numSamples)
+    {
+        channelPitchCurves.setSize(maxChannels, numSamples, false, false, true);
+        channelRatioCurves.setSize(maxChannels, numSamples, false, false, true);
+        lookaheadBuffer.setSize(maxChannels, numSamples, false, false, true);
+    }
+}
+
+float AutoTuneAudioProcessor::getRetuneSeconds(float speed) const
+{
+    // Exponential so each step of the Speed control feels alike: 0% glides, 100% snaps
+    const float normalisedSpeed = jlimit(0.0f, 1.0f, speed / Parameters::SPEED_MAX);
+    return slowestRetuneSeconds * std::pow(fastestRetuneSeconds / slowestRetuneSeconds, normalisedSpeed);
+}
+
+void AutoTuneAudioProcessor::buildRatioCurve(int numSamples, Parameters::Key key, Parameters::Scale scale,
+                                             float amount, float retuneSeconds, float& ratioState)
+{
+    const float glide = retuneSeconds > 0.0f
+        ? 1.0f - std::exp(-1.0f / (retuneSeconds * static_cast<float>(currentSampleRate)))
+        : 1.0f;
+    const float strength = jlimit(0.0f, 1.0f, amount / Parameters::AMOUNT_MAX);
+    
+    // Detection holds its pitch for a whole hop, so the scale lookup only runs when it changes
+    float lastPitch = -1.0f;
+    float targetRatio = 1.0f;
+    
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+        const float currentPitch = pitchCurve[static_cast<size_t>(sample)];
+        
+        if (currentPitch != lastPitch)
+        {
+            lastPitch = currentPitch;
+            targetRatio = 1.0f;
+            
+            if (currentPitch > 0.0f) // Valid pitch detected
+            {
+                float targetNote = Utils::quantizeToScale(Utils::frequencyToMidiNote(currentPitch), key, scale);
+                float targetFrequency = Utils::midiNoteToFrequency(targetNote);
+                
+                // Amount moves the pitch part of the way to the note, in log-frequency
+                targetRatio = std::pow(targetFrequency / currentPitch, strength);
+            }
+        }
+        
+        ratioState += (targetRatio - ratioState) * glide;
+        
+        // Land exactly on unity so the shifter can settle into a clean delay
+        if (targetRatio == 1.0f && std::abs(ratioState - 1.0f) < 1.0e-5f)
+            ratioState = 1.0f;
+        
+        ratioCurve[static_cast<size_t>(sample)] = ratioState;
+    }
 }
 
 void AutoTuneAudioProcessor::processClassicMode(AudioBuffer<float>& buffer)
 {
     const int numSamples = buffer.getNumSamples();
-    const int numChannels = buffer.getNumChannels();
+    const int numChannels = jmin(buffer.getNumChannels(), maxChannels);
 
     // Get parameter values
     float speed = speedSmoothed.getNextValue();
@@ -174,51 +324,45 @@ void AutoTuneAudioProcessor::processClassicMode(AudioBuffer<float>& buffer)
         static_cast<int>(*parameters.getRawParameterValue(Parameters::SCALE_ID))
     );
 
+    for (auto& engine : pitchEngines)
+        engine.setAnalysisHopSize(defaultAnalysisHopSize);
+    
+    const bool linked = updateStereoLink(numChannels);
+    const float retuneSeconds = getRetuneSeconds(speed);
+    ensurePitchCurveSize(numSamples);
+    
+    if (linked)
+    {
+        pitchEngines[0].detectPitch(getLinkedAnalysisInput(buffer), numSamples, pitchCurve.data());
+        delayPitchCurveForLookahead(0, numSamples, ModeSelector::PitchAlgorithm::Autocorrelation);
+        buildRatioCurve(numSamples, key, scale, amount, retuneSeconds, correctionRatios[0]);
+    }
+    
     // Process each channel
     for (int channel = 0; channel < numChannels; ++channel)
     {
         auto* channelData = buffer.getWritePointer(channel);
+        auto& pitchEngine = pitchEngines[static_cast<size_t>(channel)];
         
-        // Pitch detection and correction
-        std::vector<float> pitches(numSamples);
-        pitchEngine.detectPitch(channelData, numSamples, pitches.data());
-        
-        // Apply pitch correction
-        for (int sample = 0; sample < numSamples; ++sample)
+        // Pitch detection produces the block's correction curve
+        if (!linked)
         {
-            float currentPitch = pitches[sample];
-            
-            if (currentPitch > 0.0f) // Valid pitch detected
-            {
-                // Convert to MIDI note number
-                float midiNote = Utils::frequencyToMidiNote(currentPitch);
-                
-                // Quantize to scale
-                float targetNote = Utils::quantizeToScale(midiNote, key, scale);
-                float targetFrequency = Utils::midiNoteToFrequency(targetNote);
-                
-                // Calculate correction amount
-                float correction = (targetFrequency - currentPitch) * amount;
-                
-                // Apply smooth correction with speed control
-                float smoothedCorrection = correction * speed * 0.1f; // Scale speed appropriately
-                
-                // REAL PITCH SHIFTING using phase vocoder technique
-                float pitchRatio = targetFrequency / currentPitch;
-                if (std::abs(pitchRatio - 1.0f) > 0.01f) // Only shift if needed
-                {
-                    // Apply real-time pitch shifting using granular synthesis
-                    pitchEngine.correctPitch(&channelData[sample], 1, targetFrequency, speed, amount);
-                }
-            }
+            pitchEngine.detectPitch(channelData, numSamples, pitchCurve.data());
+            delayPitchCurveForLookahead(channel, numSamples, ModeSelector::PitchAlgorithm::Autocorrelation);
+            buildRatioCurve(numSamples, key, scale, amount, retuneSeconds,
+                            correctionRatios[static_cast<size_t>(channel)]);
         }
+        
+        // Shift the whole block along the curve in one pass, pitch-synchronously
+        pitchEngine.process(getLookaheadInput(channel, channelData, numSamples), channelData,
+                            numSamples, ratioCurve.data(), pitchCurve.data());
     }
 }
 
 void AutoTuneAudioProcessor::processHardMode(AudioBuffer<float>& buffer)
 {
     const int numSamples = buffer.getNumSamples();
-    const int numChannels = buffer.getNumChannels();
+    const int numChannels = jmin(buffer.getNumChannels(), maxChannels);
 
     // Get parameter values
     float speed = speedSmoothed.getNextValue();
@@ -230,46 +374,47 @@ void AutoTuneAudioProcessor::processHardMode(AudioBuffer<float>& buffer)
         static_cast<int>(*parameters.getRawParameterValue(Parameters::SCALE_ID))
     );
 
+    // Hard mode tracks with a finer analysis hop for faster note snapping
+    for (auto& engine : pitchEngines)
+        engine.setAnalysisHopSize(hardModeAnalysisHopSize);
+    
+    const bool linked = updateStereoLink(numChannels);
+    
     // Hard mode applies immediate, aggressive correction
+    const float retuneSeconds = getRetuneSeconds(speed) * hardModeRetuneScale;
+    ensurePitchCurveSize(numSamples);
+    
+    if (linked)
+    {
+        pitchEngines[0].detectPitch(getLinkedAnalysisInput(buffer), numSamples, pitchCurve.data());
+        delayPitchCurveForLookahead(0, numSamples, ModeSelector::PitchAlgorithm::Autocorrelation);
+        buildRatioCurve(numSamples, key, scale, amount, retuneSeconds, correctionRatios[0]);
+    }
+    
     for (int channel = 0; channel < numChannels; ++channel)
     {
         auto* channelData = buffer.getWritePointer(channel);
+        auto& pitchEngine = pitchEngines[static_cast<size_t>(channel)];
         
         // Detect pitch
-        std::vector<float> pitches(numSamples);
-        pitchEngine.detectPitch(channelData, numSamples, pitches.data());
-        
-        // Apply hard correction
-        for (int sample = 0; sample < numSamples; ++sample)
+        if (!linked)
         {
-            float currentPitch = pitches[sample];
-            
-            if (currentPitch > 0.0f)
-            {
-                float midiNote = Utils::frequencyToMidiNote(currentPitch);
-                float targetNote = Utils::quantizeToScale(midiNote, key, scale);
-                float targetFrequency = Utils::midiNoteToFrequency(targetNote);
-                
-                // Hard correction - immediate snap to target
-                float correction = (targetFrequency - currentPitch) * amount;
-                float hardCorrection = correction * jmin(speed * 10.0f, 1.0f); // Faster, harder correction
-                
-                // HARD MODE: Instant pitch snapping
-                float pitchRatio = targetFrequency / currentPitch;
-                if (std::abs(pitchRatio - 1.0f) > 0.005f) // Aggressive threshold
-                {
-                    // Hard snap to target with formant preservation
-                    pitchEngine.correctPitchHard(&channelData[sample], 1, targetFrequency, speed, amount);
-                }
-            }
+            pitchEngine.detectPitch(channelData, numSamples, pitchCurve.data());
+            delayPitchCurveForLookahead(channel, numSamples, ModeSelector::PitchAlgorithm::Autocorrelation);
+            buildRatioCurve(numSamples, key, scale, amount, retuneSeconds,
+                            correctionRatios[static_cast<size_t>(channel)]);
         }
+        
+        // Apply hard correction
+        pitchEngine.process(getLookaheadInput(channel, channelData, numSamples), channelData,
+                            numSamples, ratioCurve.data(), pitchCurve.data());
     }
 }
 
 void AutoTuneAudioProcessor::processAIMode(AudioBuffer<float>& buffer)
 {
     const int numSamples = buffer.getNumSamples();
-    const int numChannels = buffer.getNumChannels();
+    const int numChannels = jmin(buffer.getNumChannels(), maxChannels);
 
     // Get parameter values
     float speed = speedSmoothed.getNextValue();
@@ -280,86 +425,117 @@ void AutoTuneAudioProcessor::processAIMode(AudioBuffer<float>& buffer)
     auto scale = static_cast<Parameters::Scale>(
         static_cast<int>(*parameters.getRawParameterValue(Parameters::SCALE_ID))
     );
+    
+    // The quality level picks the shifter; engines switch with a crossfade at the next block.
+    // Offline bounces have no deadline, so they always get the best engine and finer tracking.
+    const bool offline = isNonRealtime();
+    const float formantShift = std::pow(2.0f, *parameters.getRawParameterValue(Parameters::FORMANT_ID) / 12.0f);
+    
+    modeSelector.setQualityLevel(offline ? ModeSelector::QualityLevel::Ultra
+                                         : static_cast<ModeSelector::QualityLevel>(
+                                               static_cast<int>(*parameters.getRawParameterValue(Parameters::QUALITY_ID))));
 
-    // AI-enhanced processing with CREPE/DDSP integration
+    for (auto& engine : pitchEngines)
+    {
+        engine.setAnalysisHopSize(offline ? offlineAnalysisHopSize : defaultAnalysisHopSize);
+        engine.setShifterEngine(modeSelector.getShifterEngine());
+        engine.setFormantShift(formantShift);
+    }
+    
+    const bool linked = updateStereoLink(numChannels);
+    
+    // AI mode glides more gently than Classic for a natural result
+    const float retuneSeconds = getRetuneSeconds(speed) * aiModeRetuneScale;
+    ensurePitchCurveSize(numSamples);
+    
+    if (linked)
+    {
+        trackAIModePitch(0, getLinkedAnalysisInput(buffer), numSamples);
+        buildRatioCurve(numSamples, key, scale, amount, retuneSeconds, correctionRatios[0]);
+    }
+    
+    // Each channel's curves are kept for the shifter pass, which runs after every channel
+    // has been analysed
     for (int channel = 0; channel < numChannels; ++channel)
     {
         auto* channelData = buffer.getWritePointer(channel);
         
-        if (aiModelLoader.areModelsLoaded())
+        if (!linked)
         {
-            // Use AI models for pitch detection and synthesis
-            auto pitchPrediction = aiModelLoader.predictPitch(channelData, numSamples, currentSampleRate);
-            
-            if (pitchPrediction.confidence > 0.3f) // Only process if confident
-            {
-                float currentPitch = pitchPrediction.frequency;
-                float midiNote = Utils::frequencyToMidiNote(currentPitch);
-                float targetNote = Utils::quantizeToScale(midiNote, key, scale);
-                float targetFrequency = Utils::midiNoteToFrequency(targetNote);
-                
-                // Create synthesis parameters for DDSP
-                AIModelLoader::SynthesisParams synthParams;
-                synthParams.fundamentalFreq = targetFrequency;
-                synthParams.harmonicAmplitudes = pitchPrediction.harmonics;
-                synthParams.loudness = amount * 0.01f;
-                
-                // Process with DDSP for natural-sounding correction
-                std::vector<float> tempBuffer(numSamples);
-                std::copy(channelData, channelData + numSamples, tempBuffer.begin());
-                
-                if (aiModelLoader.processWithDDSP(tempBuffer.data(), channelData, numSamples, synthParams))
-                {
-                    // Blend original and AI-processed audio based on speed parameter
-                    float blendFactor = speed * 0.01f;
-                    for (int i = 0; i < numSamples; ++i)
-                    {
-                        channelData[i] = tempBuffer[i] * (1.0f - blendFactor) + channelData[i] * blendFactor;
-                    }
-                }
-            }
+            trackAIModePitch(channel, channelData, numSamples);
+            buildRatioCurve(numSamples, key, scale, amount, retuneSeconds,
+                            correctionRatios[static_cast<size_t>(channel)]);
         }
-        else
+        
+        channelPitchCurves.copyFrom(channel, 0, pitchCurve.data(), numSamples);
+        channelRatioCurves.copyFrom(channel, 0, ratioCurve.data(), numSamples);
+        
+        aiShifterInputs[static_cast<size_t>(channel)] = getLookaheadInput(channel, channelData, numSamples);
+    }
+    
+    runAIModeShifters(buffer, numChannels);
+}
+
+void AutoTuneAudioProcessor::trackAIModePitch(int stream, const float* analysisInput, int numSamples)
+{
+    // The tracked detector always runs: the phase vocoder reuses its frames, and its pitch
+    // stands wherever CREPE has no result in time. The model's pitch is read off the worker
+    // thread's latest results, never computed here. With a model loaded both are read
+    // lookaheadSamples behind, which then covers the model's lag, so a handover between them
+    // keeps the note's timing; without one the worker is left idle.
+    const auto algorithm = modeSelector.getPitchAlgorithm(Parameters::Mode::AI);
+    
+    pitchEngines[static_cast<size_t>(stream)].detectPitch(analysisInput, numSamples, pitchCurve.data(), algorithm);
+    delayPitchCurveForLookahead(stream, numSamples, algorithm);
+    
+    if (!crepeLagActive)
+        return;
+    
+    inferenceWorker.pushAudio(stream, analysisInput, numSamples, samplePosition);
+    inferenceWorker.readPitchCurve(stream, pitchCurve.data(), numSamples, samplePosition,
+                                   lookaheadSamples, isNonRealtime());
+}
+
+void AutoTuneAudioProcessor::runAIModeShifters(AudioBuffer<float>& buffer, int numChannels)
+{
+    // The quality level's shifter (ModeSelector::getShifterEngine); the phase vocoder reuses
+    // the detector's FFT frames when it analysed this channel
+    const int numSamples = buffer.getNumSamples();
+    float* const* channels = buffer.getArrayOfWritePointers();
+    
+    auto shiftChannel = [this, channels, numSamples] (int channel)
+    {
+        pitchEngines[static_cast<size_t>(channel)].processShifterEngine(
+            aiShifterInputs[static_cast<size_t>(channel)], channels[channel], numSamples,
+            channelRatioCurves.getReadPointer(channel), channelPitchCurves.getReadPointer(channel));
+    };
+    
+    // Engines share no state, so offline the other channels shift on workers while this
+    // thread takes the first; realtime stays on the audio thread
+    if (isNonRealtime() && offlineRenderPool != nullptr && numChannels > 1)
+    {
+        offlineChannelsDone.reset();
+        pendingOfflineChannels = numChannels - 1;
+        
+        for (int channel = 1; channel < numChannels; ++channel)
         {
-            // Fallback to advanced pitch detection without AI models
-            std::vector<float> pitches(numSamples);
-            pitchEngine.detectPitchAdvanced(channelData, numSamples, pitches.data());
-            
-            // AI-style correction with formant preservation
-            for (int sample = 0; sample < numSamples; ++sample)
+            offlineRenderPool->addJob([this, shiftChannel, channel]
             {
-                float currentPitch = pitches[sample];
+                shiftChannel(channel);
                 
-                if (currentPitch > 0.0f)
-                {
-                    float midiNote = Utils::frequencyToMidiNote(currentPitch);
-                    float targetNote = Utils::quantizeToScale(midiNote, key, scale);
-                    float targetFrequency = Utils::midiNoteToFrequency(targetNote);
-                    
-                    // AI-style smooth correction with natural timing
-                    float pitchDiff = std::abs(targetFrequency - currentPitch);
-                    float aiSpeed = speed * (1.0f - std::exp(-pitchDiff * 0.1f)); // Adaptive speed
-                    float correction = (targetFrequency - currentPitch) * amount * aiSpeed * 0.01f;
-                    
-                    // Apply with formant considerations (simplified)
-                    channelData[sample] *= (1.0f + correction * 0.005f);
-                }
-            }
+                if (--pendingOfflineChannels == 0)
+                    offlineChannelsDone.signal();
+            });
         }
+        
+        shiftChannel(0);
+        offlineChannelsDone.wait();
     }
-
-#ifdef USE_RUBBERBAND
-    // Use Rubber Band for high-quality time/pitch manipulation in AI mode
-    if (rubberBand)
+    else
     {
-        // Configure rubber band for pitch shifting
-        float pitchShift = amount * 0.1f; // Convert amount to pitch shift ratio
-        rubberBand->setPitchScale(1.0f + pitchShift);
-        
-        // Process through rubber band (simplified integration)
-        // Real implementation would handle proper buffering and processing
+        for (int channel = 0; channel < numChannels; ++channel)
+            shiftChannel(channel);
     }
-#endif
 }
 
 void AutoTuneAudioProcessor::parameterChanged(const String& parameterID, float newValue)
@@ -377,7 +553,113 @@ void AutoTuneAudioProcessor::parameterChanged(const String& parameterID, float n
         // Mode changed - could trigger additional setup
         auto newMode = static_cast<Parameters::Mode>(static_cast<int>(newValue));
         modeSelector.setCurrentMode(newMode);
+        updateReportedLatency(newMode);
+    }
+    else if (parameterID == Parameters::LOOKAHEAD_ID)
+    {
+        // The delay itself follows at the next block; hosts need the new PDC now
+        updateReportedLatency(static_cast<Parameters::Mode>(
+            static_cast<int>(*parameters.getRawParameterValue(Parameters::MODE_ID))));
     }
+    else if (parameterID == Parameters::QUALITY_ID)
+    {
+        // May be the audio thread; swapping the CREPE variant loads a model
+        triggerAsyncUpdate();
+    }
+}
+
+AIModelLoader::ProcessingQuality AutoTuneAudioProcessor::getModelQuality() const
+{
+    return static_cast<AIModelLoader::ProcessingQuality>(
+        static_cast<int>(*parameters.getRawParameterValue(Parameters::QUALITY_ID)));
+}
+
+void AutoTuneAudioProcessor::handleAsyncUpdate()
+{
+    // A new tier changes the CREPE hop at once and the model variant when one is loaded; the
+    // inference worker picks up both on its next tick
+    aiModelLoader.setProcessingQuality(getModelQuality());
+    
+    // Also reached when a CREPE model was loaded or unloaded, which moves AI mode's lag
+    updateReportedLatency(static_cast<Parameters::Mode>(
+        static_cast<int>(*parameters.getRawParameterValue(Parameters::MODE_ID))));
+}
+
+void AutoTuneAudioProcessor::updateReportedLatency(Parameters::Mode mode)
+{
+    // AI mode shifts with the quality level's engine, all of which share one latency so the
+    // Quality parameter never changes it; the others use the time-domain shifters. Hosts
+    // compensate the reported delay (PDC).
+    const auto& engine = pitchEngines[0];
+    const int shifterLatency = mode != Parameters::Mode::AI ? engine.getLatencySamples()
+                                                            : engine.getShifterEngineLatencySamples();
+    
+    const bool modelLoaded = aiModelLoader.isCrepeModelLoaded();
+    reportedCrepeLag = modelLoaded;
+    
+    setLatencySamples(shifterLatency + getLookaheadSamples(mode, modelLoaded));
+}
+
+int AutoTuneAudioProcessor::getLookaheadSamples(Parameters::Mode mode, bool crepeModelLoaded) const
+{
+    const float milliseconds = *parameters.getRawParameterValue(Parameters::LOOKAHEAD_ID);
+    const int lookahead = roundToInt(jlimit(Parameters::LOOKAHEAD_MIN, Parameters::LOOKAHEAD_MAX, milliseconds) * 0.001 * currentSampleRate);
+    
+    // With a CREPE model, AI mode holds the audio back until the model's pitch for it is in,
+    // at any quality tier's hop, so that pitch lines up with the audio it was taken from.
+    // Without one the DSP detector is all there is, and the lag would buy nothing.
+    if (mode != Parameters::Mode::AI || !crepeModelLoaded)
+        return lookahead;
+    
+    return jmax(lookahead, inferenceWorker.getMaxLatencySamples());
+}
+
+void AutoTuneAudioProcessor::updateLookahead(Parameters::Mode mode)
+{
+    crepeLagActive = mode == Parameters::Mode::AI && aiModelLoader.isCrepeModelLoaded();
+    
+    // A model loaded or unloaded since the latency was reported: hosts hear of it from the
+    // message thread
+    if (mode == Parameters::Mode::AI && crepeLagActive != reportedCrepeLag.load())
+        triggerAsyncUpdate();
+    
+    const int newLookahead = getLookaheadSamples(mode, crepeLagActive);
+    
+    if (newLookahead == lookaheadSamples)
+        return;
+    
+    lookaheadSamples = newLookahead;
+    
+    for (auto& delay : lookaheadAudioDelays)
+        delay.setDelay(lookaheadSamples);
+}
+
+void AutoTuneAudioProcessor::delayPitchCurveForLookahead(int stream, int numSamples, ModeSelector::PitchAlgorithm algorithm)
+{
+    // The detector already lags the audio; only a lookahead beyond that lag holds the curve
+    // back, so correction never leads the note it belongs to
+    const auto index = static_cast<size_t>(stream);
+    auto& delay = lookaheadPitchDelays[index];
+    
+    delay.setDelay(jmax(0, lookaheadSamples - pitchEngines[index].getDetectionLatencySamples(algorithm)));
+    delay.process(pitchCurve.data(), pitchCurve.data(), numSamples);
+}
+
+const float* AutoTuneAudioProcessor::getLookaheadInput(int channel, float* channelData, int numSamples)
+{
+    auto& delay = lookaheadAudioDelays[static_cast<size_t>(channel)];
+    
+    // Without lookahead the shifter keeps reading the analysed buffer, so the phase vocoder
+    // can still reuse the detector's frames; the ring is kept current either way
+    if (delay.getDelay() == 0)
+    {
+        delay.process(channelData, channelData, numSamples);
+        return channelData;
+    }
+    
+    float* delayed = lookaheadBuffer.getWritePointer(channel);
+    delay.process(channelData, delayed, numSamples);
+    return delayed;
 }
 
 AudioProcessorEditor* AutoTuneAudioProcessor::createEditor()
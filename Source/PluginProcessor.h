@@ -1,19 +1,19 @@
 #pragma once
 
 #include "JuceHeader.h"
+#include <atomic>
 #include <memory>
 #include "PitchCorrectionEngine.h"
 #include "Parameters.h"
 #include "PresetManager.h"
 #include "ModeSelector.h"
 #include "AIModelLoader.h"
-
-#ifdef USE_RUBBERBAND
-#include <rubberband/RubberBandStretcher.h>
-#endif
+#include "InferenceWorker.h"
+#include "LookaheadDelay.h"
 
 class AutoTuneAudioProcessor : public AudioProcessor,
-                                public AudioProcessorValueTreeState::Listener
+                                public AudioProcessorValueTreeState::Listener,
+                                private AsyncUpdater
 {
 public:
     AutoTuneAudioProcessor();
@@ -55,7 +55,7 @@ public:
     AudioProcessorValueTreeState& getValueTreeState() { return parameters; }
     Parameters& getParameters() { return pluginParameters; }
     PresetManager& getPresetManager() { return presetManager; }
-    PitchCorrectionEngine& getPitchEngine() { return pitchEngine; }
+    PitchCorrectionEngine& getPitchEngine() { return pitchEngines[0]; }
     AIModelLoader& getAIModelLoader() { return aiModelLoader; }
 
 private:
@@ -63,16 +63,38 @@ private:
     Parameters pluginParameters;                       // Must be initialized BEFORE parameters
     AudioProcessorValueTreeState parameters;
     PresetManager presetManager;
-    PitchCorrectionEngine pitchEngine;
+    static constexpr int maxChannels = 2;
+    std::array<PitchCorrectionEngine, maxChannels> pitchEngines;
     ModeSelector modeSelector;
     AIModelLoader aiModelLoader;
+    InferenceWorker inferenceWorker { aiModelLoader };  // CREPE off the audio thread, AI mode only
 
     // Audio processing variables
     double currentSampleRate = 44100.0;
     int currentBlockSize = 512;
+    int64 samplePosition = 0;            // Samples processed so far; timestamps the model's input
     
     // Pitch detection buffers
-    AudioBuffer<float> pitchBuffer;
+    AudioBuffer<float> pitchBuffer;      // Channel 0 holds the mid sum for linked analysis
+    std::vector<float> pitchCurve;       // Detected pitch per sample for the current block
+    std::vector<float> ratioCurve;       // Correction ratio per sample fed to the block shifter
+    std::array<float, maxChannels> correctionRatios {}; // Ratio glide state, one per channel
+    AudioBuffer<float> channelPitchCurves;  // AI mode: each channel's curves, kept for the shifter pass
+    AudioBuffer<float> channelRatioCurves;
+    
+    // Lookahead: the shifters get the audio this much after the detector does, and the pitch
+    // curve is held back by whatever the detector's own delay leaves, so a retune starts at
+    // the note it belongs to. With a CREPE model loaded, AI mode stretches the delay to the
+    // inference worker's lag, so the model's pitch and the detector's share one time base.
+    // Audio delays are per channel, pitch delays per analysis stream.
+    std::array<LookaheadDelay, maxChannels> lookaheadAudioDelays;
+    std::array<LookaheadDelay, maxChannels> lookaheadPitchDelays;
+    AudioBuffer<float> lookaheadBuffer;     // Delayed input handed to the shifters
+    std::array<const float*, maxChannels> aiShifterInputs {};
+    int lookaheadSamples = 0;
+    bool crepeLagActive = false;                // AI mode with a model: this block's lag covers it
+    std::atomic<bool> reportedCrepeLag { false };  // Whether the reported latency includes that lag
+    bool stereoLinkActive = false;
     AudioBuffer<float> correctedBuffer;
     
     // Circular buffer for overlap-add processing
@@ -88,19 +110,52 @@ private:
     static constexpr int fftOrder = 11; // 2^11 = 2048
     static constexpr int fftSize = 1 << fftOrder;
 
+    // Pitch analysis hop sizes per mode
+    static constexpr int defaultAnalysisHopSize = 128;
+    static constexpr int hardModeAnalysisHopSize = 32;
+    
+    // Retune time for the Speed control, and how each mode scales it
+    static constexpr float slowestRetuneSeconds = 0.4f;
+    static constexpr float fastestRetuneSeconds = 0.005f;
+    static constexpr float hardModeRetuneScale = 0.1f;
+    static constexpr float aiModeRetuneScale = 2.0f;
+
+    // Offline bounces: Ultra shifter, finer pitch tracking, and the channels' shifters
+    // spread over worker threads (the host waits for the whole render anyway)
+    static constexpr int offlineAnalysisHopSize = 32;
+    std::unique_ptr<ThreadPool> offlineRenderPool;
+    std::atomic<int> pendingOfflineChannels { 0 };
+    WaitableEvent offlineChannelsDone;
+
     // Smoothing filters for parameters
     SmoothedValue<float> speedSmoothed;
     SmoothedValue<float> amountSmoothed;
 
-#ifdef USE_RUBBERBAND
-    std::unique_ptr<RubberBand::RubberBandStretcher> rubberBand;
-#endif
-
     // Processing methods
     void processClassicMode(AudioBuffer<float>& buffer);
     void processHardMode(AudioBuffer<float>& buffer);
     void processAIMode(AudioBuffer<float>& buffer);
     
+    // Stereo link: one analysis on the mid signal drives the correction of both channels
+    bool updateStereoLink(int numChannels);
+    const float* getLinkedAnalysisInput(const AudioBuffer<float>& buffer);
+    void ensurePitchCurveSize(int numSamples);
+    void updateReportedLatency(Parameters::Mode mode);
+    AIModelLoader::ProcessingQuality getModelQuality() const;
+    void handleAsyncUpdate() override;
+    void runAIModeShifters(AudioBuffer<float>& buffer, int numChannels);
+    void trackAIModePitch(int stream, const float* analysisInput, int numSamples);
+    
+    int getLookaheadSamples(Parameters::Mode mode, bool crepeModelLoaded) const;
+    void updateLookahead(Parameters::Mode mode);
+    void delayPitchCurveForLookahead(int stream, int numSamples, ModeSelector::PitchAlgorithm algorithm);
+    const float* getLookaheadInput(int channel, float* channelData, int numSamples);
+    
+    // Turns pitchCurve into ratioCurve: scale-quantised target, Amount and a retune glide
+    float getRetuneSeconds(float speed) const;
+    void buildRatioCurve(int numSamples, Parameters::Key key, Parameters::Scale scale,
+                         float amount, float retuneSeconds, float& ratioState);
+    
     void performPitchCorrection(AudioBuffer<float>& buffer, 
                                float speed, float amount, 
                                Parameters::Key key, Parameters::Scale scale);
@@ -108,5 +163,8 @@ private:
     void applyOverlapAdd(AudioBuffer<float>& buffer, 
                         const AudioBuffer<float>& processedBuffer);
 
+    // Tests reach the stereo link and the per-channel curves through this (Tests/AutoTuneAudioProcessorProbe.h)
+    friend struct AutoTuneAudioProcessorProbe;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AutoTuneAudioProcessor)
 };
@@ -0,0 +1,61 @@
+#include "PolyphaseDecimator.h"
+#include "DSPKernels.h"
+#include <algorithm>
+
+void PolyphaseDecimator::prepare(double inputSampleRate, int newFactor, int tapsPerPhase)
+{
+    factor = jmax(1, newFactor);
+    outputSampleRate = inputSampleRate / factor;
+    numTaps = factor > 1 ? factor * jmax(4, tapsPerPhase) : 1;
+
+    if (factor > 1)
+    {
+        // Cutoff just below the output Nyquist; aliasing can only fold into the
+        // top of the decimated band, well above any vocal fundamental
+        auto design = dsp::FilterDesign<float>::designFIRLowpassWindowMethod(
+            static_cast<float>(0.45 * outputSampleRate), inputSampleRate,
+            static_cast<size_t>(numTaps - 1), dsp::WindowingFunction<float>::kaiser, 8.0f);
+
+        const float* designed = design->getRawCoefficients();
+        coefficients.assign(designed, designed + numTaps);
+        std::reverse(coefficients.begin(), coefficients.end());
+    }
+    else
+    {
+        coefficients.assign(1, 1.0f);
+    }
+
+    history.assign(static_cast<size_t>(numTaps) * 2, 0.0f);
+    reset();
+}
+
+void PolyphaseDecimator::reset()
+{
+    std::fill(history.begin(), history.end(), 0.0f);
+    writePos = 0;
+    samplesUntilOutput = factor;
+}
+
+int PolyphaseDecimator::process(const float* input, int numSamples, float* output)
+{
+    if (history.empty()) return 0;
+
+    int numOutputs = 0;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        history[writePos] = input[i];
+        history[writePos + numTaps] = input[i];
+        writePos = (writePos + 1) % numTaps;
+
+        if (--samplesUntilOutput == 0)
+        {
+            samplesUntilOutput = factor;
+
+            // Oldest-to-newest window against the reversed impulse response
+            output[numOutputs++] = DSPKernels::dotProduct(&history[writePos], coefficients.data(), numTaps);
+        }
+    }
+
+    return numOutputs;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "JuceHeader.h"
+#include "CacheAlignedVector.h"
+#include <vector>
+
+// Streaming integer-factor decimator with a Kaiser-windowed sinc anti-alias filter.
+// Only every factor-th filter output is evaluated, so the cost per input sample is
+// one polyphase branch (tapsPerPhase multiply-adds) rather than the full filter.
+class PolyphaseDecimator
+{
+public:
+    PolyphaseDecimator() = default;
+
+    // Allocates the filter and history; call from prepare, not the audio thread
+    void prepare(double inputSampleRate, int newFactor, int tapsPerPhase = 16);
+    void reset();
+
+    // Consumes numSamples inputs and writes one output per factor inputs.
+    // output must have room for numSamples / factor + 1 samples. Returns the count written.
+    int process(const float* input, int numSamples, float* output);
+
+    int getFactor() const { return factor; }
+    double getOutputSampleRate() const { return outputSampleRate; }
+
+    // Group delay of the linear-phase filter, in input samples
+    int getLatencySamples() const { return (numTaps - 1) / 2; }
+
+private:
+    std::vector<float> coefficients; // Stored time-reversed so each output is a dot product
+    CacheAlignedVector<float> history; // Written twice so the newest numTaps inputs are contiguous
+    double outputSampleRate = 0.0;
+    int factor = 1;
+    int numTaps = 0;
+    int writePos = 0;
+    int samplesUntilOutput = 1;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PolyphaseDecimator)
+};
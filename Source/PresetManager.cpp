@@ -146,6 +146,8 @@ void PresetManager::resetToDefaults()
         static_cast<float>(Parameters::KEY_DEFAULT) / 11.0f);
     parameters.getParameter(Parameters::SCALE_ID)->setValueNotifyingHost(
         static_cast<float>(Parameters::SCALE_DEFAULT) / 2.0f);
+    parameters.getParameter(Parameters::STEREO_LINK_ID)->setValueNotifyingHost(
+        Parameters::STEREO_LINK_DEFAULT ? 1.0f : 0.0f);
     
     currentPresetIndex = -1;
     
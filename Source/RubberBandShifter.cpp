@@ -0,0 +1,277 @@
+#include "RubberBandShifter.h"
+
+#ifdef USE_RUBBERBAND
+
+#include "rubberband/RubberBandStretcher.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // How far each engine's output lag swings above its unity lag while emitting whole hops
+    // under a moving pitch scale. R2's hop follows the pitch scale, so its swing scales with
+    // its start pad; R3's hops are fixed sample counts.
+    struct EngineTuning
+    {
+        RubberBand::RubberBandStretcher::Options options;
+        float swingPads;
+        int swingChunks;
+    };
+    
+    EngineTuning getTuning(RubberBandShifter::Engine engine)
+    {
+        using Stretcher = RubberBand::RubberBandStretcher;
+        
+        // High consistency is the pitch option meant for a continuously varying pitch scale
+        const Stretcher::Options common = Stretcher::OptionProcessRealTime
+                                        | Stretcher::OptionFormantPreserved
+                                        | Stretcher::OptionPitchHighConsistency;
+        
+        switch (engine)
+        {
+            case RubberBandShifter::Engine::Faster:
+                return { common | Stretcher::OptionEngineFaster, 0.8f, 0 };
+            case RubberBandShifter::Engine::FinerShort:
+                return { common | Stretcher::OptionEngineFiner | Stretcher::OptionWindowShort, 0.0f, 6 };
+            case RubberBandShifter::Engine::Finer:
+            default:
+                return { common | Stretcher::OptionEngineFiner, 0.0f, 4 };
+        }
+    }
+    
+    // Latency headroom above the swing: the staged chunk plus one spare
+    constexpr int latencyMarginChunks = 2;
+    
+    // Silent stream averaged for the unity lag: whole multiples of every engine's hop
+    constexpr int lagMeasureChunks = 64;
+    
+    // Time-ratio trim: errors within two chunks are hop jitter and left alone; beyond that
+    // the excess is removed over trimSeconds, never faster than maxTrim
+    constexpr int trimDeadbandChunks = 2;
+    constexpr double trimSeconds = 0.25;
+    constexpr double maxTrim = 0.01;
+    constexpr double lagSmoothingSeconds = 0.05;
+    
+    // Pitch-scale slew per chunk (a semitone). Octave-sized steps in a single chunk make the
+    // stretcher drop more output than the trim can win back; a few chunks of glide do not.
+    constexpr float maxScaleStep = 1.0594631f;
+    
+    // Each new pitch scale costs the stretcher a resampler update, so changes under about a
+    // cent are held back; a settled note then costs no updates at all
+    constexpr float scaleTolerance = 0.0006f;
+}
+
+RubberBandShifter::RubberBandShifter() = default;
+RubberBandShifter::~RubberBandShifter() = default;
+
+void RubberBandShifter::prepare(double newSampleRate, int maxBlockSize, Engine newEngine)
+{
+    sampleRate = newSampleRate;
+    engine = newEngine;
+    
+    const auto tuning = getTuning(engine);
+    stretcher = std::make_unique<RubberBand::RubberBandStretcher>(static_cast<size_t>(sampleRate), 1, tuning.options);
+    stretcher->setMaxProcessSize(feedSize);
+
+    // Pad and delay depend on the pitch scale; unity is where every stream starts
+    startPad = static_cast<int>(stretcher->getPreferredStartPad());
+    startDelay = static_cast<int>(stretcher->getStartDelay());
+
+    inputChunk.assign(feedSize, 0.0f);
+    retrieveBuffer.assign(retrieveSize, 0.0f);
+
+    // The trim holds the lag the stretcher settles at on its own, so unity stays aligned
+    targetLag = measureUnityLag();
+    latency = targetLag + roundToInt(tuning.swingPads * startPad) + (tuning.swingChunks + latencyMarginChunks) * feedSize;
+
+    // Holds the latency plus one host block, and a full retrieve burst on top
+    const int capacity = nextPowerOfTwo(latency + jmax(maxBlockSize, feedSize) + retrieveSize);
+    outputRing.assign(static_cast<size_t>(capacity), 0.0f);
+    outputMask = capacity - 1;
+
+    reset();
+}
+
+void RubberBandShifter::reset()
+{
+    if (stretcher == nullptr)
+        return;
+
+    stretcher->reset();
+    stretcher->setPitchScale(1.0);
+    stretcher->setTimeRatio(1.0);
+    currentPitchScale = 1.0f;
+    currentTimeRatio = 1.0;
+    currentFormantScale = 0.0;
+    stretcher->setFormantScale(0.0);
+    smoothedLag = -1.0;
+
+    std::fill(outputRing.begin(), outputRing.end(), 0.0f);
+    outputWritePos = 0;
+    outputReadPos = -latency;
+    underruns = 0;
+
+    // Silent pre-roll so the first real sample sits in a full analysis window
+    std::fill(inputChunk.begin(), inputChunk.end(), 0.0f);
+    samplesToDiscard = startDelay;
+
+    for (int padded = 0; padded < startPad; padded += feedSize)
+    {
+        const float* silence = inputChunk.data();
+        stretcher->process(&silence, static_cast<size_t>(jmin(feedSize, startPad - padded)), false);
+        drainStretcher();
+    }
+
+    stagedSamples = 0;
+    inputFedPos = 0;
+}
+
+int RubberBandShifter::measureUnityLag()
+{
+    outputRing.clear();
+    latency = 0;
+    targetLag = -1;
+    reset();
+
+    // Nothing is played (or written to the empty ring) and the trim stays off; only the
+    // positions advance
+    outputReadPos = std::numeric_limits<int64>::max();
+
+    int64 lagSum = 0;
+    int measured = 0;
+
+    while (measured < lagMeasureChunks)
+    {
+        feedChunk(1.0f);
+
+        if (samplesToDiscard == 0)
+        {
+            lagSum += inputFedPos - outputWritePos;
+            ++measured;
+        }
+    }
+
+    return static_cast<int>((lagSum + measured / 2) / measured);
+}
+
+void RubberBandShifter::process(const float* input, float* output, int numSamples, const float* ratioCurve)
+{
+    if (stretcher == nullptr)
+    {
+        if (output != input)
+            std::copy(input, input + numSamples, output);
+        return;
+    }
+
+    for (int position = 0; position < numSamples;)
+    {
+        const int piece = jmin(feedSize - stagedSamples, numSamples - position);
+        std::copy(input + position, input + position + piece, inputChunk.data() + stagedSamples);
+        stagedSamples += piece;
+
+        if (stagedSamples == feedSize)
+            feedChunk(ratioCurve[position + piece - 1]);
+
+        // Read after feeding, so in-place buffers are consumed before they are overwritten
+        for (int i = position; i < position + piece; ++i, ++outputReadPos)
+        {
+            if (outputReadPos < 0)
+            {
+                output[i] = 0.0f;
+            }
+            else if (outputReadPos < outputWritePos)
+            {
+                output[i] = outputRing[static_cast<size_t>(outputReadPos & outputMask)];
+            }
+            else
+            {
+                output[i] = 0.0f;
+                ++underruns;
+            }
+        }
+
+        position += piece;
+    }
+}
+
+void RubberBandShifter::feedChunk(float pitchScale)
+{
+    pitchScale = jlimit(currentPitchScale / maxScaleStep, currentPitchScale * maxScaleStep,
+                        jlimit(0.25f, 4.0f, pitchScale));
+
+    if (std::abs(pitchScale - currentPitchScale) > currentPitchScale * scaleTolerance)
+    {
+        stretcher->setPitchScale(pitchScale);
+        currentPitchScale = pitchScale;
+    }
+
+    // The stretcher's formant scale is relative to the shifted pitch; preserving is 1 / scale
+    const double formantScale = formantShift == 1.0f ? 0.0 : formantShift / currentPitchScale;
+
+    if (formantScale != currentFormantScale)
+    {
+        stretcher->setFormantScale(formantScale);
+        currentFormantScale = formantScale;
+    }
+
+    const float* chunk = inputChunk.data();
+    stretcher->process(&chunk, static_cast<size_t>(feedSize), false);
+    inputFedPos += feedSize;
+    stagedSamples = 0;
+
+    drainStretcher();
+    trimTimeRatio();
+}
+
+void RubberBandShifter::trimTimeRatio()
+{
+    // The lag only means something once the start delay has been trimmed off the output
+    if (samplesToDiscard > 0 || targetLag < 0)
+        return;
+    
+    const double lag = static_cast<double>(inputFedPos - outputWritePos);
+    
+    // Seeded with the measured average: a single reading can sit a whole hop off it
+    if (smoothedLag < 0.0)
+        smoothedLag = targetLag;
+    
+    smoothedLag += (lag - smoothedLag) * (feedSize / (lagSmoothingSeconds * sampleRate));
+    
+    const double error = smoothedLag - targetLag;
+    const double deadband = trimDeadbandChunks * feedSize;
+    const double excess = error > 0.0 ? jmax(0.0, error - deadband) : jmin(0.0, error + deadband);
+    
+    // Lagging behind the target wants a longer output, i.e. a time ratio above 1
+    const double timeRatio = 1.0 + jlimit(-maxTrim, maxTrim, excess / (trimSeconds * sampleRate));
+    
+    if (std::abs(timeRatio - currentTimeRatio) > 1.0e-4)
+    {
+        stretcher->setTimeRatio(timeRatio);
+        currentTimeRatio = timeRatio;
+    }
+}
+
+void RubberBandShifter::drainStretcher()
+{
+    for (int available = stretcher->available(); available > 0; available = stretcher->available())
+    {
+        float* buffer = retrieveBuffer.data();
+        const int retrieved = static_cast<int>(stretcher->retrieve(&buffer, static_cast<size_t>(jmin(available, retrieveSize))));
+
+        if (retrieved <= 0)
+            break;
+
+        const int discarded = jmin(samplesToDiscard, retrieved);
+        samplesToDiscard -= discarded;
+
+        for (int i = discarded; i < retrieved; ++i, ++outputWritePos)
+        {
+            // Samples that arrive after their slot was already played are dropped
+            if (outputWritePos >= outputReadPos)
+                outputRing[static_cast<size_t>(outputWritePos & outputMask)] = retrieveBuffer[static_cast<size_t>(i)];
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "JuceHeader.h"
+#include "CacheAlignedVector.h"
+
+#ifdef USE_RUBBERBAND
+
+#include <memory>
+#include <vector>
+
+namespace RubberBand { class RubberBandStretcher; }
+
+// Streams one channel through a real-time Rubber Band stretcher at a fixed, reportable latency.
+// The start is pre-padded and the stretcher's start delay trimmed, so its output lines up with
+// the input; input is fed in fixed chunks (one pitch scale each, from the ratio curve) and the
+// output lands in a FIFO read getLatencySamples() behind, so every call returns numSamples.
+// Abrupt pitch-scale changes cost the stretcher a fraction of a sample each; a slow time-ratio
+// trim pulls its output lag back to target so those losses never add up to an underrun.
+class RubberBandShifter
+{
+public:
+    RubberBandShifter();
+    ~RubberBandShifter();
+
+    // R2 (OptionEngineFaster), R3 with its short window, or R3 in full
+    enum class Engine
+    {
+        Faster,
+        FinerShort,
+        Finer
+    };
+
+    // Creates the stretcher and sizes the FIFOs; call from prepare, not the audio thread
+    void prepare(double sampleRate, int maxBlockSize, Engine newEngine = Engine::Finer);
+    void reset();
+
+    // input and output may be the same buffer; ratioCurve holds one pitch scale per sample
+    void process(const float* input, float* output, int numSamples, const float* ratioCurve);
+
+    // Formant envelope shift as a frequency ratio, on top of the preserved formants (R3 only;
+    // R2 keeps them in place). Takes effect from the next chunk.
+    void setFormantShift(float ratio) { formantShift = ratio; }
+
+    int getLatencySamples() const { return latency; }
+    Engine getEngine() const { return engine; }
+
+    // Output samples that were due before the stretcher produced them (played as silence)
+    int64 getUnderrunCount() const { return underruns; }
+
+private:
+    void feedChunk(float pitchScale);
+    void drainStretcher();
+    void trimTimeRatio();
+    int measureUnityLag();
+
+    std::unique_ptr<RubberBand::RubberBandStretcher> stretcher;
+    Engine engine = Engine::Finer;
+
+    // Chunk fed to the stretcher per process() call. Small chunks keep the output lag close
+    // to the stretcher's own delay and let the pitch scale follow the ratio curve.
+    static constexpr int feedSize = 64;
+    static constexpr int retrieveSize = 1024;
+
+    CacheAlignedVector<float> inputChunk;
+    std::vector<float> retrieveBuffer;
+    int stagedSamples = 0;
+    float currentPitchScale = 1.0f;
+    float formantShift = 1.0f;
+    double currentFormantScale = 0.0;  // 0: the stretcher's automatic (preserved) formants
+    int64 inputFedPos = 0;       // Real (unpadded) samples given to the stretcher
+    double smoothedLag = 0.0;    // inputFedPos - outputWritePos, averaged over ~50ms (-1 until known)
+    double currentTimeRatio = 1.0;
+
+    // Output ring indexed by absolute (aligned) sample position
+    CacheAlignedVector<float> outputRing;
+    int outputMask = 0;
+    int64 outputWritePos = 0;
+    int64 outputReadPos = 0;
+
+    int startPad = 0;
+    int startDelay = 0;
+    int samplesToDiscard = 0;
+    int targetLag = 0;           // Average unity lag, measured in prepare()
+    int latency = 0;
+    double sampleRate = 44100.0;
+    int64 underruns = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RubberBandShifter)
+};
+
+#endif
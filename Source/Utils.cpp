@@ -1,4 +1,5 @@
 #include "Utils.h"
+#include "DSPKernels.h"
 #include <algorithm>
 #include <numeric>
 
@@ -117,54 +118,6 @@ float Utils::hermiteInterpolation(float y0, float y1, float y2, float y3, float
     return ((c3 * x + c2) * x + c1) * x + c0;
 }
 
-void Utils::applyWindow(float* buffer, int numSamples, WindowType windowType)
-{
-    switch (windowType)
-    {
-        case WindowType::Rectangular:
-            // No modification needed
-            break;
-            
-        case WindowType::Hann:
-            for (int i = 0; i < numSamples; ++i)
-            {
-                float window = 0.5f * (1.0f - std::cos(TWO_PI * i / (numSamples - 1)));
-                buffer[i] *= window;
-            }
-            break;
-            
-        case WindowType::Hamming:
-            for (int i = 0; i < numSamples; ++i)
-            {
-                float window = 0.54f - 0.46f * std::cos(TWO_PI * i / (numSamples - 1));
-                buffer[i] *= window;
-            }
-            break;
-            
-        case WindowType::Blackman:
-            for (int i = 0; i < numSamples; ++i)
-            {
-                float phase = TWO_PI * i / (numSamples - 1);
-                float window = 0.42f - 0.5f * std::cos(phase) + 0.08f * std::cos(2.0f * phase);
-                buffer[i] *= window;
-            }
-            break;
-            
-        case WindowType::Kaiser:
-            // Simplified Kaiser window (beta = 5.0)
-            float beta = 5.0f;
-            float alpha = (numSamples - 1) * 0.5f;
-            
-            for (int i = 0; i < numSamples; ++i)
-            {
-                float x = (i - alpha) / alpha;
-                float window = std::cosh(beta * std::sqrt(1.0f - x * x)) / std::cosh(beta);
-                buffer[i] *= window;
-            }
-            break;
-    }
-}
-
 float Utils::detectPitchZeroCrossing(const float* buffer, int numSamples, float sampleRate)
 {
     if (numSamples < 2)
@@ -203,6 +156,22 @@ float Utils::detectPitchZeroCrossing(const float* buffer, int numSamples, float
     return sampleRate / averagePeriod;
 }
 
+float Utils::calculateZeroCrossingRate(const float* buffer, int numSamples)
+{
+    if (numSamples < 2)
+        return 0.0f;
+    
+    int crossings = 0;
+    
+    for (int i = 1; i < numSamples; ++i)
+    {
+        if ((buffer[i-1] < 0.0f) != (buffer[i] < 0.0f))
+            ++crossings;
+    }
+    
+    return static_cast<float>(crossings) / (numSamples - 1);
+}
+
 float Utils::calculateSpectralCentroid(const std::vector<float>& magnitude, float sampleRate)
 {
     if (magnitude.empty())
@@ -332,18 +301,11 @@ float Utils::calculateCorrelation(const float* buffer1, const float* buffer2, in
     if (numSamples <= 0)
         return 0.0f;
     
-    float sum1 = 0.0f, sum2 = 0.0f;
-    float sum1Sq = 0.0f, sum2Sq = 0.0f;
-    float sumProduct = 0.0f;
-    
-    for (int i = 0; i < numSamples; ++i)
-    {
-        sum1 += buffer1[i];
-        sum2 += buffer2[i];
-        sum1Sq += buffer1[i] * buffer1[i];
-        sum2Sq += buffer2[i] * buffer2[i];
-        sumProduct += buffer1[i] * buffer2[i];
-    }
+    float sum1 = DSPKernels::sum(buffer1, numSamples);
+    float sum2 = DSPKernels::sum(buffer2, numSamples);
+    float sum1Sq = DSPKernels::sumOfSquares(buffer1, numSamples);
+    float sum2Sq = DSPKernels::sumOfSquares(buffer2, numSamples);
+    float sumProduct = DSPKernels::dotProduct(buffer1, buffer2, numSamples);
     
     float n = static_cast<float>(numSamples);
     float numerator = n * sumProduct - sum1 * sum2;
@@ -377,18 +339,21 @@ void Utils::fadeInOut(float* buffer, int numSamples, int fadeLength)
 // Fast trigonometric functions using lookup tables
 void Utils::initializeLookupTables()
 {
-    static bool initialized = false;
-    if (initialized)
-        return;
-    
-    for (int i = 0; i < LOOKUP_TABLE_SIZE; ++i)
+    // Filled once by whichever thread gets here first; function-local statics are
+    // initialised thread-safely, so instances on other threads wait instead of racing
+    static const bool initialized = []
     {
-        float angle = TWO_PI * i / LOOKUP_TABLE_SIZE;
-        sinLookupTable[i] = std::sin(angle);
-        cosLookupTable[i] = std::cos(angle);
-    }
+        for (int i = 0; i < LOOKUP_TABLE_SIZE; ++i)
+        {
+            float angle = TWO_PI * i / LOOKUP_TABLE_SIZE;
+            sinLookupTable[i] = std::sin(angle);
+            cosLookupTable[i] = std::cos(angle);
+        }
+        
+        return true;
+    }();
     
-    initialized = true;
+    ignoreUnused(initialized);
 }
 
 float Utils::lookupSin(float x)
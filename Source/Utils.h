@@ -25,26 +25,14 @@ public:
     static float linearInterpolation(float x1, float y1, float x2, float y2, float x);
     static float cubicInterpolation(float y0, float y1, float y2, float y3, float x);
     static float hermiteInterpolation(float y0, float y1, float y2, float y3, float x);
-    
-    // Window type enumeration
-    enum class WindowType
-    {
-        Rectangular,
-        Hann,
-        Hamming,
-        Blackman,
-        Kaiser
-    };
-    
-    // Window functions
-    static void applyWindow(float* buffer, int numSamples, WindowType windowType);
-    
+
     // FFT utilities
     static void computeFFT(const float* input, std::complex<float>* output, int size);
     static void computeIFFT(const std::complex<float>* input, float* output, int size);
     
     // Pitch analysis utilities
     static float detectPitchZeroCrossing(const float* buffer, int numSamples, float sampleRate);
+    static float calculateZeroCrossingRate(const float* buffer, int numSamples); // Sign changes per sample, no allocation
     static float calculateSpectralCentroid(const std::vector<float>& magnitude, float sampleRate);
     static std::vector<int> findSpectralPeaks(const std::vector<float>& magnitude, float threshold = 0.1f);
     
@@ -0,0 +1,198 @@
+#include "JuceHeader.h"
+#include "AIModelLoader.h"
+#include "ModelRegistry.h"
+#include "TestSignals.h"
+#include <cmath>
+#include <cstring>
+
+// Runs AIModelLoader's CREPE session on the CREPE-shaped model written by
+// Models/make_crepe_test_model.py and checks every prediction against the one ONNX
+// Runtime's Python API gave for the same frames. Built only with ONNXRUNTIME_ROOT.
+class AIModelLoaderTests : public UnitTest
+{
+public:
+    AIModelLoaderTests() : UnitTest("AIModelLoader", "AutoTune") {}
+
+    void runTest() override
+    {
+        const File models(CREPE_TEST_MODEL_DIR);
+        const File batchedModel = models.getChildFile("crepe_test.onnx");
+        const File fixedModel = models.getChildFile("crepe_test_fixed.onnx");
+        const File ortModel = models.getChildFile("crepe_test.ort");
+
+        beginTest("Reference frames and predictions load");
+        Reference reference;
+        expect(reference.load(models.getChildFile("crepe_test_reference.bin")), "no reference in " + models.getFullPathName());
+
+        if (reference.numFrames == 0)
+            return;
+
+        beginTest("A CREPE-shaped model loads");
+        AIModelLoader loader;
+        expectLoads(loader, batchedModel);
+        expect(loader.isCrepeModelLoaded());
+        expectEquals(loader.getCrepeModelInfo().variant, String("crepe_test"));
+        expect(loader.getCrepeModelInfo().inferenceMilliseconds > 0.0);
+
+        beginTest("Batches of every size match ONNX Runtime's reference");
+        {
+            // 70 frames run as 64 + 6; the others as one batch each
+            for (int batchSize : { 1, 2, 7, 63, 64, reference.numFrames })
+            {
+                for (int first = 0; first + batchSize <= reference.numFrames; first += jmax(batchSize, 17))
+                    expectMatches(loader, reference, first, batchSize);
+            }
+        }
+
+        beginTest("A graph with a fixed batch of one runs frame by frame");
+        {
+            AIModelLoader fixed;
+            expectLoads(fixed, fixedModel);
+            expectMatches(fixed, reference, 0, reference.numFrames);
+        }
+
+        beginTest("Instances on the same model share its session");
+        {
+            AIModelLoader other;
+            expectLoads(other, batchedModel);
+            expect(other.getCrepeModelIdentity() != nullptr
+                   && other.getCrepeModelIdentity() == loader.getCrepeModelIdentity());
+        }
+
+        beginTest("A batch grouped for another model is refused");
+        {
+            AIModelLoader::PitchPrediction result;
+            const AIModelLoader::PitchFrame frame { reference.frame(0), frameSize, modelSampleRate };
+
+            expect(loader.predictPitchBatch(&frame, 1, &result, loader.getCrepeModelIdentity()));
+
+            // The fixed-batch model stands in for one swapped in since the frames were grouped
+            AIModelLoader fixed;
+            expectLoads(fixed, fixedModel);
+            result.frequency = -1.0f;
+            expect(!loader.predictPitchBatch(&frame, 1, &result, fixed.getCrepeModelIdentity()));
+            expectEquals(result.frequency, -1.0f);
+        }
+
+        beginTest("An ORT-format model runs from its mapped file until its last user lets go");
+        {
+            SharedResourcePointer<ModelRegistry> registry;
+            const int numOpen = registry->getNumOpenModels();
+
+            {
+                AIModelLoader mapped;
+                expectLoads(mapped, ortModel);
+                expectEquals(registry->getNumOpenModels(), numOpen + 1);
+                expectMatches(mapped, reference, 0, reference.numFrames);
+            }
+
+            expectEquals(registry->getNumOpenModels(), numOpen);
+        }
+
+        beginTest("Audio at the host rate is resampled to the model's");
+        {
+            auto voice = TestSignals::makeVoice(220.0f, 44100.0, 4096);
+            const auto prediction = loader.predictPitch(voice.data(), static_cast<int>(voice.size()), 44100.0f);
+            expect(std::isfinite(prediction.frequency) && prediction.frequency > 0.0f);
+            expect(prediction.confidence > 0.0f && prediction.confidence <= 1.0f);
+        }
+
+        beginTest("A model that fails to load leaves the current one running");
+        {
+            TemporaryFile directory;
+            expect(directory.getFile().createDirectory().wasOk());
+            const File broken = directory.getFile().getChildFile("crepe_tiny_int8.onnx");
+            expect(broken.replaceWithText("not a model"));
+
+            const auto* identity = loader.getCrepeModelIdentity();
+            expect(!loader.loadCrepeModel(broken));
+            expect(loader.isCrepeModelLoaded() && loader.getCrepeModelIdentity() == identity);
+
+            // Draft's variant is the broken file
+            loader.setModelDirectory(directory.getFile());
+            loader.setProcessingQuality(AIModelLoader::ProcessingQuality::Draft);
+            expectEquals(loader.getCrepeModelInfo().variant, String("crepe_test"));
+            expect(loader.getCrepeModelIdentity() == identity);
+            expectMatches(loader, reference, 0, 8);
+
+            directory.getFile().deleteRecursively();
+        }
+
+        beginTest("Nothing is predicted once the model is unloaded");
+        {
+            loader.unloadModels();
+            expect(!loader.isCrepeModelLoaded());
+            expect(loader.getCrepeModelIdentity() == nullptr);
+
+            AIModelLoader::PitchPrediction result;
+            const AIModelLoader::PitchFrame frame { reference.frame(0), frameSize, modelSampleRate };
+            expect(!loader.predictPitchBatch(&frame, 1, &result));
+        }
+    }
+
+private:
+    static constexpr int frameSize = 1024;
+    static constexpr float modelSampleRate = 16000.0f;
+
+    // Written by make_crepe_test_model.py: int32 count, float32 frames [count, 1024], then
+    // float32 (frequency, confidence) per frame
+    struct Reference
+    {
+        int numFrames = 0;
+        std::vector<float> frames;
+        std::vector<float> predictions;
+
+        bool load(const File& file)
+        {
+            MemoryBlock data;
+            if (!file.loadFileAsData(data) || data.getSize() < sizeof(int32))
+                return false;
+
+            const int count = static_cast<int>(ByteOrder::littleEndianInt(data.getData()));
+            if (count <= 0 || data.getSize() != sizeof(int32) + static_cast<size_t>(count) * (frameSize + 2) * sizeof(float))
+                return false;
+
+            frames.resize(static_cast<size_t>(count * frameSize));
+            predictions.resize(static_cast<size_t>(count * 2));
+            const char* values = static_cast<const char*>(data.getData()) + sizeof(int32);
+            std::memcpy(frames.data(), values, frames.size() * sizeof(float));
+            std::memcpy(predictions.data(), values + frames.size() * sizeof(float), predictions.size() * sizeof(float));
+            numFrames = count;
+            return true;
+        }
+
+        const float* frame(int index) const { return frames.data() + index * frameSize; }
+        float frequency(int index) const { return predictions[static_cast<size_t>(index * 2)]; }
+        float confidence(int index) const { return predictions[static_cast<size_t>(index * 2 + 1)]; }
+    };
+
+    void expectLoads(AIModelLoader& loader, const File& model)
+    {
+        const bool loaded = loader.loadCrepeModel(model);
+        expect(loaded, model.getFileName() + ": " + loader.getLastError().message);
+    }
+
+    void expectMatches(AIModelLoader& loader, const Reference& reference, int first, int numFrames)
+    {
+        std::vector<AIModelLoader::PitchFrame> frames;
+        std::vector<AIModelLoader::PitchPrediction> results(static_cast<size_t>(numFrames));
+
+        for (int i = first; i < first + numFrames; ++i)
+            frames.push_back({ reference.frame(i), frameSize, modelSampleRate });
+
+        const bool predicted = loader.predictPitchBatch(frames.data(), numFrames, results.data());
+        expect(predicted, "batch of " + String(numFrames) + " failed: " + loader.getLastError().message);
+
+        for (int i = 0; i < numFrames; ++i)
+        {
+            const auto& result = results[static_cast<size_t>(i)];
+            const String where = "frame " + String(first + i) + " in a batch of " + String(numFrames);
+
+            expectWithinAbsoluteError(TestSignals::centsBetween(result.frequency, reference.frequency(first + i)),
+                                      0.0f, 0.1f, where);
+            expectWithinAbsoluteError(result.confidence, reference.confidence(first + i), 1.0e-4f, where);
+        }
+    }
+};
+
+static AIModelLoaderTests aiModelLoaderTests;
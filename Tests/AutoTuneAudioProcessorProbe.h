@@ -0,0 +1,34 @@
+#pragma once
+
+#include "PluginProcessor.h"
+
+// Reaches the processor's stereo link and per-channel state so tests can check which
+// engine analysed what. The processor must have been prepared.
+struct AutoTuneAudioProcessorProbe
+{
+    static PitchCorrectionEngine& getEngine(AutoTuneAudioProcessor& processor, int channel)
+    {
+        return processor.pitchEngines[static_cast<size_t>(channel)];
+    }
+
+    static bool updateStereoLink(AutoTuneAudioProcessor& processor, int numChannels)
+    {
+        return processor.updateStereoLink(numChannels);
+    }
+
+    static const float* getLinkedAnalysisInput(AutoTuneAudioProcessor& processor, const AudioBuffer<float>& buffer)
+    {
+        return processor.getLinkedAnalysisInput(buffer);
+    }
+
+    // AI mode's ratio curve for the channel's last block
+    static const float* getRatioCurve(const AutoTuneAudioProcessor& processor, int channel)
+    {
+        return processor.channelRatioCurves.getReadPointer(channel);
+    }
+
+    static float getCorrectionRatio(const AutoTuneAudioProcessor& processor, int channel)
+    {
+        return processor.correctionRatios[static_cast<size_t>(channel)];
+    }
+};
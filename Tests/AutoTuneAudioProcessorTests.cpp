@@ -0,0 +1,183 @@
+#include "JuceHeader.h"
+#include "PluginProcessor.h"
+#include "AutoTuneAudioProcessorProbe.h"
+#include "TestSignals.h"
+#include <cmath>
+
+// The stereo link: one analysis of the mid signal (or the louder side, when the channels
+// cancel) corrects both channels, and switching it restarts both engines from scratch
+class AutoTuneAudioProcessorTests : public UnitTest
+{
+public:
+    AutoTuneAudioProcessorTests() : UnitTest("AutoTuneAudioProcessor", "AutoTune") {}
+
+    void runTest() override
+    {
+        // The parameter tree's timer and the processor's AsyncUpdater want a message manager
+        const ScopedJuceInitialiser_GUI juceInitialiser;
+
+        beginTest("A linked pair is analysed once and both channels get its ratio curve");
+        {
+            AutoTuneAudioProcessor linked;
+            prepare(linked, Parameters::Mode::AI, true);
+
+            // Same note, different takes and levels: the mid sum carries the pitch
+            const auto left = TestSignals::makeVoice(200.0f, sampleRate, numSamples, 1);
+            auto right = TestSignals::makeVoice(200.0f, sampleRate, numSamples, 2);
+            FloatVectorOperations::multiply(right.data(), 0.7f, numSamples);
+
+            bool curvesMatch = true, corrected = false;
+
+            process(linked, left, right, [&]
+            {
+                const float* leftRatio = AutoTuneAudioProcessorProbe::getRatioCurve(linked, 0);
+                const float* rightRatio = AutoTuneAudioProcessorProbe::getRatioCurve(linked, 1);
+
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    curvesMatch = curvesMatch && leftRatio[i] == rightRatio[i];
+                    corrected = corrected || leftRatio[i] != 1.0f;
+                }
+            });
+
+            expect(curvesMatch, "the channels' ratio curves differ");
+            expect(corrected, "200 Hz was never corrected");
+            expect(AutoTuneAudioProcessorProbe::getEngine(linked, 0).getVoicingStats().evaluatedHops > 0);
+            expectEquals(AutoTuneAudioProcessorProbe::getEngine(linked, 1).getVoicingStats().evaluatedHops,
+                         static_cast<int64>(0));
+
+            // Unlinked, each channel is analysed and corrected on its own
+            AutoTuneAudioProcessor unlinked;
+            prepare(unlinked, Parameters::Mode::AI, false);
+            const auto higher = TestSignals::makeVoice(290.0f, sampleRate, numSamples, 2);
+            bool curvesDiffer = false;
+
+            process(unlinked, left, higher, [&]
+            {
+                const float* leftRatio = AutoTuneAudioProcessorProbe::getRatioCurve(unlinked, 0);
+                const float* rightRatio = AutoTuneAudioProcessorProbe::getRatioCurve(unlinked, 1);
+
+                for (int i = 0; i < blockSize; ++i)
+                    curvesDiffer = curvesDiffer || leftRatio[i] != rightRatio[i];
+            });
+
+            expect(curvesDiffer, "unlinked channels share a ratio curve");
+            expect(AutoTuneAudioProcessorProbe::getEngine(unlinked, 1).getVoicingStats().evaluatedHops > 0);
+        }
+
+        beginTest("Material that cancels in the mid sum is analysed on the louder channel");
+        {
+            AutoTuneAudioProcessor processor;
+            prepare(processor, Parameters::Mode::Classic, true);
+
+            const auto voice = TestSignals::makeVoice(200.0f, sampleRate, blockSize);
+            AudioBuffer<float> buffer(2, blockSize);
+
+            const auto linkedInput = [&](float leftGain, float rightGain)
+            {
+                buffer.copyFrom(0, 0, voice.data(), blockSize, leftGain);
+                buffer.copyFrom(1, 0, voice.data(), blockSize, rightGain);
+                return AutoTuneAudioProcessorProbe::getLinkedAnalysisInput(processor, buffer);
+            };
+
+            const float* inPhase = linkedInput(1.0f, 0.6f);
+            expect(inPhase != buffer.getReadPointer(0) && inPhase != buffer.getReadPointer(1), "in phase: not the mid sum");
+            expect(linkedInput(1.0f, -0.6f) == buffer.getReadPointer(0), "left louder");
+            expect(linkedInput(-0.6f, 1.0f) == buffer.getReadPointer(1), "right louder");
+
+            // Exactly opposite channels sum to silence, yet the note is still tracked
+            const auto left = TestSignals::makeVoice(200.0f, sampleRate, numSamples);
+            auto right = left;
+            FloatVectorOperations::negate(right.data(), right.data(), numSamples);
+            process(processor, left, right, [] {});
+
+            const float pitch = AutoTuneAudioProcessorProbe::getEngine(processor, 0).getCurrentPitch();
+            expect(pitch > 0.0f, "no pitch for opposite channels");
+            expectWithinAbsoluteError(TestSignals::centsBetween(pitch, 200.0f), 0.0f, 20.0f);
+        }
+
+        beginTest("Turning the link on or off resets both engines");
+        {
+            AutoTuneAudioProcessor processor;
+            prepare(processor, Parameters::Mode::Classic, false);
+
+            const auto left = TestSignals::makeVoice(200.0f, sampleRate, numSamples, 1);
+            const auto right = TestSignals::makeVoice(290.0f, sampleRate, numSamples, 2);
+
+            for (bool link : { true, false })
+            {
+                const String where = link ? "linking" : "unlinking";
+                process(processor, left, right, [] {});
+
+                const int numTracking = link ? 2 : 1;
+                for (int channel = 0; channel < numTracking; ++channel)
+                {
+                    expect(AutoTuneAudioProcessorProbe::getEngine(processor, channel).getCurrentPitch() > 0.0f,
+                           "channel " + String(channel) + " not tracking before " + where);
+                    expect(AutoTuneAudioProcessorProbe::getCorrectionRatio(processor, channel) != 1.0f,
+                           "channel " + String(channel) + " not correcting before " + where);
+                }
+
+                setParameter(processor, Parameters::STEREO_LINK_ID, link ? 1.0f : 0.0f);
+                expect(AutoTuneAudioProcessorProbe::updateStereoLink(processor, 2) == link);
+
+                for (int channel = 0; channel < 2; ++channel)
+                {
+                    auto& engine = AutoTuneAudioProcessorProbe::getEngine(processor, channel);
+                    const String which = where + ", channel " + String(channel);
+
+                    expectEquals(engine.getCurrentPitch(), 0.0f, which);
+                    expectEquals(AutoTuneAudioProcessorProbe::getCorrectionRatio(processor, channel), 1.0f, which);
+
+                    // Nothing of the earlier input is left: the engine tracks like a new one
+                    PitchCorrectionEngine fresh;
+                    fresh.setAnalysisHopSize(engine.getAnalysisHopSize());
+                    fresh.prepare(sampleRate, blockSize);
+
+                    std::vector<float> pitch(static_cast<size_t>(numSamples)), freshPitch(pitch.size());
+                    engine.detectPitch(right.data(), numSamples, pitch.data());
+                    fresh.detectPitch(right.data(), numSamples, freshPitch.data());
+                    expect(pitch == freshPitch, which + ": the pitch curve differs from a new engine's");
+                    engine.reset();
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr double sampleRate = 44100.0;
+    static constexpr int blockSize = 512;
+    static constexpr int numSamples = 22016;  // 43 blocks
+
+    static void setParameter(AutoTuneAudioProcessor& processor, const String& parameterID, float value)
+    {
+        auto* parameter = processor.getValueTreeState().getParameter(parameterID);
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    static void prepare(AutoTuneAudioProcessor& processor, Parameters::Mode mode, bool stereoLink)
+    {
+        setParameter(processor, Parameters::MODE_ID, static_cast<float>(mode));
+        setParameter(processor, Parameters::STEREO_LINK_ID, stereoLink ? 1.0f : 0.0f);
+        processor.prepareToPlay(sampleRate, blockSize);
+    }
+
+    // Runs the pair through processBlock, calling afterBlock after each block
+    template <typename Callback>
+    static void process(AutoTuneAudioProcessor& processor, const std::vector<float>& left,
+                        const std::vector<float>& right, Callback&& afterBlock)
+    {
+        AudioBuffer<float> buffer(2, blockSize);
+        MidiBuffer midi;
+
+        for (int start = 0; start + blockSize <= numSamples; start += blockSize)
+        {
+            buffer.copyFrom(0, 0, left.data() + start, blockSize);
+            buffer.copyFrom(1, 0, right.data() + start, blockSize);
+            processor.processBlock(buffer, midi);
+            afterBlock();
+        }
+    }
+};
+
+static AutoTuneAudioProcessorTests autoTuneAudioProcessorTests;
@@ -0,0 +1,35 @@
+#include "Benchmark.h"
+#include "PitchCorrectionEngine.h"
+#include "../PitchCorrectionEngineProbe.h"
+#include "../TestSignals.h"
+#include <cstdio>
+
+// detectPitchAutocorrelation on one 2048-sample window: the FFT (Wiener-Khinchin) path
+// against the direct O(N^2) lag sweep it replaced
+static Benchmark::Registration autocorrelationBenchmark("autocorrelation", []
+{
+    constexpr int windowSize = 2048;
+
+    for (double sampleRate : { 44100.0, 48000.0 })
+    {
+        PitchCorrectionEngine engine;
+        engine.prepare(sampleRate, 512);
+        auto voice = TestSignals::makeVoice(196.0f, sampleRate, windowSize);
+        std::vector<float> windowed, correlation;
+        int lag = 0;
+
+        const double direct = Benchmark::measureNanoseconds([&]
+        {
+            Benchmark::consume(TestSignals::directAutocorrelationPitch(voice.data(), windowSize, sampleRate,
+                                                                       windowed, correlation, lag));
+        }, 20);
+
+        const double fast = Benchmark::measureNanoseconds([&]
+        {
+            Benchmark::consume(PitchCorrectionEngineProbe::detectPitchAutocorrelation(engine, voice.data(), windowSize));
+        }, 200);
+
+        std::printf("%.1f kHz, %d-sample window: direct %.1f us, FFT %.1f us, %.1fx faster\n",
+                    sampleRate / 1000.0, windowSize, direct / 1000.0, fast / 1000.0, direct / fast);
+    }
+});
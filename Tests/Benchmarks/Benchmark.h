@@ -0,0 +1,52 @@
+#pragma once
+
+#include "JuceHeader.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+// Minimal timing helpers for the benchmark executable. Each benchmark registers
+// itself with a name and prints one line per measurement.
+namespace Benchmark
+{
+    // Median wall time of one call to body, in nanoseconds, over numRuns runs of
+    // callsPerRun calls each (after one untimed warm-up run)
+    inline double measureNanoseconds(const std::function<void()>& body, int callsPerRun, int numRuns = 7)
+    {
+        using Clock = std::chrono::steady_clock;
+        std::vector<double> perCall;
+
+        for (int run = 0; run <= numRuns; ++run)
+        {
+            const auto start = Clock::now();
+
+            for (int i = 0; i < callsPerRun; ++i)
+                body();
+
+            const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+            if (run > 0)
+                perCall.push_back(elapsed / callsPerRun);
+        }
+
+        std::nth_element(perCall.begin(), perCall.begin() + numRuns / 2, perCall.end());
+        return perCall[static_cast<size_t>(numRuns / 2)];
+    }
+
+    // Keeps a result alive so the optimiser cannot drop the work that produced it
+    inline void consume(float value)
+    {
+        static volatile float sink = 0.0f;
+        sink = sink + value;
+    }
+
+    struct Registration
+    {
+        using Function = std::function<void()>;
+
+        Registration(const char* name, Function function);
+
+        static std::vector<std::pair<String, Function>>& getAll();
+    };
+}
@@ -0,0 +1,47 @@
+#include "Benchmark.h"
+#include <cstdio>
+
+Benchmark::Registration::Registration(const char* name, Function function)
+{
+    getAll().emplace_back(name, std::move(function));
+}
+
+std::vector<std::pair<String, Benchmark::Registration::Function>>& Benchmark::Registration::getAll()
+{
+    static std::vector<std::pair<String, Function>> benchmarks;
+    return benchmarks;
+}
+
+// Usage: AutoTuneBenchmarks [name...]
+// Runs every registered benchmark, or only the named ones. Build in Release.
+int main(int argc, char* argv[])
+{
+    int numRun = 0;
+
+    for (auto& [name, function] : Benchmark::Registration::getAll())
+    {
+        bool selected = argc < 2;
+
+        for (int i = 1; i < argc; ++i)
+            selected = selected || name == String(argv[i]);
+
+        if (!selected)
+            continue;
+
+        std::printf("== %s\n", name.toRawUTF8());
+        function();
+        ++numRun;
+    }
+
+    if (numRun == 0)
+    {
+        std::printf("No benchmark matched. Available:\n");
+
+        for (auto& entry : Benchmark::Registration::getAll())
+            std::printf("  %s\n", entry.first.toRawUTF8());
+
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include "Benchmark.h"
+#include "AIModelLoader.h"
+#include "../TestSignals.h"
+#include <cstdio>
+
+// CREPE throughput per batch size, the figure InferenceScheduler's batching rests on. Runs
+// the model in AUTOTUNE_CREPE_MODEL (e.g. a real crepe_small_int8.onnx) or else the
+// generated test model, on noise frames already at the model's 16kHz. Built only with
+// ONNXRUNTIME_ROOT.
+static Benchmark::Registration crepeBatchBenchmark("crepe-batch", []
+{
+    const String modelPath = SystemStats::getEnvironmentVariable("AUTOTUNE_CREPE_MODEL",
+                                                                 String(CREPE_TEST_MODEL_DIR) + "/crepe_test.onnx");
+    AIModelLoader loader;
+
+    if (!loader.loadCrepeModel(File(modelPath)))
+    {
+        std::printf("%s: %s\n", modelPath.toRawUTF8(), loader.getLastError().message.toRawUTF8());
+        return;
+    }
+
+    const auto info = loader.getCrepeModelInfo();
+    std::printf("%s (%s)\n", modelPath.toRawUTF8(), info.version.toRawUTF8());
+
+    constexpr int maxBatchSize = 64;
+    std::vector<std::vector<float>> audio;
+    std::vector<AIModelLoader::PitchFrame> frames;
+    std::vector<AIModelLoader::PitchPrediction> results(maxBatchSize);
+
+    for (int i = 0; i < maxBatchSize; ++i)
+    {
+        audio.push_back(TestSignals::makeNoise(info.inputSize, i + 1));
+        frames.push_back({ audio.back().data(), info.inputSize, info.sampleRate });
+    }
+
+    std::printf("%6s %12s %12s %10s\n", "batch", "ms/batch", "frames/s", "speedup");
+    double singleFrameMilliseconds = 0.0;
+
+    for (int batchSize : { 1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64 })
+    {
+        bool succeeded = true;
+        const double milliseconds = 1.0e-6 * Benchmark::measureNanoseconds([&]
+        {
+            succeeded = loader.predictPitchBatch(frames.data(), batchSize, results.data()) && succeeded;
+        }, jmax(1, 16 / batchSize));
+
+        if (!succeeded)
+        {
+            std::printf("%6d failed: %s\n", batchSize, loader.getLastError().message.toRawUTF8());
+            return;
+        }
+
+        if (batchSize == 1)
+            singleFrameMilliseconds = milliseconds;
+
+        std::printf("%6d %12.3f %12.0f %9.2fx\n", batchSize, milliseconds, 1000.0 * batchSize / milliseconds,
+                    singleFrameMilliseconds * batchSize / milliseconds);
+    }
+
+    std::printf("(speedup: per-frame time at batch 1 over per-frame time at this batch)\n");
+});
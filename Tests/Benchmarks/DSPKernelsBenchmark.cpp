@@ -0,0 +1,52 @@
+#include "Benchmark.h"
+#include "DSPKernels.h"
+#include "../TestSignals.h"
+#include <cstdio>
+
+// Every kernel in every implementation this CPU can run, in ns per sample, at the
+// detector window (2048) and a short YIN-sized run (256)
+static Benchmark::Registration dspKernelsBenchmark("kernels", []
+{
+    auto a = TestSignals::makeNoise(2048, 1);
+    auto b = TestSignals::makeNoise(2048, 2);
+    auto product = a;
+    const std::vector<float> unity(2048, 1.0f); // Repeated multiplies must not decay into denormals
+
+    std::printf("%-8s %6s %12s %12s %12s %12s %12s\n", "impl", "n", "dotProduct", "sumOfSquares",
+                "sumSqDiff", "sum", "multiply");
+
+    for (int numSamples : { 256, 2048 })
+    {
+        const int calls = 2000000 / numSamples;
+        double scalarNanoseconds[5] = {};
+
+        for (const auto& kernels : DSPKernels::getAvailableKernels())
+        {
+            const double nanoseconds[5] = {
+                Benchmark::measureNanoseconds([&] { Benchmark::consume(kernels.dotProduct(a.data(), b.data(), numSamples)); }, calls),
+                Benchmark::measureNanoseconds([&] { Benchmark::consume(kernels.sumOfSquares(a.data(), numSamples)); }, calls),
+                Benchmark::measureNanoseconds([&] { Benchmark::consume(kernels.sumOfSquaredDifferences(a.data(), b.data(), numSamples)); }, calls),
+                Benchmark::measureNanoseconds([&] { Benchmark::consume(kernels.sum(a.data(), numSamples)); }, calls),
+                Benchmark::measureNanoseconds([&]
+                {
+                    kernels.multiply(product.data(), unity.data(), numSamples);
+                    Benchmark::consume(product[0]);
+                }, calls)
+            };
+
+            std::printf("%-8s %6d", kernels.name, numSamples);
+
+            for (int k = 0; k < 5; ++k)
+            {
+                if (scalarNanoseconds[k] == 0.0)
+                    scalarNanoseconds[k] = nanoseconds[k];
+
+                std::printf("  %5.3f %4.1fx", nanoseconds[k] / numSamples, scalarNanoseconds[k] / nanoseconds[k]);
+            }
+
+            std::printf("\n");
+        }
+    }
+
+    std::printf("(ns/sample and speedup over Scalar)\n");
+});
@@ -0,0 +1,39 @@
+#include "Benchmark.h"
+#include "PitchCorrectionEngine.h"
+#include "../TestSignals.h"
+#include <cstdio>
+#include <memory>
+
+// detectPitch over 1.5s of a three-harmonic tone at 96 and 192kHz, in 512-sample blocks:
+// the lag search on the ~12kHz decimated copy against the same search at the full rate
+static Benchmark::Registration multiRateBenchmark("multi-rate", []
+{
+    constexpr int blockSize = 512;
+
+    for (double sampleRate : { 96000.0, 192000.0 })
+    {
+        const int numSamples = static_cast<int>(1.5 * sampleRate);
+        const auto tone = TestSignals::makeTone(196.0f, sampleRate, numSamples);
+        std::vector<float> pitch(static_cast<size_t>(blockSize));
+        double nanoseconds[2] = {};
+
+        for (bool multiRate : { false, true })
+        {
+            auto engine = std::make_unique<PitchCorrectionEngine>();
+            engine->setMultiRateAnalysisEnabled(multiRate);
+            engine->prepare(sampleRate, blockSize);
+
+            nanoseconds[multiRate ? 1 : 0] = Benchmark::measureNanoseconds([&]
+            {
+                for (int start = 0; start + blockSize <= numSamples; start += blockSize)
+                    engine->detectPitch(tone.data() + start, blockSize, pitch.data());
+
+                Benchmark::consume(pitch[0]);
+            }, 1, 5);
+        }
+
+        std::printf("%.0f kHz, %.1f s: full rate %.1f ms, decimated %.1f ms, %.1fx faster\n",
+                    sampleRate / 1000.0, numSamples / sampleRate, nanoseconds[0] * 1.0e-6, nanoseconds[1] * 1.0e-6,
+                    nanoseconds[0] / nanoseconds[1]);
+    }
+});
@@ -0,0 +1,70 @@
+#include "Benchmark.h"
+#include "PitchCorrectionEngine.h"
+#include "../TestSignals.h"
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+// Every AI-mode shifter through processShifterEngine, one channel at 44.1kHz in 512-sample
+// blocks: a sawtooth voice held on each note for 300ms, retuned over 50ms to the next of a
+// few ratios between 0.84 and 1.19. The figures quoted in ModeSelector.h come from here.
+static Benchmark::Registration shifterBenchmark("shifters", []
+{
+    constexpr double sampleRate = 44100.0;
+    constexpr int blockSize = 512;
+    constexpr int numSamples = 4 * 44100;
+    constexpr int noteSamples = static_cast<int>(0.3 * sampleRate);
+    constexpr int retuneSamples = static_cast<int>(0.05 * sampleRate);
+    constexpr float inputPitch = 220.0f;
+    const float semitones[] = { 0.0f, 2.0f, -3.0f, 3.0f, -1.0f };
+
+    const auto voice = TestSignals::makeVoice(inputPitch, sampleRate, numSamples);
+    const std::vector<float> pitchCurve(static_cast<size_t>(numSamples), inputPitch);
+    std::vector<float> ratioCurve(static_cast<size_t>(numSamples));
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const int note = i / (noteSamples + retuneSamples);
+        const int into = i % (noteSamples + retuneSamples);
+        const float from = semitones[note % 5];
+        const float to = semitones[(note + 1) % 5];
+        const float glide = into < noteSamples ? 0.0f : static_cast<float>(into - noteSamples) / retuneSamples;
+        ratioCurve[static_cast<size_t>(i)] = std::pow(2.0f, (from + glide * (to - from)) / 12.0f);
+    }
+
+    const struct { ModeSelector::ShifterEngine engine; const char* name; } shifters[] = {
+        { ModeSelector::ShifterEngine::PSOLA, "PSOLA" },
+        { ModeSelector::ShifterEngine::RubberBandR2, "Rubber Band R2" },
+        { ModeSelector::ShifterEngine::RubberBandR3Short, "Rubber Band R3 short" },
+        { ModeSelector::ShifterEngine::RubberBandR3, "Rubber Band R3" },
+        { ModeSelector::ShifterEngine::PhaseVocoder, "Phase vocoder" }
+    };
+
+    for (const auto& shifter : shifters)
+    {
+        auto engine = std::make_unique<PitchCorrectionEngine>();
+        engine->prepare(sampleRate, blockSize);
+        engine->setShifterEngine(shifter.engine);
+
+        std::vector<float> output(static_cast<size_t>(blockSize));
+        int position = 0;
+
+        const auto processBlock = [&]
+        {
+            engine->processShifterEngine(voice.data() + position, output.data(), blockSize,
+                                         ratioCurve.data() + position, pitchCurve.data() + position);
+            Benchmark::consume(output[0]);
+            position = (position + blockSize) % (numSamples - numSamples % blockSize);
+        };
+
+        // Past the switch from the default engine, so only the one being timed runs
+        for (int i = 0; i < numSamples / blockSize; ++i)
+            processBlock();
+
+        const double nanoseconds = Benchmark::measureNanoseconds(processBlock, numSamples / blockSize);
+
+        std::printf("%-22s %6.3f us/sample  %5.1f%% of one core%s\n", shifter.name,
+                    nanoseconds / blockSize / 1000.0, 100.0 * nanoseconds * sampleRate / blockSize * 1.0e-9,
+                    engine->getShifterEngine() == shifter.engine ? "" : "  (fell back: no Rubber Band)");
+    }
+});
@@ -0,0 +1,80 @@
+#include "JuceHeader.h"
+#include "DSPKernels.h"
+#include "TestSignals.h"
+#include <cmath>
+
+class DSPKernelsTests : public UnitTest
+{
+public:
+    DSPKernelsTests() : UnitTest("DSPKernels", "AutoTune") {}
+
+    void runTest() override
+    {
+        const auto& kernels = DSPKernels::getAvailableKernels();
+        const auto& scalar = kernels.front();
+
+        beginTest("The selected implementation is the last available one");
+        {
+            expectEquals(String(scalar.name), String("Scalar"));
+            expectEquals(String(DSPKernels::getInstructionSetName()), String(kernels.back().name));
+            logMessage("Available: " + String(static_cast<int>(kernels.size())) + ", selected "
+                       + DSPKernels::getInstructionSetName());
+        }
+
+        // Lengths around every vector width and unroll, at unaligned offsets
+        auto a = TestSignals::makeNoise(4096 + 16, 1);
+        auto b = TestSignals::makeNoise(4096 + 16, 2);
+
+        for (const auto& simd : kernels)
+        {
+            beginTest(String(simd.name) + " matches the scalar kernels");
+
+            for (int offset : { 0, 1, 3 })
+            {
+                for (int numSamples : { 1, 3, 4, 7, 8, 15, 16, 17, 31, 33, 64, 127, 1000, 2048, 4096 })
+                {
+                    const float* x = a.data() + offset;
+                    const float* y = b.data() + offset;
+                    const String where = " (offset " + String(offset) + ", " + String(numSamples) + " samples)";
+
+                    // Summation order differs, so allow a few ulps of the absolute-value sum
+                    float magnitude = 0.0f;
+
+                    for (int i = 0; i < numSamples; ++i)
+                        magnitude += std::abs(x[i]) * (1.0f + std::abs(y[i])) + x[i] * x[i] + (x[i] - y[i]) * (x[i] - y[i]);
+
+                    const float tolerance = 1.0e-6f * magnitude + 1.0e-7f;
+
+                    expectWithinAbsoluteError(simd.dotProduct(x, y, numSamples), scalar.dotProduct(x, y, numSamples),
+                                              tolerance, "dotProduct" + where);
+                    expectWithinAbsoluteError(simd.sumOfSquares(x, numSamples), scalar.sumOfSquares(x, numSamples),
+                                              tolerance, "sumOfSquares" + where);
+                    expectWithinAbsoluteError(simd.sumOfSquaredDifferences(x, y, numSamples),
+                                              scalar.sumOfSquaredDifferences(x, y, numSamples),
+                                              tolerance, "sumOfSquaredDifferences" + where);
+                    expectWithinAbsoluteError(simd.sum(x, numSamples), scalar.sum(x, numSamples),
+                                              tolerance, "sum" + where);
+
+                    // Element-wise, so every lane must match exactly
+                    std::vector<float> simdProduct(a.begin() + offset, a.begin() + offset + numSamples);
+                    std::vector<float> scalarProduct(simdProduct);
+                    simd.multiply(simdProduct.data(), y, numSamples);
+                    scalar.multiply(scalarProduct.data(), y, numSamples);
+                    expect(simdProduct == scalarProduct, "multiply" + where);
+                }
+            }
+        }
+
+        beginTest("Empty input");
+        {
+            float value = 1.0f;
+            expectEquals(DSPKernels::dotProduct(&value, &value, 0), 0.0f);
+            expectEquals(DSPKernels::sumOfSquares(&value, 0), 0.0f);
+            expectEquals(DSPKernels::sum(&value, 0), 0.0f);
+            DSPKernels::multiply(&value, &value, 0);
+            expectEquals(value, 1.0f);
+        }
+    }
+};
+
+static DSPKernelsTests dspKernelsTests;
@@ -0,0 +1,74 @@
+#include "JuceHeader.h"
+#include "FractionalDelayInterpolator.h"
+#include <cmath>
+
+// The engine's interpolator (16 taps, 512 phases): whole-sample reads are the samples
+// themselves, and fractional reads of a sine stay within the error its table was built for
+class FractionalDelayInterpolatorTests : public UnitTest
+{
+public:
+    FractionalDelayInterpolatorTests() : UnitTest("FractionalDelayInterpolator", "AutoTune") {}
+
+    void runTest() override
+    {
+        FractionalDelayInterpolator interpolator;
+        interpolator.prepare(16, 512);
+        const int firstTapOffset = interpolator.getFirstTapOffset();
+
+        beginTest("Whole-sample reads are bit-exact");
+        {
+            Random random(1);
+            std::vector<float> signal(256);
+
+            for (auto& sample : signal)
+                sample = random.nextFloat() * 2.0f - 1.0f;
+
+            bool exact = true;
+
+            for (int i = firstTapOffset; i + interpolator.getSamplesAhead() + 1 < static_cast<int>(signal.size()); ++i)
+            {
+                const float* firstTap = signal.data() + i - firstTapOffset;
+
+                // Fraction 0 reads row 0; fractions that round up to a whole sample read the last row
+                exact = exact && interpolator.interpolate(firstTap, 0.0f) == signal[static_cast<size_t>(i)];
+                exact = exact && interpolator.interpolate(firstTap, 0.9999f) == signal[static_cast<size_t>(i + 1)];
+            }
+
+            expect(exact);
+        }
+
+        // Worst error over every fraction, relative to the sine's amplitude
+        const struct { float frequency; float maxErrorDb; } bounds[] = {
+            { 1000.0f, -70.0f },
+            { 10000.0f, -54.0f },
+            { 16000.0f, -40.0f }
+        };
+
+        for (const auto& bound : bounds)
+        {
+            beginTest("Fractional delays of a " + String(bound.frequency / 1000.0f) + " kHz sine stay under "
+                      + String(bound.maxErrorDb) + " dB");
+
+            constexpr double sampleRate = 44100.0;
+            const double omega = MathConstants<double>::twoPi * bound.frequency / sampleRate;
+            std::vector<float> sine(4096);
+
+            for (size_t i = 0; i < sine.size(); ++i)
+                sine[i] = static_cast<float>(std::sin(omega * static_cast<double>(i)));
+
+            double worstError = 0.0;
+
+            for (int i = 64; i < 2048 + 64; ++i)
+            {
+                const float fraction = static_cast<float>((i * 0.618034) - std::floor(i * 0.618034));
+                const float read = interpolator.interpolate(sine.data() + i - firstTapOffset, fraction);
+                worstError = jmax(worstError, std::abs(read - std::sin(omega * (i + static_cast<double>(fraction)))));
+            }
+
+            const double worstErrorDb = 20.0 * std::log10(worstError);
+            expect(worstErrorDb < bound.maxErrorDb, String(worstErrorDb, 1) + " dB");
+        }
+    }
+};
+
+static FractionalDelayInterpolatorTests fractionalDelayInterpolatorTests;
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Writes a small CREPE-shaped ONNX model and the predictions it must give.
+
+The graph is sigmoid(frames @ W + b) with fixed random weights: CREPE's interface
+([N, 1024] samples at 16 kHz in, [N, 360] pitch-bin salience out) without its size,
+so AIModelLoader's session, batching and decoding can be checked against ONNX Runtime's
+Python API. Needs numpy, onnx and onnxruntime.
+
+    make_crepe_test_model.py <output directory>
+
+writes crepe_test.onnx (free batch dimension), crepe_test_fixed.onnx (batch of one),
+crepe_test.ort (the batched graph in ORT format) and crepe_test_reference.bin: int32
+frame count, the frames as float32 [count, 1024], then float32 (frequency, confidence)
+per frame as AIModelLoader decodes them.
+"""
+
+import os
+import sys
+
+import numpy as np
+import onnx
+import onnxruntime
+from onnx import TensorProto, helper, numpy_helper
+
+FRAME_SIZE = 1024
+NUM_BINS = 360
+MODEL_SAMPLE_RATE = 16000.0
+FIRST_BIN_CENTS = 1997.3794     # Must match AIModelLoader's CrepeModel
+CENTS_PER_BIN = 20.0
+DECODE_RADIUS = 4
+NUM_FRAMES = 70                 # More than one 64-frame batch
+
+
+def make_model(weights, bias, batch):
+    frames = helper.make_tensor_value_info("frames", TensorProto.FLOAT, [batch, FRAME_SIZE])
+    salience = helper.make_tensor_value_info("salience", TensorProto.FLOAT, [batch, NUM_BINS])
+    graph = helper.make_graph(
+        [
+            helper.make_node("MatMul", ["frames", "weights"], ["logits"]),
+            helper.make_node("Add", ["logits", "bias"], ["biased"]),
+            helper.make_node("Sigmoid", ["biased"], ["salience"]),
+        ],
+        "crepe_test",
+        [frames],
+        [salience],
+        [numpy_helper.from_array(weights, "weights"), numpy_helper.from_array(bias, "bias")],
+    )
+    model = helper.make_model(graph, opset_imports=[helper.make_opsetid("", 13)])
+    model.ir_version = 8            # Readable by ONNX Runtime 1.16 and later
+    onnx.checker.check_model(model)
+    return model
+
+
+def make_frames(random):
+    # Sines from 50 Hz to 1 kHz with a little noise, normalised the way AIModelLoader
+    # prepares a frame (zero mean, unit variance), so its preparation leaves them unchanged
+    t = np.arange(FRAME_SIZE) / MODEL_SAMPLE_RATE
+    frames = []
+
+    for frequency in np.geomspace(50.0, 1000.0, NUM_FRAMES):
+        frame = np.sin(2.0 * np.pi * frequency * t) + 0.05 * random.standard_normal(FRAME_SIZE)
+        frame = (frame - frame.mean()) / max(1.0e-8, frame.std())
+        frames.append(frame.astype(np.float32))
+
+    return np.stack(frames)
+
+
+def decode(bins):
+    peak = int(np.argmax(bins))
+    first = max(0, peak - DECODE_RADIUS)
+    last = min(NUM_BINS - 1, peak + DECODE_RADIUS)
+    weights = bins[first:last + 1].astype(np.float64)
+    cents = FIRST_BIN_CENTS + CENTS_PER_BIN * np.arange(first, last + 1)
+    frequency = 10.0 * 2.0 ** (np.dot(weights, cents) / weights.sum() / 1200.0)
+    return frequency, min(1.0, max(0.0, float(bins[peak])))
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+
+    directory = sys.argv[1]
+    os.makedirs(directory, exist_ok=True)
+
+    random = np.random.default_rng(1)
+    weights = (random.standard_normal((FRAME_SIZE, NUM_BINS)) * 0.03).astype(np.float32)
+    bias = (random.standard_normal(NUM_BINS) * 0.5).astype(np.float32)
+
+    batched = os.path.join(directory, "crepe_test.onnx")
+    onnx.save(make_model(weights, bias, "batch"), batched)
+    onnx.save(make_model(weights, bias, 1), os.path.join(directory, "crepe_test_fixed.onnx"))
+
+    # ORT format, as ONNX Runtime saves it: ModelRegistry runs these from the mapped file
+    options = onnxruntime.SessionOptions()
+    options.graph_optimization_level = onnxruntime.GraphOptimizationLevel.ORT_ENABLE_BASIC
+    options.optimized_model_filepath = os.path.join(directory, "crepe_test.ort")
+    options.add_session_config_entry("session.save_model_format", "ORT")
+    onnxruntime.InferenceSession(batched, options, providers=["CPUExecutionProvider"])
+
+    frames = make_frames(random)
+    session = onnxruntime.InferenceSession(batched, providers=["CPUExecutionProvider"])
+    salience = session.run(None, {"frames": frames})[0]
+    predictions = np.array([decode(row) for row in salience], dtype=np.float32)
+
+    with open(os.path.join(directory, "crepe_test_reference.bin"), "wb") as reference:
+        reference.write(np.array([NUM_FRAMES], dtype="<i4").tobytes())
+        reference.write(frames.astype("<f4").tobytes())
+        reference.write(predictions.astype("<f4").tobytes())
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,171 @@
+#include "JuceHeader.h"
+#include "PitchCorrectionEngine.h"
+#include "TestSignals.h"
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+// Many engines (one per plugin channel) processing at once on their own threads must
+// produce exactly what each produces alone: any state shared between instances shows
+// up as a difference in the output.
+class PitchCorrectionEngineConcurrencyTests : public UnitTest
+{
+public:
+    PitchCorrectionEngineConcurrencyTests() : UnitTest("PitchCorrectionEngineConcurrency", "AutoTune") {}
+
+    void runTest() override
+    {
+        constexpr int numEngines = 64;
+        constexpr double sampleRate = 44100.0;
+        constexpr int numSamples = 22050;
+        constexpr int maxBlockSize = 512;
+
+        std::vector<Job> jobs;
+
+        for (int i = 0; i < numEngines; ++i)
+        {
+            Job job;
+            job.path = static_cast<Path>(i % 3);
+            job.shifter = static_cast<ModeSelector::ShifterEngine>((i / 3) % 5);
+            job.algorithm = static_cast<ModeSelector::PitchAlgorithm>(i % 7);
+            job.blockSize = 64 << (i % 4);
+            job.input = TestSignals::makeVoice(110.0f + 7.3f * i, sampleRate, numSamples, i + 1);
+            jobs.push_back(std::move(job));
+        }
+
+        beginTest("Engines run one after another");
+        std::vector<std::vector<float>> serialOutputs;
+
+        for (auto& job : jobs)
+        {
+            auto engine = std::make_unique<PitchCorrectionEngine>();
+            engine->prepare(sampleRate, maxBlockSize);
+            serialOutputs.push_back(run(*engine, job));
+        }
+
+        beginTest(String(numEngines) + " engines on " + String(numEngines) + " threads match the serial run bit for bit");
+        {
+            // Prepared together on this thread, the way a host's message thread does it, so
+            // their buffers sit side by side on the heap
+            std::vector<std::unique_ptr<PitchCorrectionEngine>> engines;
+
+            for (int i = 0; i < numEngines; ++i)
+            {
+                engines.push_back(std::make_unique<PitchCorrectionEngine>());
+                engines.back()->prepare(sampleRate, maxBlockSize);
+            }
+
+            std::vector<std::vector<float>> parallelOutputs(numEngines);
+            std::vector<std::thread> threads;
+            std::atomic<int> ready { 0 };
+
+            for (int i = 0; i < numEngines; ++i)
+            {
+                threads.emplace_back([&, i]
+                {
+                    // Start together so every engine is mid-stream while the others run
+                    ++ready;
+                    while (ready.load() < numEngines)
+                        std::this_thread::yield();
+
+                    parallelOutputs[static_cast<size_t>(i)] = run(*engines[static_cast<size_t>(i)],
+                                                                  jobs[static_cast<size_t>(i)], true);
+                });
+            }
+
+            for (auto& thread : threads)
+                thread.join();
+
+            for (int i = 0; i < numEngines; ++i)
+            {
+                const auto& serial = serialOutputs[static_cast<size_t>(i)];
+                const auto& parallel = parallelOutputs[static_cast<size_t>(i)];
+
+                expect(serial.size() == parallel.size()
+                           && std::memcmp(serial.data(), parallel.data(), serial.size() * sizeof(float)) == 0,
+                       "engine " + String(i) + " differs from its serial run");
+            }
+        }
+
+        beginTest("Every engine produced audio");
+        {
+            for (int i = 0; i < numEngines; ++i)
+            {
+                float energy = 0.0f;
+
+                for (float sample : serialOutputs[static_cast<size_t>(i)])
+                    energy += sample * sample;
+
+                expect(std::isfinite(energy) && energy > 1.0f, "engine " + String(i) + " is silent or not finite");
+            }
+        }
+    }
+
+private:
+    enum class Path
+    {
+        ShifterEngine,   // detectPitch + processShifterEngine (PSOLA, R2, R3 short, R3, vocoder)
+        DelayLine,       // detectPitch + process(ratioCurve)
+        PSOLA            // detectPitch + process(ratioCurve, pitchCurve)
+    };
+
+    struct Job
+    {
+        Path path = Path::ShifterEngine;
+        ModeSelector::ShifterEngine shifter = ModeSelector::ShifterEngine::PSOLA;
+        ModeSelector::PitchAlgorithm algorithm = ModeSelector::PitchAlgorithm::YIN;
+        int blockSize = 512;
+        std::vector<float> input;
+    };
+
+    // Detects each block and retunes it to the nearest semitone, as the plugin's Classic
+    // and AI modes do. yieldBetweenBlocks interleaves the threads on a machine with few cores.
+    static std::vector<float> run(PitchCorrectionEngine& engine, const Job& job, bool yieldBetweenBlocks = false)
+    {
+        const int numSamples = static_cast<int>(job.input.size());
+        std::vector<float> output(job.input.size());
+        std::vector<float> pitchCurve(static_cast<size_t>(job.blockSize));
+        std::vector<float> ratioCurve(static_cast<size_t>(job.blockSize));
+
+        engine.setShifterEngine(job.shifter);
+
+        for (int start = 0; start < numSamples; start += job.blockSize)
+        {
+            const int blockSize = jmin(job.blockSize, numSamples - start);
+            float* block = output.data() + start;
+            std::copy(job.input.data() + start, job.input.data() + start + blockSize, block);
+
+            engine.detectPitch(block, blockSize, pitchCurve.data(), job.algorithm);
+
+            for (int i = 0; i < blockSize; ++i)
+            {
+                const float pitch = pitchCurve[static_cast<size_t>(i)];
+                const float semitones = pitch > 0.0f ? 12.0f * std::log2(pitch / 440.0f) : 0.0f;
+                ratioCurve[static_cast<size_t>(i)] = pitch > 0.0f
+                    ? std::pow(2.0f, (std::round(semitones) - semitones) / 12.0f) : 1.0f;
+            }
+
+            switch (job.path)
+            {
+                case Path::ShifterEngine:
+                    engine.processShifterEngine(block, block, blockSize, ratioCurve.data(), pitchCurve.data());
+                    break;
+                case Path::DelayLine:
+                    engine.process(block, block, blockSize, ratioCurve.data());
+                    break;
+                case Path::PSOLA:
+                    engine.process(block, block, blockSize, ratioCurve.data(), pitchCurve.data());
+                    break;
+            }
+
+            if (yieldBetweenBlocks)
+                std::this_thread::yield();
+        }
+
+        return output;
+    }
+};
+
+static PitchCorrectionEngineConcurrencyTests pitchCorrectionEngineConcurrencyTests;
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "PitchCorrectionEngine.h"
+
+// Reaches the engine's private detectors so tests and benchmarks can drive one
+// stage at a time. The engine must have been prepared.
+struct PitchCorrectionEngineProbe
+{
+    static float detectPitchAutocorrelation(PitchCorrectionEngine& engine, const float* buffer, int numSamples)
+    {
+        return engine.detectPitchAutocorrelation(buffer, numSamples, *engine.fft, engine.sampleRate);
+    }
+
+    // One hop of streaming YIN at the analysis rate, straight into its history
+    static float detectPitchYINStreaming(PitchCorrectionEngine& engine, const float* newSamples, int numNewSamples)
+    {
+        return engine.detectPitchYINStreaming(newSamples, numNewSamples);
+    }
+
+    // The window streaming YIN's d(tau) covers: the newest integration window + max tau samples
+    static const float* getYinWindow(const PitchCorrectionEngine& engine, int& integrationWindow, int& maxTau)
+    {
+        integrationWindow = engine.yinIntegrationWindow;
+        maxTau = engine.yinMaxTau;
+        return &engine.yinHistory[engine.yinHistoryWritePos + engine.yinHistoryCapacity - integrationWindow - maxTau];
+    }
+
+    static const std::vector<double>& getYinDifference(const PitchCorrectionEngine& engine)
+    {
+        return engine.yinDifference;
+    }
+
+    // Whether the detector has handed the phase vocoder any of its frames
+    static bool hasQueuedSpectralFrame(const PitchCorrectionEngine& engine)
+    {
+        for (const auto& frame : engine.spectralFrameQueue)
+        {
+            if (frame.position >= 0)
+                return true;
+        }
+
+        return false;
+    }
+
+    // Energy of the phase vocoder's last inverse FFT inside the analysed frame and in the
+    // zero padding after it
+    static void getSpectralSynthesisEnergy(const PitchCorrectionEngine& engine, double& frame, double& padding)
+    {
+        frame = padding = 0.0;
+
+        for (int i = 0; i < PitchCorrectionEngine::fftSize; ++i)
+        {
+            const double value = engine.frequencyData[i].real();
+            (i < PitchCorrectionEngine::analysisWindowSize ? frame : padding) += value * value;
+        }
+    }
+};
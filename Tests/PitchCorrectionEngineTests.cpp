@@ -0,0 +1,697 @@
+#include "JuceHeader.h"
+#include "PitchCorrectionEngine.h"
+#include "PitchCorrectionEngineProbe.h"
+#include "TestSignals.h"
+#include <algorithm>
+#include <complex>
+
+class PitchCorrectionEngineTests : public UnitTest
+{
+public:
+    PitchCorrectionEngineTests() : UnitTest("PitchCorrectionEngine", "AutoTune") {}
+
+    void runTest() override
+    {
+        beginTest("FFT autocorrelation finds the same peak as the direct lag sweep");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr int windowSize = 2048;
+            PitchCorrectionEngine engine;
+            engine.prepare(sampleRate, 512);
+            std::vector<float> windowed, correlation;
+
+            for (float frequency : { 82.4f, 110.0f, 196.0f, 261.6f, 440.0f, 659.3f })
+            {
+                auto voice = TestSignals::makeVoice(frequency, sampleRate, windowSize);
+                int directLag = 0;
+                const float direct = TestSignals::directAutocorrelationPitch(voice.data(), windowSize, sampleRate,
+                                                                             windowed, correlation, directLag);
+                const float fast = PitchCorrectionEngineProbe::detectPitchAutocorrelation(engine, voice.data(), windowSize);
+
+                expect(direct > 0.0f && fast > 0.0f, "no pitch at " + String(frequency) + " Hz");
+                expectWithinAbsoluteError(TestSignals::centsBetween(fast, direct), 0.0f, 0.5f,
+                                          "FFT and direct sweep disagree at " + String(frequency) + " Hz");
+            }
+        }
+
+        beginTest("Parabolic refinement puts the pitch within a cent");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr int windowSize = 2048;
+            PitchCorrectionEngine engine;
+            engine.prepare(sampleRate, 512);
+
+            // The old -0.5 * (y3 - y1) / a step moved the peak twice as far as the parabola's
+            // vertex, up to 3.8 cents off over this range
+            for (float frequency : { 98.0f, 146.8f, 196.0f, 261.6f, 349.2f, 440.0f })
+            {
+                auto voice = TestSignals::makeVoice(frequency, sampleRate, windowSize);
+                const float detected = PitchCorrectionEngineProbe::detectPitchAutocorrelation(engine, voice.data(), windowSize);
+
+                expectWithinAbsoluteError(TestSignals::centsBetween(detected, frequency), 0.0f, 1.0f,
+                                          String(frequency) + " Hz");
+            }
+        }
+
+        beginTest("Autocorrelation rejects noise");
+        {
+            PitchCorrectionEngine engine;
+            engine.prepare(44100.0, 512);
+            auto noise = TestSignals::makeNoise(2048);
+
+            expectEquals(PitchCorrectionEngineProbe::detectPitchAutocorrelation(engine, noise.data(), 2048), 0.0f);
+        }
+
+        beginTest("Streaming YIN matches a direct sum over the same window");
+        {
+            constexpr double sampleRate = 44100.0;
+            const int half = static_cast<int>(0.75 * sampleRate);
+
+            // A note change midway, so d(tau) swings while it is only being updated
+            auto signal = TestSignals::makeVoice(196.0f, sampleRate, half, 1);
+            const auto second = TestSignals::makeVoice(329.6f, sampleRate, half, 2);
+            signal.insert(signal.end(), second.begin(), second.end());
+            std::vector<double> direct;
+
+            for (int hopSize : { 128, 512 })
+            {
+                PitchCorrectionEngine engine;
+                engine.setAnalysisHopSize(hopSize);
+                engine.prepare(sampleRate, 512);
+                double worstDifference = 0.0;
+                float worstCents = 0.0f;
+                bool sameVoicing = true;
+
+                for (int start = 0; start + hopSize <= static_cast<int>(signal.size()); start += hopSize)
+                {
+                    const float streamed = PitchCorrectionEngineProbe::detectPitchYINStreaming(engine, signal.data() + start, hopSize);
+                    int integrationWindow = 0, maxTau = 0;
+                    const float* window = PitchCorrectionEngineProbe::getYinWindow(engine, integrationWindow, maxTau);
+                    const float reference = TestSignals::directYinPitch(window, integrationWindow, maxTau, sampleRate, direct);
+                    const auto& difference = PitchCorrectionEngineProbe::getYinDifference(engine);
+
+                    // Relative to the window's energy, which bounds every d(tau) from above
+                    double energy = 0.0;
+                    for (int i = 0; i < integrationWindow + maxTau; ++i)
+                        energy += static_cast<double>(window[i]) * window[i];
+
+                    for (int tau = 1; tau <= maxTau && energy > 0.0; ++tau)
+                        worstDifference = jmax(worstDifference, std::abs(difference[static_cast<size_t>(tau)]
+                                                                         - direct[static_cast<size_t>(tau)]) / energy);
+
+                    sameVoicing = sameVoicing && (streamed > 0.0f) == (reference > 0.0f);
+                    if (streamed > 0.0f && reference > 0.0f)
+                        worstCents = jmax(worstCents, std::abs(TestSignals::centsBetween(streamed, reference)));
+                }
+
+                const String where = "hop " + String(hopSize);
+                expect(sameVoicing, where + ": streamed and direct disagree on whether there is a pitch");
+                expectLessThan(worstDifference, 1.0e-5, where + ": d(tau)");
+                expectLessThan(worstCents, 0.002f, where + ": pitch in cents");
+            }
+        }
+
+        beginTest("The pitch curve does not depend on the host block size");
+        {
+            for (double sampleRate : { 44100.0, 96000.0 })
+            {
+                // A note, a rest and a second note, so hops land on the gate opening and closing too
+                const int noteLength = static_cast<int>(0.4 * sampleRate);
+                auto signal = TestSignals::makeVoice(220.0f, sampleRate, noteLength);
+                signal.resize(signal.size() + static_cast<size_t>(noteLength / 4), 0.0f);
+                const auto second = TestSignals::makeVoice(311.1f, sampleRate, noteLength, 2);
+                signal.insert(signal.end(), second.begin(), second.end());
+
+                const auto reference = getPitchCurve(signal, sampleRate, 32);
+                expect(std::count_if(reference.begin(), reference.end(), [](float p) { return p > 0.0f; }) > noteLength,
+                       "too little pitch at " + String(sampleRate) + " Hz");
+
+                for (int blockSize : { 64, 512, 4096 })
+                {
+                    const auto curve = getPitchCurve(signal, sampleRate, blockSize);
+                    const auto mismatch = std::mismatch(curve.begin(), curve.end(), reference.begin());
+
+                    expect(mismatch.first == curve.end(),
+                           String(blockSize) + "-sample blocks at " + String(sampleRate) + " Hz differ from sample "
+                               + String(static_cast<int>(mismatch.first - curve.begin())));
+                }
+            }
+        }
+
+        beginTest("The voicing gate skips silence and noise and leaves the sung pitch alone");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr int partLength = 22050;
+
+            // Silence, white noise, a sung tone, silence
+            std::vector<float> signal(partLength, 0.0f);
+            const auto noise = TestSignals::makeNoise(partLength);
+            const auto voice = TestSignals::makeVoice(196.0f, sampleRate, partLength);
+            signal.insert(signal.end(), noise.begin(), noise.end());
+            signal.insert(signal.end(), voice.begin(), voice.end());
+            signal.resize(signal.size() + partLength, 0.0f);
+
+            PitchCorrectionEngine gated, ungated;
+            ungated.setVoicingGateEnabled(false);
+            const auto gatedPitch = getPitchCurve(gated, signal, sampleRate, 512);
+            const auto ungatedPitch = getPitchCurve(ungated, signal, sampleRate, 512);
+
+            const auto& stats = gated.getVoicingStats();
+            const int64 numHops = static_cast<int64>(signal.size()) / gated.getAnalysisHopSize();
+            expectEquals(stats.evaluatedHops, numHops);
+            expect(stats.skippedHops > numHops / 2, String(stats.skippedHops) + " of " + String(numHops) + " hops skipped");
+            expectEquals(ungated.getVoicingStats().skippedHops, static_cast<int64>(0));
+
+            // The gate's level window and hold time keep it open a little past the tone
+            const int tailSamples = static_cast<int>(0.1 * sampleRate);
+            const auto isZero = [](float p) { return p == 0.0f; };
+            expect(std::all_of(gatedPitch.begin(), gatedPitch.begin() + 2 * partLength, isZero),
+                   "pitch in the silence or noise");
+            expect(std::all_of(gatedPitch.begin() + 3 * partLength + tailSamples, gatedPitch.end(), isZero),
+                   "pitch in the closing silence");
+
+            // Once the tone fills the analysis window both detectors see the same audio
+            for (int i = 2 * partLength + tailSamples; i < 3 * partLength; ++i)
+            {
+                const float pitch = gatedPitch[static_cast<size_t>(i)];
+
+                if (pitch <= 0.0f || std::abs(TestSignals::centsBetween(pitch, ungatedPitch[static_cast<size_t>(i)])) > 1.0f)
+                {
+                    expect(false, "gated " + String(pitch) + " Hz, ungated "
+                                      + String(ungatedPitch[static_cast<size_t>(i)]) + " Hz at sample " + String(i));
+                    break;
+                }
+            }
+        }
+
+        beginTest("The cascade stops at YIN on a sustained vowel and escalates when the octave is in doubt");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr int numSamples = 44544;
+            constexpr int settledSamples = numSamples / 2 - (numSamples / 2) % 512;
+
+            for (float frequency : { 110.0f, 196.0f, 330.0f, 440.0f })
+            {
+                PitchCorrectionEngine engine;
+                const auto stats = getCascadeStatsAfter(engine, TestSignals::makeVoice(frequency, sampleRate, numSamples),
+                                                        sampleRate, settledSamples);
+                const String where = String(frequency) + " Hz";
+
+                expect(stats.evaluatedHops > 100, where);
+                expectEquals(stats.autocorrelationHops, static_cast<int64>(0), where + ": autocorrelation ran");
+                expectEquals(stats.spectralHops, static_cast<int64>(0), where + ": spectral stage ran");
+                expectWithinAbsoluteError(TestSignals::centsBetween(engine.getCurrentPitch(), frequency), 0.0f, 5.0f, where);
+            }
+
+            // A steady 220 Hz tone gains a subharmonic over 10ms, which halves its true pitch:
+            // YIN's dip moves an octave from the track, so autocorrelation runs, and its answer
+            // is an octave out too, so spectral peak + HPS decide. Without the subharmonic
+            // the same tone never leaves YIN.
+            for (float subharmonic : { 0.0f, 0.4f })
+            {
+                std::vector<float> signal(numSamples);
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    const double phase = MathConstants<double>::twoPi * 220.0 * i / sampleRate;
+                    const double level = subharmonic * jlimit(0.0, 1.0, (i - settledSamples) / 441.0);
+                    signal[static_cast<size_t>(i)] = static_cast<float>(0.3 * (std::sin(phase) + 0.5 * std::sin(2.0 * phase)
+                                                                               + level * std::sin(0.5 * phase)));
+                }
+
+                PitchCorrectionEngine engine;
+                const auto stats = getCascadeStatsAfter(engine, signal, sampleRate, settledSamples);
+                const String where = "subharmonic " + String(subharmonic);
+
+                if (subharmonic > 0.0f)
+                {
+                    expect(stats.autocorrelationHops > 0 && stats.spectralHops > 0,
+                           where + ": " + String(stats.autocorrelationHops) + " autocorrelation, "
+                               + String(stats.spectralHops) + " spectral hops");
+                    expectWithinAbsoluteError(TestSignals::centsBetween(engine.getCurrentPitch(), 110.0f), 0.0f, 5.0f, where);
+                }
+                else
+                {
+                    expectEquals(stats.autocorrelationHops + stats.spectralHops, static_cast<int64>(0), where);
+                }
+            }
+        }
+
+        beginTest("MPM and probabilistic YIN hold sung tones to two cents");
+        {
+            for (double sampleRate : { 44100.0, 96000.0 })
+            {
+                for (auto algorithm : { ModeSelector::PitchAlgorithm::MPM, ModeSelector::PitchAlgorithm::ProbabilisticYIN })
+                {
+                    for (float frequency : { 82.4f, 110.0f, 196.0f, 261.6f, 440.0f, 659.3f })
+                    {
+                        const int numSamples = static_cast<int>(0.75 * sampleRate);
+                        const auto pitch = getPitchCurve(TestSignals::makeVoice(frequency, sampleRate, numSamples),
+                                                         sampleRate, 512, algorithm);
+                        const String where = (algorithm == ModeSelector::PitchAlgorithm::MPM ? "MPM, " : "pYIN, ")
+                                           + String(frequency) + " Hz at " + String(sampleRate / 1000.0) + " kHz";
+
+                        // After the first window has filled
+                        float worstCents = 0.0f;
+                        for (size_t i = static_cast<size_t>(sampleRate / 4); i < pitch.size(); ++i)
+                            worstCents = jmax(worstCents, pitch[i] > 0.0f ? std::abs(TestSignals::centsBetween(pitch[i], frequency))
+                                                                          : 1200.0f);
+
+                        expectWithinAbsoluteError(worstCents, 0.0f, 2.0f, where);
+                    }
+                }
+            }
+        }
+
+        beginTest("The pYIN tracker holds its octave when the 2nd harmonic dominates");
+        {
+            // 2nd harmonic 20dB over the fundamental: the CMNDF dip at half the period is
+            // deep enough that hop by hop the candidates an octave up carry real weight
+            for (double sampleRate : { 44100.0, 96000.0 })
+            {
+                for (float frequency : { 110.0f, 220.0f, 330.0f, 523.3f })
+                {
+                    const int numSamples = static_cast<int>(sampleRate);
+                    std::vector<float> signal(static_cast<size_t>(numSamples));
+                    Random random(1);
+
+                    for (int i = 0; i < numSamples; ++i)
+                    {
+                        const double phase = MathConstants<double>::twoPi * frequency * i / sampleRate;
+                        signal[static_cast<size_t>(i)] = static_cast<float>(0.3 * (0.1 * std::sin(phase) + std::sin(2.0 * phase)
+                                                                                   + 0.2 * std::sin(3.0 * phase)))
+                                                       + 0.01f * (random.nextFloat() - 0.5f);
+                    }
+
+                    const auto pitch = getPitchCurve(signal, sampleRate, 512, ModeSelector::PitchAlgorithm::ProbabilisticYIN);
+                    const String where = String(frequency) + " Hz at " + String(sampleRate / 1000.0) + " kHz";
+                    int octaveJumps = 0, offOctave = 0;
+
+                    for (size_t i = static_cast<size_t>(sampleRate / 4); i < pitch.size(); ++i)
+                    {
+                        offOctave += pitch[i] <= 0.0f || std::abs(TestSignals::centsBetween(pitch[i], frequency)) > 600.0f ? 1 : 0;
+                        octaveJumps += pitch[i - 1] > 0.0f && pitch[i] > 0.0f
+                                    && std::abs(TestSignals::centsBetween(pitch[i], pitch[i - 1])) > 600.0f ? 1 : 0;
+                    }
+
+                    expectEquals(octaveJumps, 0, where + ": octave jumps");
+                    expectEquals(offOctave, 0, where + ": samples off the octave");
+                }
+            }
+        }
+
+        beginTest("PSOLA at a ratio of 1 is the input delayed by its latency");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr int numSamples = 22050;
+
+            for (float frequency : { 0.0f, 110.0f, 220.0f, 441.0f })
+            {
+                const auto input = frequency > 0.0f ? TestSignals::makeVoice(frequency, sampleRate, numSamples)
+                                                    : TestSignals::makeNoise(numSamples);
+                const std::vector<float> ratio(static_cast<size_t>(numSamples), 1.0f);
+                const std::vector<float> pitch(static_cast<size_t>(numSamples), frequency);
+                PitchCorrectionEngine engine;
+                const auto output = processPSOLA(engine, input, ratio, pitch, sampleRate);
+                const int latency = engine.getLatencySamples();
+
+                float worstError = 0.0f;
+                for (int i = latency; i < numSamples; ++i)
+                    worstError = jmax(worstError, std::abs(output[static_cast<size_t>(i)] - input[static_cast<size_t>(i - latency)]));
+
+                expectWithinAbsoluteError(worstError, 0.0f, 1.0e-5f,
+                                          frequency > 0.0f ? String(frequency) + " Hz" : String("noise"));
+            }
+        }
+
+        beginTest("PSOLA moves a tone to the ratio's pitch");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr int numSamples = 22050;
+
+            // Up to four semitones either way, the reach of a correction. The output is read
+            // with pYIN: autocorrelation takes clean tones above about 400 Hz an octave low.
+            for (float frequency : { 110.0f, 196.0f, 330.0f })
+            {
+                for (float ratio : { 0.79f, 0.89f, 0.94f, 1.06f, 1.12f, 1.26f })
+                {
+                    const auto input = TestSignals::makeVoice(frequency, sampleRate, numSamples);
+                    PitchCorrectionEngine engine;
+                    const auto output = processPSOLA(engine, input,
+                                                     std::vector<float>(static_cast<size_t>(numSamples), ratio),
+                                                     std::vector<float>(static_cast<size_t>(numSamples), frequency),
+                                                     sampleRate);
+                    const auto pitch = getPitchCurve(output, sampleRate, 512, ModeSelector::PitchAlgorithm::ProbabilisticYIN);
+
+                    float worstCents = 0.0f;
+                    for (size_t i = pitch.size() - static_cast<size_t>(sampleRate / 10); i < pitch.size(); ++i)
+                        worstCents = jmax(worstCents, pitch[i] > 0.0f ? std::abs(TestSignals::centsBetween(pitch[i], frequency * ratio))
+                                                                      : 1200.0f);
+
+                    expectWithinAbsoluteError(worstCents, 0.0f, 5.0f, String(frequency) + " Hz at ratio " + String(ratio));
+                }
+            }
+        }
+
+        beginTest("PSOLA does not click where the pitch curve turns voiced or unvoiced");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr int numSamples = 44100;
+
+            // The voicing changes at these samples; from the last one on the ratio also jumps
+            // from exactly 1, where voiced input takes the unvoiced path
+            const int boundaries[] = { 8820, 17640, 26460, 30870, 35280 };
+
+            for (float frequency : { 110.0f, 220.0f, 441.0f })
+            {
+                for (float ratio : { 0.89f, 1.12f })
+                {
+                    // A few harmonics: smooth enough that any step stands out in the second difference
+                    const auto input = TestSignals::makeTone(frequency, sampleRate, numSamples);
+                    std::vector<float> ratioCurve(static_cast<size_t>(numSamples), ratio);
+                    std::vector<float> pitch(static_cast<size_t>(numSamples), frequency);
+                    std::fill(pitch.begin() + boundaries[0], pitch.begin() + boundaries[1], 0.0f);
+                    std::fill(pitch.begin() + boundaries[2], pitch.begin() + boundaries[3], 0.0f);
+                    std::fill(ratioCurve.begin() + boundaries[3], ratioCurve.begin() + boundaries[4], 1.0f);
+
+                    PitchCorrectionEngine engine, steady;
+                    const auto output = processPSOLA(engine, input, ratioCurve, pitch, sampleRate);
+                    const auto steadyOutput = processPSOLA(steady, input,
+                                                           std::vector<float>(static_cast<size_t>(numSamples), ratio),
+                                                           std::vector<float>(static_cast<size_t>(numSamples), frequency),
+                                                           sampleRate);
+
+                    const int latency = engine.getLatencySamples();
+                    const float limit = 1.5f * getMaxSecondDifference(steadyOutput, 4096, numSamples);
+                    const String where = String(frequency) + " Hz at ratio " + String(ratio);
+
+                    for (int boundary : boundaries)
+                    {
+                        expectLessThan(getMaxSecondDifference(output, boundary + latency - 2000, boundary + latency + 2000), limit,
+                                       where + ", sample " + String(boundary));
+                    }
+                }
+            }
+        }
+
+        beginTest("The phase vocoder only takes frames a spectral detector computed");
+        {
+            for (auto algorithm : { ModeSelector::PitchAlgorithm::YIN, ModeSelector::PitchAlgorithm::ProbabilisticYIN,
+                                    ModeSelector::PitchAlgorithm::Spectral })
+            {
+                PitchCorrectionEngine engine;
+                engine.prepare(44100.0, 512);
+                auto voice = TestSignals::makeVoice(220.0f, 44100.0, 8192);
+                std::vector<float> pitch(512), ratio(512, 1.0f);
+
+                for (int start = 0; start < 8192; start += 512)
+                {
+                    engine.detectPitch(voice.data() + start, 512, pitch.data(), algorithm);
+                    engine.processSpectral(voice.data() + start, voice.data() + start, 512, ratio.data());
+                }
+
+                expect(PitchCorrectionEngineProbe::hasQueuedSpectralFrame(engine)
+                           == (algorithm == ModeSelector::PitchAlgorithm::Spectral),
+                       "algorithm " + String(static_cast<int>(algorithm)));
+            }
+        }
+
+        beginTest("Shifted frames stay clear of the FFT's zero padding and land on the new pitch");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr int numSamples = 44100;
+
+            for (float ratio : { 0.8f, 1.26f, 1.9f })
+            {
+                PitchCorrectionEngine engine;
+                engine.prepare(sampleRate, 512);
+                auto voice = TestSignals::makeVoice(150.0f, sampleRate, numSamples);
+                std::vector<float> output(voice.size());
+                std::vector<float> ratioCurve(512, ratio);
+                double frameEnergy = 0.0, paddingEnergy = 0.0;
+
+                // Blocks end on the hop grid, so each leaves its last frame in the FFT buffer
+                for (int start = 0; start + 512 <= numSamples; start += 512)
+                {
+                    engine.processSpectral(voice.data() + start, output.data() + start, 512, ratioCurve.data());
+
+                    double frame = 0.0, padding = 0.0;
+                    PitchCorrectionEngineProbe::getSpectralSynthesisEnergy(engine, frame, padding);
+                    frameEnergy += frame;
+                    paddingEnergy += padding;
+                }
+
+                const String where = "ratio " + String(ratio);
+                expect(frameEnergy > 0.0 && paddingEnergy < 1.0e-3 * frameEnergy,
+                       where + ": " + String(10.0 * std::log10(paddingEnergy / frameEnergy), 1) + " dB in the padding");
+
+                const float detected = PitchCorrectionEngineProbe::detectPitchAutocorrelation(
+                    engine, output.data() + numSamples - 4096, 2048);
+                expectWithinAbsoluteError(TestSignals::centsBetween(detected, 150.0f * ratio), 0.0f, 10.0f, where);
+            }
+        }
+
+        beginTest("The phase vocoder keeps the formants in place, or moves them by the formant shift");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr int numSamples = 44100;
+            constexpr float pitch = 120.0f;
+            const auto vowel = makeVowel(pitch, sampleRate, numSamples);
+            const float semitones5 = std::pow(2.0f, 5.0f / 12.0f);
+
+            // YIN leaves the vocoder to its own STFT; Spectral hands it the detector's frames
+            for (auto algorithm : { ModeSelector::PitchAlgorithm::YIN, ModeSelector::PitchAlgorithm::Spectral })
+            {
+                for (float formantShift : { 1.0f, 0.85f, 1.2f })
+                {
+                    for (float ratio : { 1.0f / semitones5, semitones5 })
+                    {
+                        PitchCorrectionEngine engine;
+                        engine.prepare(sampleRate, 512);
+                        engine.setFormantShift(formantShift);
+                        std::vector<float> output(vowel.size()), pitchCurve(512);
+                        const std::vector<float> ratioCurve(512, ratio);
+
+                        for (int start = 0; start + 512 <= numSamples; start += 512)
+                        {
+                            engine.detectPitch(vowel.data() + start, 512, pitchCurve.data(), algorithm);
+                            engine.processSpectral(vowel.data() + start, output.data() + start, 512, ratioCurve.data());
+                        }
+
+                        const String where = "ratio " + String(ratio, 3) + ", formant shift " + String(formantShift)
+                                           + (algorithm == ModeSelector::PitchAlgorithm::YIN ? ", own STFT" : ", detector's frames");
+
+                        // Without the envelope the peaks would move with the pitch, 25% or more
+                        for (float formant : { firstFormant, secondFormant })
+                        {
+                            const float peak = getFormantPeak(output, sampleRate, pitch * ratio, formant * formantShift);
+                            expectWithinAbsoluteError(peak / (formant * formantShift), 1.0f, 0.08f,
+                                                      where + ": " + String(formant) + " Hz formant at " + String(peak, 0) + " Hz");
+                        }
+                    }
+                }
+            }
+        }
+
+        beginTest("Decimated analysis holds pitch to cents at 96 and 192 kHz and agrees with full rate");
+        {
+            for (double sampleRate : { 96000.0, 192000.0 })
+            {
+                for (float frequency : { 82.4f, 110.0f, 146.8f, 196.0f, 261.6f, 329.6f, 440.0f, 587.3f, 698.5f })
+                {
+                    const auto tone = TestSignals::makeTone(frequency, sampleRate, static_cast<int>(1.5 * sampleRate));
+                    const float decimated = getSettledPitch(tone, sampleRate, true);
+                    const String where = String(frequency) + " Hz at " + String(sampleRate / 1000.0) + " kHz";
+
+                    expect(decimated > 0.0f, "no pitch for " + where);
+                    expectWithinAbsoluteError(TestSignals::centsBetween(decimated, frequency), 0.0f, 2.0f, where);
+
+                    // The full-rate window is 2048 samples: below about 330 periods a second
+                    // it holds too few of them for its own estimate to be good to a cent
+                    if (frequency * 330.0 >= sampleRate)
+                    {
+                        const float fullRate = getSettledPitch(tone, sampleRate, false);
+                        expectWithinAbsoluteError(TestSignals::centsBetween(decimated, fullRate), 0.0f, 2.0f,
+                                                  where + " against full rate");
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    // Median of detectPitch over the last half second of signal, with the multi-rate path on
+    // or off
+    float getSettledPitch(const std::vector<float>& signal, double sampleRate, bool multiRate)
+    {
+        PitchCorrectionEngine engine;
+        engine.setMultiRateAnalysisEnabled(multiRate);
+        engine.prepare(sampleRate, 512);
+        expect(engine.isMultiRateAnalysisActive() == multiRate);
+
+        const int numSamples = static_cast<int>(signal.size());
+        std::vector<float> pitch(signal.size());
+
+        for (int start = 0; start < numSamples; start += 512)
+            engine.detectPitch(signal.data() + start, jmin(512, numSamples - start), pitch.data() + start);
+
+        std::vector<float> settled(pitch.end() - static_cast<int>(0.5 * sampleRate), pitch.end());
+        settled.erase(std::remove(settled.begin(), settled.end(), 0.0f), settled.end());
+
+        if (settled.empty())
+            return 0.0f;
+
+        std::nth_element(settled.begin(), settled.begin() + static_cast<long>(settled.size() / 2), settled.end());
+        return settled[settled.size() / 2];
+    }
+
+    // Runs detectPitchAdvanced over the signal in 512-sample blocks and returns the cascade's
+    // stage counts from sample countFrom (a block boundary) on
+    static PitchCorrectionEngine::CascadeStats getCascadeStatsAfter(PitchCorrectionEngine& engine,
+                                                                    const std::vector<float>& signal,
+                                                                    double sampleRate, int countFrom)
+    {
+        engine.prepare(sampleRate, 512);
+        std::vector<float> pitch(512);
+
+        for (int start = 0; start + 512 <= static_cast<int>(signal.size()); start += 512)
+        {
+            if (start == countFrom)
+                engine.resetCascadeStats();
+
+            engine.detectPitchAdvanced(signal.data() + start, 512, pitch.data());
+        }
+
+        return engine.getCascadeStats();
+    }
+
+    // detectPitch over the whole signal, fed in blocks of blockSize (the last one shorter)
+    static std::vector<float> getPitchCurve(const std::vector<float>& signal, double sampleRate, int blockSize,
+                                            ModeSelector::PitchAlgorithm algorithm = ModeSelector::PitchAlgorithm::Autocorrelation)
+    {
+        PitchCorrectionEngine engine;
+        return getPitchCurve(engine, signal, sampleRate, blockSize, algorithm);
+    }
+
+    static std::vector<float> getPitchCurve(PitchCorrectionEngine& engine, const std::vector<float>& signal,
+                                            double sampleRate, int blockSize,
+                                            ModeSelector::PitchAlgorithm algorithm = ModeSelector::PitchAlgorithm::Autocorrelation)
+    {
+        engine.prepare(sampleRate, blockSize);
+
+        const int numSamples = static_cast<int>(signal.size());
+        std::vector<float> pitch(signal.size());
+
+        for (int start = 0; start < numSamples; start += blockSize)
+            engine.detectPitch(signal.data() + start, jmin(blockSize, numSamples - start), pitch.data() + start, algorithm);
+
+        return pitch;
+    }
+    // The TD-PSOLA process() over the whole signal in 512-sample blocks
+    static std::vector<float> processPSOLA(PitchCorrectionEngine& engine, const std::vector<float>& input,
+                                           const std::vector<float>& ratioCurve, const std::vector<float>& pitchCurve,
+                                           double sampleRate)
+    {
+        engine.prepare(sampleRate, 512);
+
+        const int numSamples = static_cast<int>(input.size());
+        std::vector<float> output(input.size());
+
+        for (int start = 0; start < numSamples; start += 512)
+        {
+            engine.process(input.data() + start, output.data() + start, jmin(512, numSamples - start),
+                           ratioCurve.data() + start, pitchCurve.data() + start);
+        }
+
+        return output;
+    }
+
+    // Largest |y[i] - 2y[i-1] + y[i-2]| over [start, end): tiny on a smooth tone, the step
+    // itself at a discontinuity
+    static float getMaxSecondDifference(const std::vector<float>& signal, int start, int end)
+    {
+        float largest = 0.0f;
+
+        for (int i = jmax(2, start); i < end; ++i)
+        {
+            const auto index = static_cast<size_t>(i);
+            largest = jmax(largest, std::abs(signal[index] - 2.0f * signal[index - 1] + signal[index - 2]));
+        }
+
+        return largest;
+    }
+    // A vowel's envelope: formants at 700 and 1800 Hz on a floor 20dB down, so no peak needs
+    // more than the vocoder's +-24dB to move under the ratios tested
+    static constexpr float firstFormant = 700.0f;
+    static constexpr float secondFormant = 1800.0f;
+
+    static double getVowelEnvelope(double frequency)
+    {
+        return 0.1 + std::exp(-0.5 * std::pow((frequency - firstFormant) / 200.0, 2.0))
+                   + 0.6 * std::exp(-0.5 * std::pow((frequency - secondFormant) / 250.0, 2.0));
+    }
+
+    // Every harmonic of the pitch up to 0.45 fs at the envelope's level, so the harmonics
+    // sample the envelope directly
+    static std::vector<float> makeVowel(float pitch, double sampleRate, int numSamples)
+    {
+        std::vector<float> signal(static_cast<size_t>(numSamples));
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            double sample = 0.0;
+
+            for (int h = 1; h * pitch < 0.45 * sampleRate; ++h)
+                sample += getVowelEnvelope(h * pitch) * std::cos(MathConstants<double>::twoPi * h * pitch * i / sampleRate);
+
+            signal[static_cast<size_t>(i)] = static_cast<float>(0.05 * sample);
+        }
+
+        return signal;
+    }
+
+    // The loudest harmonic of pitch within 30% of expected, over the signal's last 16384
+    // samples, refined by a parabola through its neighbours' log levels
+    static float getFormantPeak(const std::vector<float>& signal, double sampleRate, float pitch, float expected)
+    {
+        constexpr int length = 16384;
+        const float* samples = signal.data() + signal.size() - length;
+
+        auto getLogLevel = [&](int harmonic)
+        {
+            std::complex<double> sum;
+            const double step = MathConstants<double>::twoPi * harmonic * pitch / sampleRate;
+
+            for (int i = 0; i < length; ++i)
+            {
+                const double window = 0.5 * (1.0 - std::cos(MathConstants<double>::twoPi * i / (length - 1)));
+                sum += samples[i] * window * std::polar(1.0, -step * i);
+            }
+
+            return std::log(std::abs(sum) + 1.0e-12);
+        };
+
+        const int first = jmax(2, static_cast<int>(std::ceil(0.7f * expected / pitch)));
+        const int last = static_cast<int>(1.3f * expected / pitch);
+        int loudest = first;
+        double loudestLevel = getLogLevel(first);
+
+        for (int harmonic = first + 1; harmonic <= last; ++harmonic)
+        {
+            const double level = getLogLevel(harmonic);
+            if (level > loudestLevel)
+            {
+                loudest = harmonic;
+                loudestLevel = level;
+            }
+        }
+
+        const double left = getLogLevel(loudest - 1), right = getLogLevel(loudest + 1);
+        const double curvature = left - 2.0 * loudestLevel + right;
+        const double offset = curvature < 0.0 ? 0.5 * (left - right) / curvature : 0.0;
+
+        return static_cast<float>((loudest + offset) * pitch);
+    }
+};
+
+static PitchCorrectionEngineTests pitchCorrectionEngineTests;
@@ -0,0 +1,128 @@
+#include "JuceHeader.h"
+#include "RubberBandShifter.h"
+#include "TestSignals.h"
+#include <cmath>
+
+// RubberBandShifter's streaming contract: whole blocks out for whole blocks in, a ratio of 1
+// that is the input delayed by getLatencySamples(), and no underruns when the pitch scale
+// jumps, at any host block size
+class RubberBandShifterTests : public UnitTest
+{
+public:
+    RubberBandShifterTests() : UnitTest("RubberBandShifter", "AutoTune") {}
+
+    void runTest() override
+    {
+        constexpr int maxBlockSize = 1024;
+        const RubberBandShifter::Engine engines[] = { RubberBandShifter::Engine::Faster,
+                                                      RubberBandShifter::Engine::FinerShort,
+                                                      RubberBandShifter::Engine::Finer };
+
+        beginTest("Every call returns exactly numSamples, and a ratio of 1 is the input delayed by the latency");
+        {
+            constexpr double sampleRate = 44100.0;
+            constexpr int numSamples = 3 * 44100;
+            const auto voice = TestSignals::makeVoice(196.0f, sampleRate, numSamples);
+            const std::vector<float> unity(maxBlockSize, 1.0f);
+
+            for (auto engine : engines)
+            {
+                RubberBandShifter shifter;
+                shifter.prepare(sampleRate, maxBlockSize, engine);
+                const int latency = shifter.getLatencySamples();
+                const String name = getName(engine);
+
+                // The tail of each block is a guard the shifter must not write
+                std::vector<float> output(static_cast<size_t>(numSamples), 0.0f);
+                std::vector<float> block(maxBlockSize + 1);
+                Random random(static_cast<int64>(engine) + 1);
+                bool blocksWhole = true;
+
+                for (int start = 0; start < numSamples;)
+                {
+                    const int blockSize = jmin(1 + random.nextInt(maxBlockSize), numSamples - start);
+                    std::copy(voice.data() + start, voice.data() + start + blockSize, block.data());
+                    block[static_cast<size_t>(blockSize)] = guard;
+
+                    shifter.process(block.data(), block.data(), blockSize, unity.data());
+
+                    blocksWhole = blocksWhole && block[static_cast<size_t>(blockSize)] == guard;
+                    std::copy(block.data(), block.data() + blockSize, output.data() + start);
+                    start += blockSize;
+                }
+
+                expect(blocksWhole, name + " wrote past the end of a block");
+                expectEquals(static_cast<int>(shifter.getUnderrunCount()), 0, name);
+
+                bool silentUntilLatency = true;
+
+                for (int i = 0; i < latency; ++i)
+                    silentUntilLatency = silentUntilLatency && output[static_cast<size_t>(i)] == 0.0f;
+
+                expect(silentUntilLatency, name + " played something before its latency");
+
+                // After the first half second, as each engine's analysis settles. Rubber Band
+                // resynthesises even at a ratio of 1, so the match is about -43 dB, not exact;
+                // a latency off by one sample would leave it near -14 dB.
+                double signal = 0.0, error = 0.0;
+
+                for (int i = latency + 22050; i < numSamples; ++i)
+                {
+                    const double expected = voice[static_cast<size_t>(i - latency)];
+                    signal += expected * expected;
+                    error += (output[static_cast<size_t>(i)] - expected) * (output[static_cast<size_t>(i)] - expected);
+                }
+
+                const double errorDb = 10.0 * std::log10(error / signal);
+                expect(errorDb < -40.0, name + ": delayed input differs by " + String(errorDb, 1) + " dB");
+            }
+        }
+
+        for (double sampleRate : { 44100.0, 96000.0 })
+        {
+            beginTest("No underruns under 0.5x/2x jumps at " + String(sampleRate / 1000.0, 1) + " kHz");
+
+            const int numSamples = static_cast<int>(10.0 * sampleRate);
+            const int jumpSamples = static_cast<int>(0.1 * sampleRate);
+            const auto voice = TestSignals::makeVoice(196.0f, sampleRate, numSamples);
+            std::vector<float> ratioCurve(static_cast<size_t>(numSamples));
+
+            for (int i = 0; i < numSamples; ++i)
+                ratioCurve[static_cast<size_t>(i)] = (i / jumpSamples) % 2 == 0 ? 0.5f : 2.0f;
+
+            for (auto engine : engines)
+            {
+                RubberBandShifter shifter;
+                shifter.prepare(sampleRate, maxBlockSize, engine);
+                std::vector<float> block(maxBlockSize);
+                Random random(static_cast<int64>(engine) + 7);
+
+                for (int start = 0; start < numSamples;)
+                {
+                    const int blockSize = jmin(1 + random.nextInt(maxBlockSize), numSamples - start);
+                    shifter.process(voice.data() + start, block.data(), blockSize, ratioCurve.data() + start);
+                    start += blockSize;
+                }
+
+                expectEquals(static_cast<int>(shifter.getUnderrunCount()), 0, getName(engine));
+            }
+        }
+    }
+
+private:
+    static constexpr float guard = 12345.0f;
+
+    static String getName(RubberBandShifter::Engine engine)
+    {
+        switch (engine)
+        {
+            case RubberBandShifter::Engine::Faster:     return "R2";
+            case RubberBandShifter::Engine::FinerShort: return "R3 short";
+            case RubberBandShifter::Engine::Finer:      break;
+        }
+
+        return "R3";
+    }
+};
+
+static RubberBandShifterTests rubberBandShifterTests;
@@ -0,0 +1,30 @@
+#include "JuceHeader.h"
+
+// Runs every UnitTest in the "AutoTune" category, or only those whose names are
+// given on the command line. Exits non-zero when any expectation fails.
+int main(int argc, char* argv[])
+{
+    Array<UnitTest*> tests;
+
+    for (auto* test : UnitTest::getTestsInCategory("AutoTune"))
+    {
+        bool selected = argc < 2;
+
+        for (int i = 1; i < argc; ++i)
+            selected = selected || test->getName() == String(argv[i]);
+
+        if (selected)
+            tests.add(test);
+    }
+
+    UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTests(tests);
+
+    int failures = 0;
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        failures += runner.getResult(i)->failures;
+
+    return failures > 0 ? 1 : 0;
+}
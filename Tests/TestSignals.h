@@ -0,0 +1,178 @@
+#pragma once
+
+#include "JuceHeader.h"
+#include <cmath>
+#include <vector>
+
+// Deterministic input signals and reference implementations shared by the
+// tests and benchmarks
+namespace TestSignals
+{
+    // Band-limited sawtooth with a little noise, close enough to a sung vowel for the detectors
+    inline std::vector<float> makeVoice(float frequency, double sampleRate, int numSamples, int64 seed = 1)
+    {
+        std::vector<float> signal(static_cast<size_t>(numSamples), 0.0f);
+        Random random(seed);
+        const int numHarmonics = jmax(1, static_cast<int>(0.45 * sampleRate / frequency));
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double phase = MathConstants<double>::twoPi * frequency * i / sampleRate;
+            double sample = 0.0;
+
+            for (int h = 1; h <= numHarmonics; ++h)
+                sample += std::sin(phase * h) / h;
+
+            signal[static_cast<size_t>(i)] = static_cast<float>(0.3 * sample) + 0.01f * (random.nextFloat() - 0.5f);
+        }
+
+        return signal;
+    }
+
+    // A few harmonics at falling levels: cheap to generate at 96-192kHz, where makeVoice's
+    // harmonics up to 0.45 fs would number in the hundreds
+    inline std::vector<float> makeTone(float frequency, double sampleRate, int numSamples, int numHarmonics = 3)
+    {
+        std::vector<float> signal(static_cast<size_t>(numSamples), 0.0f);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double phase = MathConstants<double>::twoPi * frequency * i / sampleRate;
+            double sample = 0.0;
+
+            for (int h = 1; h <= numHarmonics; ++h)
+                sample += std::sin(phase * h) / h;
+
+            signal[static_cast<size_t>(i)] = static_cast<float>(0.3 * sample);
+        }
+
+        return signal;
+    }
+
+    inline std::vector<float> makeNoise(int numSamples, int64 seed = 1, float gain = 0.5f)
+    {
+        std::vector<float> signal(static_cast<size_t>(numSamples));
+        Random random(seed);
+
+        for (auto& sample : signal)
+            sample = gain * (2.0f * random.nextFloat() - 1.0f);
+
+        return signal;
+    }
+
+    inline float centsBetween(float frequency, float reference)
+    {
+        return 1200.0f * std::log2(frequency / reference);
+    }
+
+    // detectPitchAutocorrelation as a direct O(N^2) sum per lag, the way it ran before the
+    // FFT path: Hann window, 50-800 Hz peak relative to the zero lag, parabolic refinement.
+    // Returns the pitch, or 0 below the 0.3 peak threshold; integerLag gets the peak lag.
+    inline float directAutocorrelationPitch(const float* buffer, int numSamples, double sampleRate,
+                                            std::vector<float>& windowed, std::vector<float>& correlation,
+                                            int& integerLag)
+    {
+        windowed.assign(buffer, buffer + numSamples);
+        correlation.assign(static_cast<size_t>(numSamples / 2 + 1), 0.0f);
+
+        for (int i = 0; i < numSamples; ++i)
+            windowed[static_cast<size_t>(i)] *= 0.5f * (1.0f - std::cos(MathConstants<float>::twoPi * i / (numSamples - 1)));
+
+        for (int lag = 1; lag < numSamples / 2; ++lag)
+        {
+            float sum = 0.0f;
+
+            for (int i = 0; i < numSamples - lag; ++i)
+                sum += windowed[static_cast<size_t>(i)] * windowed[static_cast<size_t>(i + lag)];
+
+            correlation[static_cast<size_t>(lag)] = sum / (numSamples - lag);
+        }
+
+        float zeroLag = 0.0f;
+
+        for (float sample : windowed)
+            zeroLag += sample * sample;
+
+        zeroLag /= numSamples;
+
+        const int minLag = jmax(1, static_cast<int>(sampleRate / 800.0));
+        const int maxLag = jmin(static_cast<int>(sampleRate / 50.0), numSamples / 2 - 1);
+        integerLag = 0;
+        float peak = 0.0f;
+
+        for (int lag = minLag; lag < maxLag; ++lag)
+        {
+            if (correlation[static_cast<size_t>(lag)] > peak)
+            {
+                peak = correlation[static_cast<size_t>(lag)];
+                integerLag = lag;
+            }
+        }
+
+        if (integerLag == 0 || zeroLag <= 0.0f || peak / zeroLag <= 0.3f)
+            return 0.0f;
+
+        const float y1 = correlation[static_cast<size_t>(integerLag - 1)];
+        const float y2 = correlation[static_cast<size_t>(integerLag)];
+        const float y3 = correlation[static_cast<size_t>(integerLag + 1)];
+        const float curvature = y1 - 2.0f * y2 + y3;
+        const float offset = std::abs(curvature) > 1e-6f ? 0.5f * (y1 - y3) / curvature : 0.0f;
+
+        return static_cast<float>(sampleRate / (integerLag + offset));
+    }
+
+    // Streaming YIN's pitch as a direct sum over one window: d(tau) over integrationWindow
+    // samples for tau up to maxTau, the cumulative mean normalised difference, the first dip
+    // under 0.1 between 50 and 800 Hz, and parabolic refinement. Returns 0 with no dip;
+    // difference gets d(tau).
+    inline float directYinPitch(const float* window, int integrationWindow, int maxTau, double sampleRate,
+                                std::vector<double>& difference)
+    {
+        difference.assign(static_cast<size_t>(maxTau + 1), 0.0);
+
+        for (int tau = 1; tau <= maxTau; ++tau)
+        {
+            double sum = 0.0;
+
+            for (int j = 0; j < integrationWindow; ++j)
+            {
+                const double delta = static_cast<double>(window[j]) - window[j + tau];
+                sum += delta * delta;
+            }
+
+            difference[static_cast<size_t>(tau)] = sum;
+        }
+
+        std::vector<double> normalised(difference.size(), 1.0);
+        double runningSum = 0.0;
+
+        for (int tau = 1; tau <= maxTau; ++tau)
+        {
+            runningSum += difference[static_cast<size_t>(tau)];
+            if (runningSum > 0.0)
+                normalised[static_cast<size_t>(tau)] = difference[static_cast<size_t>(tau)] * tau / runningSum;
+        }
+
+        const int minTau = static_cast<int>(sampleRate / 800.0);
+        const int lastTau = jmin(static_cast<int>(sampleRate / 50.0), maxTau + 1);
+
+        for (int tau = minTau; tau < lastTau; ++tau)
+        {
+            if (normalised[static_cast<size_t>(tau)] >= 0.1)
+                continue;
+
+            while (tau < maxTau && normalised[static_cast<size_t>(tau + 1)] < normalised[static_cast<size_t>(tau)])
+                ++tau;
+
+            if (tau <= 0 || tau >= maxTau)
+                return static_cast<float>(sampleRate / tau);
+
+            const double s0 = normalised[static_cast<size_t>(tau - 1)];
+            const double s1 = normalised[static_cast<size_t>(tau)];
+            const double s2 = normalised[static_cast<size_t>(tau + 1)];
+            return static_cast<float>(sampleRate / (tau + (s2 - s0) / (2.0 * (2.0 * s1 - s2 - s0))));
+        }
+
+        return 0.0f;
+    }
+}